@@ -44,9 +44,54 @@ extern "C"
 #include "deepstream_dsexample.h"
 #include "deepstream_tracker.h"
 #include "deepstream_secondary_gie.h"
+#include "deepstream_app_motor.h"
+#include "deepstream_app_servo.h"
+#include "deepstream_app_actuator.h"
+#include "deepstream_app_detection.h"
+#include "deepstream_app_pantilt.h"
+#include "deepstream_app_target.h"
+#include "deepstream_app_predictor.h"
+#include "deepstream_app_fall.h"
+#include "deepstream_app_zone.h"
+#include "deepstream_app_trajectory.h"
+#include "deepstream_app_recorder.h"
+#include "deepstream_app_metawriter.h"
+#include "deepstream_app_replay.h"
+#include "deepstream_app_bench.h"
+#include "deepstream_app_render.h"
+#include "deepstream_app_labelcache.h"
+#include "deepstream_app_log.h"
+#include "deepstream_app_metrics.h"
+#include "deepstream_app_latency.h"
+#include "deepstream_app_perfreport.h"
+#include "deepstream_app_adaptive.h"
+#include "deepstream_app_governor.h"
+#include "deepstream_app_motion.h"
+#include "deepstream_app_reload.h"
 
 typedef struct _AppCtx AppCtx;
 
+/** Controllers of the primary GIE interval; the largest interval wins. */
+typedef enum
+{
+  /** Adaptive interval controller, else the [primary-gie] interval. */
+  NV_DS_PGIE_INTERVAL_ADAPTIVE,
+  NV_DS_PGIE_INTERVAL_GOVERNOR,
+  NV_DS_PGIE_INTERVAL_MOTION_GATE,
+  NV_DS_PGIE_INTERVAL_NUM
+} NvDsPgieIntervalSource;
+
+/** Parts of a running pipeline a config key can be changed in. */
+typedef enum
+{
+  NV_DS_RELOAD_OSD = 1 << 0,
+  NV_DS_RELOAD_GIE_COLORS = 1 << 1,
+  NV_DS_RELOAD_PGIE_INTERVAL = 1 << 2,
+  NV_DS_RELOAD_MOTION_GATE = 1 << 3,
+  NV_DS_RELOAD_PANTILT = 1 << 4,
+  NV_DS_RELOAD_ADAPTIVE = 1 << 5
+} NvDsReloadFlags;
+
 typedef void (*bbox_generated_callback) (AppCtx *appCtx, GstBuffer *buf,
     NvDsBatchMeta *batch_meta, guint index);
 typedef gboolean (*overlay_graphics_callback) (AppCtx *appCtx, GstBuffer *buf,
@@ -67,6 +112,10 @@ typedef struct
   NvDsTrackerBin tracker_bin;
   NvDsSinkBin sink_bin;
   NvDsDsExampleBin dsexample_bin;
+  /** Event clip recorder fed from tee, NULL unless enabled. */
+  NvDsRecorder *recorder;
+  /** Label text per track, used by the OSD probe of this instance. */
+  NvDsLabelCache *label_cache;
   AppCtx *appCtx;
 } NvDsInstanceBin;
 
@@ -92,8 +141,11 @@ typedef struct
   guint num_secondary_gie_sub_bins;
   guint num_sink_sub_bins;
   guint perf_measurement_interval_sec;
+  gboolean enable_stage_latency;
   gchar *bbox_dir_path;
   gchar *kitti_track_dir_path;
+  gchar *bbox_log_dir_path;
+  gchar *track_log_dir_path;
 
   NvDsSourceConfig multi_source_config[MAX_SOURCE_BINS];
   NvDsStreammuxConfig streammux_config;
@@ -104,6 +156,21 @@ typedef struct
   NvDsSinkSubBinConfig sink_bin_sub_bin_config[MAX_SINK_BINS];
   NvDsTiledDisplayConfig tiled_display_config;
   NvDsDsExampleConfig dsexample_config;
+  NvDsMotorConfig motor_config;
+  NvDsServoConfig servo_config;
+  NvDsPanTiltConfig pantilt_config;
+  NvDsTargetConfig target_config;
+  NvDsPredictorConfig predictor_config;
+  NvDsFallConfig fall_config;
+  NvDsZoneConfig zone_config[NVDS_MAX_ZONES];
+  guint num_zones;
+  NvDsRecorderConfig recorder_config;
+  NvDsMetaWriterConfig meta_writer_config;
+  NvDsMetricsConfig metrics_config;
+  NvDsPerfReportConfig perf_report_config;
+  NvDsAdaptiveConfig adaptive_config;
+  NvDsGovernorConfig governor_config;
+  NvDsMotionGateConfig motion_gate_config;
 } NvDsConfig;
 
 typedef struct
@@ -136,6 +203,34 @@ struct _AppCtx
   NvDsFrameLatencyInfo *latency_info;
   GMutex latency_lock;
   rtcp_sender_report_callback rtcp_sender_report_cb;
+  NvDsMetaWriter *meta_writer;
+  /** bbox colours per GIE and class, built with the pipeline. */
+  NvDsRenderTables *render_tables;
+  /** Frame latency histogram by stream, NULL without [metrics]. */
+  NvDsMetric *latency_metric;
+  /** Stream cell of this instance, -1 to use the source id. */
+  gint metrics_stream;
+  /** Per-stage latency histograms, NULL unless enable-stage-latency. */
+  NvDsStageLatency *stage_latency;
+  /** Histogram by stage, NULL without [metrics]. */
+  NvDsMetric *stage_latency_metric;
+  guint stage_latency_timer;
+  /** Shared by all instances; frames and sink drops are counted into it. */
+  NvDsPerfReport *perf_report;
+  /** Last QoS dropped count per posting element, a guint64 keyed by the
+   * GstObject; only touched from the bus watch. */
+  GHashTable *qos_dropped;
+  /** Set by the governor to stop drawing boxes and labels; atomic. */
+  gint osd_suspended;
+  /** Interval wanted by each controller and the one applied. */
+  GMutex pgie_interval_lock;
+  guint pgie_intervals[NV_DS_PGIE_INTERVAL_NUM];
+  guint pgie_interval;
+  /** Skips the primary GIE on static batches, NULL unless enabled. */
+  NvDsMotionGate *motion_gate;
+  /** Primary detections of the last inferred frame of each source, as
+   * NvDsDetectionLogRecord, put back on the frames the GIE skips. */
+  GArray *motion_gate_objects[MAX_SOURCE_BINS];
 };
 
 /**
@@ -165,9 +260,51 @@ gboolean seek_pipeline (AppCtx * appCtx, glong milliseconds, gboolean seek_is_re
 
 void toggle_show_bbox_text (AppCtx * appCtx);
 
+/**
+ * Set the primary GIE interval wanted by @source and apply the largest
+ * one. Callable from any thread.
+ */
+void set_pgie_interval (AppCtx * appCtx, NvDsPgieIntervalSource source,
+    guint interval);
+
+/**
+ * @return the NvDsReloadFlags of what has to be updated for a change of
+ * @key in @group to take effect, 0 if it needs a restart.
+ */
+guint config_reload_flags (const gchar * group, const gchar * key);
+
+/**
+ * Take the @flags parts of @config, freshly parsed from the edited file,
+ * into the running pipeline and its config. Values taken over are moved
+ * out of @config. Called on the main loop; the controllers of main.c are
+ * updated by the caller.
+ */
+void reload_pipeline_config (AppCtx * appCtx, NvDsConfig * config,
+    guint flags);
+
 void destroy_pipeline (AppCtx * appCtx);
 void restart_pipeline (AppCtx * appCtx);
 
+/**
+ * Feed recorded detections through the metadata callbacks in the order a
+ * live pipeline calls them, without creating one, so no camera or GPU is
+ * needed. Labels of KITTI input are resolved with the primary GIE label
+ * file. Blocks until the recording ends or appCtx->quit is set.
+ */
+gboolean replay_pipeline (AppCtx * appCtx, NvDsReplayConfig * replay_config,
+    bbox_generated_callback bbox_generated_post_analytics_cb,
+    bbox_generated_callback all_bbox_generated_cb);
+
+/**
+ * Time each metadata callback on synthetic batches, without a pipeline,
+ * and write per-callback percentiles as JSON. KITTI and detection log
+ * output configured in [application] is written as in a live run.
+ */
+gboolean bench_pipeline (AppCtx * appCtx, NvDsBenchConfig * bench_config,
+    bbox_generated_callback bbox_generated_post_analytics_cb,
+    bbox_generated_callback all_bbox_generated_cb,
+    overlay_graphics_callback overlay_graphics_cb);
+
 
 /**
  * Function to read properties from configuration file.
@@ -180,6 +317,24 @@ void restart_pipeline (AppCtx * appCtx);
 gboolean
 parse_config_file (NvDsConfig * config, gchar * cfg_file_path);
 
+/**
+ * Parse only the groups a running pipeline can take changes of: [osd],
+ * the GIE groups, [pan-tilt], [adaptive-interval] and [motion-gate].
+ * Release the result with free_reload_config(); nothing is left to free
+ * on failure.
+ */
+gboolean
+parse_reload_config (NvDsConfig * config, gchar * cfg_file_path);
+
+/**
+ * Free the strings and colour tables parse_reload_config() allocated in
+ * @config; those taken over are NULL by then.
+ */
+void free_reload_config (NvDsConfig * config);
+
+/** Free a bbox colour table of a GIE config together with its colours. */
+void free_bbox_color_table (GHashTable * table);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_app_actuator.h"
+
+struct _NvDsActuatorScheduler
+{
+  NvDsMotor *motor;
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gboolean stop;
+  /** A command has been started and its hold time has not run out. */
+  gboolean running;
+  /** Set by a newer intent; the worker abandons the running command. */
+  gboolean preempt;
+
+  NvDsActuatorCommand *queue;
+  guint queue_size;
+  guint head;
+  guint count;
+
+  NvDsActuatorStats stats;
+  NvDsMetric *delay_metric;
+};
+
+static void
+actuator_start (NvDsMotor * motor, const NvDsActuatorCommand * cmd)
+{
+  switch (cmd->type) {
+    case NV_DS_ACTUATOR_CMD_DRIVE:
+      nvds_motor_drive (motor, cmd->left, cmd->right);
+      break;
+    case NV_DS_ACTUATOR_CMD_VERTICAL:
+      nvds_motor_vertical (motor, cmd->left);
+      break;
+    case NV_DS_ACTUATOR_CMD_STOP:
+    default:
+      nvds_motor_stop (motor);
+      break;
+  }
+}
+
+static void
+actuator_halt (NvDsMotor * motor, NvDsActuatorCommandType type)
+{
+  if (type == NV_DS_ACTUATOR_CMD_VERTICAL)
+    nvds_motor_vertical (motor, 0);
+  else
+    nvds_motor_stop (motor);
+}
+
+static gpointer
+actuator_thread (gpointer data)
+{
+  NvDsActuatorScheduler *sched = (NvDsActuatorScheduler *) data;
+  NvDsActuatorCommand cmd;
+  gint64 deadline = 0;
+
+  g_mutex_lock (&sched->lock);
+  while (!sched->stop) {
+    if (!sched->running) {
+      gint64 delay;
+
+      if (sched->count == 0) {
+        g_cond_wait (&sched->cond, &sched->lock);
+        continue;
+      }
+      cmd = sched->queue[sched->head];
+      sched->head = (sched->head + 1) % sched->queue_size;
+      sched->count--;
+      sched->preempt = FALSE;
+
+      delay = g_get_monotonic_time () - cmd.post_time;
+      sched->stats.num_executed++;
+      sched->stats.total_start_delay_us += delay;
+      if ((guint64) delay > sched->stats.max_start_delay_us)
+        sched->stats.max_start_delay_us = delay;
+      nvds_metric_observe (sched->delay_metric, 0, delay / 1000.0);
+
+      /* Motor I/O happens unlocked so posting never waits on the driver. */
+      sched->running = TRUE;
+      g_mutex_unlock (&sched->lock);
+      actuator_start (sched->motor, &cmd);
+      g_mutex_lock (&sched->lock);
+
+      if (cmd.duration_ms == 0 || cmd.type == NV_DS_ACTUATOR_CMD_STOP) {
+        sched->running = FALSE;
+        continue;
+      }
+      deadline = g_get_monotonic_time () +
+          (gint64) cmd.duration_ms * G_TIME_SPAN_MILLISECOND;
+      continue;
+    }
+
+    /* A newer intent cancels the motion early; otherwise hold it until its
+     * duration runs out. */
+    if (!sched->preempt &&
+        g_cond_wait_until (&sched->cond, &sched->lock, deadline))
+      continue;
+
+    /* A following command of the same kind overrides the motors directly,
+     * anything else needs an explicit halt first. */
+    sched->running = FALSE;
+    if (sched->count == 0 || sched->queue[sched->head].type != cmd.type) {
+      g_mutex_unlock (&sched->lock);
+      actuator_halt (sched->motor, cmd.type);
+      g_mutex_lock (&sched->lock);
+    }
+  }
+  g_mutex_unlock (&sched->lock);
+
+  nvds_motor_stop (sched->motor);
+  nvds_motor_vertical (sched->motor, 0);
+  return NULL;
+}
+
+NvDsActuatorScheduler *
+nvds_actuator_scheduler_new (NvDsMotor * motor, guint queue_size)
+{
+  NvDsActuatorScheduler *sched = g_malloc0 (sizeof (NvDsActuatorScheduler));
+
+  sched->motor = motor;
+  sched->queue_size = MAX (queue_size, 1);
+  sched->queue = g_malloc0 (sched->queue_size * sizeof (NvDsActuatorCommand));
+  g_mutex_init (&sched->lock);
+  g_cond_init (&sched->cond);
+  sched->thread = g_thread_new ("nvds-actuator", actuator_thread, sched);
+  return sched;
+}
+
+void
+nvds_actuator_scheduler_free (NvDsActuatorScheduler * sched)
+{
+  if (!sched)
+    return;
+
+  g_mutex_lock (&sched->lock);
+  sched->stop = TRUE;
+  g_cond_signal (&sched->cond);
+  g_mutex_unlock (&sched->lock);
+  g_thread_join (sched->thread);
+
+  g_mutex_clear (&sched->lock);
+  g_cond_clear (&sched->cond);
+  g_free (sched->queue);
+  g_free (sched);
+}
+
+static void
+actuator_push_locked (NvDsActuatorScheduler * sched,
+    const NvDsActuatorCommand * cmd, gint64 now)
+{
+  NvDsActuatorCommand *slot =
+      &sched->queue[(sched->head + sched->count) % sched->queue_size];
+
+  *slot = *cmd;
+  slot->post_time = now;
+  sched->count++;
+  sched->stats.num_queued++;
+}
+
+gboolean
+nvds_actuator_post (NvDsActuatorScheduler * sched,
+    const NvDsActuatorCommand * cmds, guint num_cmds)
+{
+  gint64 now = g_get_monotonic_time ();
+  guint i;
+
+  if (!sched || num_cmds == 0)
+    return FALSE;
+
+  g_mutex_lock (&sched->lock);
+  if (num_cmds > sched->queue_size) {
+    sched->stats.num_dropped += num_cmds;
+    g_mutex_unlock (&sched->lock);
+    return FALSE;
+  }
+
+  /* Latest target wins: everything not yet started is stale. */
+  sched->stats.num_preempted += sched->count;
+  sched->count = 0;
+  if (sched->running) {
+    sched->stats.num_preempted++;
+    sched->preempt = TRUE;
+  }
+
+  for (i = 0; i < num_cmds; i++)
+    actuator_push_locked (sched, &cmds[i], now);
+
+  g_cond_signal (&sched->cond);
+  g_mutex_unlock (&sched->lock);
+  return TRUE;
+}
+
+gboolean
+nvds_actuator_enqueue (NvDsActuatorScheduler * sched,
+    const NvDsActuatorCommand * cmd)
+{
+  gboolean ret = FALSE;
+
+  if (!sched)
+    return FALSE;
+
+  g_mutex_lock (&sched->lock);
+  if (sched->count < sched->queue_size) {
+    actuator_push_locked (sched, cmd, g_get_monotonic_time ());
+    g_cond_signal (&sched->cond);
+    ret = TRUE;
+  } else {
+    sched->stats.num_dropped++;
+  }
+  g_mutex_unlock (&sched->lock);
+  return ret;
+}
+
+void
+nvds_actuator_set_delay_metric (NvDsActuatorScheduler * sched,
+    NvDsMetric * metric)
+{
+  if (!sched)
+    return;
+
+  g_mutex_lock (&sched->lock);
+  sched->delay_metric = metric;
+  g_mutex_unlock (&sched->lock);
+}
+
+gboolean
+nvds_actuator_is_idle (NvDsActuatorScheduler * sched)
+{
+  gboolean idle;
+
+  if (!sched)
+    return TRUE;
+
+  g_mutex_lock (&sched->lock);
+  idle = !sched->running && sched->count == 0;
+  g_mutex_unlock (&sched->lock);
+  return idle;
+}
+
+void
+nvds_actuator_get_stats (NvDsActuatorScheduler * sched,
+    NvDsActuatorStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsActuatorStats));
+  if (!sched)
+    return;
+
+  g_mutex_lock (&sched->lock);
+  *stats = sched->stats;
+  stats->queue_depth = sched->count;
+  g_mutex_unlock (&sched->lock);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_ACTUATOR_H__
+#define __NVGSTDS_APP_ACTUATOR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_motor.h"
+#include "deepstream_app_metrics.h"
+
+typedef enum
+{
+  /** Wheel speeds in left / right. */
+  NV_DS_ACTUATOR_CMD_DRIVE = 0,
+  /** Camera lift speed in left. */
+  NV_DS_ACTUATOR_CMD_VERTICAL,
+  NV_DS_ACTUATOR_CMD_STOP,
+} NvDsActuatorCommandType;
+
+typedef struct
+{
+  NvDsActuatorCommandType type;
+  gdouble left;
+  gdouble right;
+  /** How long to hold the command before stopping; 0 holds it until the
+   * next command. */
+  guint duration_ms;
+  /** Set by the scheduler when the command is accepted. */
+  gint64 post_time;
+} NvDsActuatorCommand;
+
+typedef struct
+{
+  guint64 num_queued;
+  guint64 num_preempted;
+  guint64 num_executed;
+  guint64 num_dropped;
+  /** Post to motor-start delay of executed commands. */
+  guint64 total_start_delay_us;
+  guint64 max_start_delay_us;
+  guint queue_depth;
+} NvDsActuatorStats;
+
+typedef struct _NvDsActuatorScheduler NvDsActuatorScheduler;
+
+/**
+ * Start the scheduler thread. Commands are executed on @motor in order;
+ * at most @queue_size commands may be waiting at any time.
+ */
+NvDsActuatorScheduler *nvds_actuator_scheduler_new (NvDsMotor * motor,
+    guint queue_size);
+
+/**
+ * Stop the thread, halt the motors and free the scheduler.
+ */
+void nvds_actuator_scheduler_free (NvDsActuatorScheduler * sched);
+
+/**
+ * Post a new motion intent made of @num_cmds steps. The newest intent wins:
+ * the motion in progress is cancelled and every step still queued from
+ * earlier intents is discarded. Never blocks on the motor.
+ *
+ * @return FALSE if the intent does not fit in the queue.
+ */
+gboolean nvds_actuator_post (NvDsActuatorScheduler * sched,
+    const NvDsActuatorCommand * cmds, guint num_cmds);
+
+/**
+ * Append one command behind whatever is already queued.
+ *
+ * @return FALSE (and count a drop) if the queue is full.
+ */
+gboolean nvds_actuator_enqueue (NvDsActuatorScheduler * sched,
+    const NvDsActuatorCommand * cmd);
+
+/**
+ * @return TRUE once every posted step has run out its hold time, i.e. the
+ * last intent was carried out and nothing is moving or waiting. A NULL
+ * scheduler is always idle.
+ */
+gboolean nvds_actuator_is_idle (NvDsActuatorScheduler * sched);
+
+void nvds_actuator_get_stats (NvDsActuatorScheduler * sched,
+    NvDsActuatorStats * stats);
+
+/**
+ * Record the post to motor-start delay of every executed command, in ms,
+ * in cell 0 of histogram @metric. The metric must outlive the scheduler.
+ */
+void nvds_actuator_set_delay_metric (NvDsActuatorScheduler * sched,
+    NvDsMetric * metric);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "deepstream_app_adaptive.h"
+#include "deepstream_app_log.h"
+
+struct _NvDsAdaptiveInterval
+{
+  NvDsAdaptiveConfig config;
+  guint base_interval;
+  guint interval;
+  /** The GIE still runs at base_interval until the first update. */
+  gboolean applied;
+  guint prev_objects;
+  /** Last fast or moving object, or appearance. */
+  gint64 last_activity_us;
+  gint64 last_change_us;
+  NvDsAdaptiveStats stats;
+  /** Config handed over by nvds_adaptive_interval_set_config(). */
+  GMutex lock;
+  gint pending;
+  NvDsAdaptiveConfig next;
+};
+
+static void
+adaptive_load_config (NvDsAdaptiveInterval * adaptive,
+    NvDsAdaptiveConfig * config)
+{
+  adaptive->config = *config;
+  adaptive->config.max_interval = MAX (config->max_interval,
+      config->min_interval);
+  adaptive->config.still_speed = MIN (config->still_speed,
+      config->fast_speed);
+}
+
+NvDsAdaptiveInterval *
+nvds_adaptive_interval_new (NvDsAdaptiveConfig * config, guint base_interval)
+{
+  NvDsAdaptiveInterval *adaptive;
+
+  if (!config->enable)
+    return NULL;
+
+  adaptive = g_new0 (NvDsAdaptiveInterval, 1);
+  adaptive_load_config (adaptive, config);
+  g_mutex_init (&adaptive->lock);
+  adaptive->base_interval = base_interval;
+  /* Start attentive; an empty scene backs off after idle_ms. */
+  adaptive->interval = adaptive->config.min_interval;
+  adaptive->stats.interval = adaptive->interval;
+  adaptive->stats.max_interval_seen = adaptive->interval;
+  return adaptive;
+}
+
+void
+nvds_adaptive_interval_free (NvDsAdaptiveInterval * adaptive)
+{
+  if (!adaptive)
+    return;
+
+  g_mutex_clear (&adaptive->lock);
+  g_free (adaptive);
+}
+
+void
+nvds_adaptive_interval_set_config (NvDsAdaptiveInterval * adaptive,
+    NvDsAdaptiveConfig * config)
+{
+  if (!adaptive)
+    return;
+
+  g_mutex_lock (&adaptive->lock);
+  adaptive->next = *config;
+  g_atomic_int_set (&adaptive->pending, TRUE);
+  g_mutex_unlock (&adaptive->lock);
+}
+
+static void
+adaptive_set (NvDsAdaptiveInterval * adaptive, gint64 now_us, guint interval,
+    const gchar * reason)
+{
+  NVDS_LOG_INFO ("adaptive: pgie interval %u -> %u (%s)", adaptive->interval,
+      interval, reason);
+  if (interval > adaptive->interval)
+    adaptive->stats.num_raises++;
+  else
+    adaptive->stats.num_drops++;
+  adaptive->interval = interval;
+  adaptive->last_change_us = now_us;
+  adaptive->stats.interval = interval;
+  adaptive->stats.max_interval_seen =
+      MAX (adaptive->stats.max_interval_seen, interval);
+}
+
+gboolean
+nvds_adaptive_interval_update (NvDsAdaptiveInterval * adaptive,
+    gint64 now_us, gboolean inferred, guint num_objects, gdouble max_speed,
+    guint * interval)
+{
+  NvDsAdaptiveConfig *config;
+  gboolean appeared = FALSE;
+  guint old;
+
+  if (!adaptive)
+    return FALSE;
+
+  config = &adaptive->config;
+  old = adaptive->applied ? adaptive->interval : adaptive->base_interval;
+  adaptive->applied = TRUE;
+  adaptive->stats.num_batches++;
+  if (!adaptive->last_change_us)
+    adaptive->last_activity_us = adaptive->last_change_us = now_us;
+
+  if (g_atomic_int_get (&adaptive->pending)) {
+    g_mutex_lock (&adaptive->lock);
+    adaptive_load_config (adaptive, &adaptive->next);
+    g_atomic_int_set (&adaptive->pending, FALSE);
+    g_mutex_unlock (&adaptive->lock);
+    if (adaptive->interval < config->min_interval ||
+        adaptive->interval > config->max_interval)
+      adaptive_set (adaptive, now_us, CLAMP (adaptive->interval,
+              config->min_interval, config->max_interval), "reconfigured");
+  }
+
+  /* Object counts only mean something on the batches the GIE ran on;
+   * tracked boxes carry the speed in between. */
+  if (inferred) {
+    adaptive->stats.num_inferred++;
+    appeared = num_objects > adaptive->prev_objects;
+    adaptive->prev_objects = num_objects;
+  }
+
+  if (appeared || max_speed >= config->fast_speed) {
+    /* Escalate at once; missing the start of an event costs more than a
+     * few extra inference runs. */
+    adaptive->last_activity_us = now_us;
+    if (adaptive->interval > config->min_interval)
+      adaptive_set (adaptive, now_us, config->min_interval,
+          appeared ? "object appeared" : "fast motion");
+  } else if (max_speed >= config->still_speed) {
+    /* Between the two speeds: hold the current interval. */
+    adaptive->last_activity_us = now_us;
+  } else if (adaptive->interval < config->max_interval &&
+      now_us - adaptive->last_activity_us >= config->idle_ms * 1000LL &&
+      now_us - adaptive->last_change_us >= config->step_ms * 1000LL) {
+    guint next = MAX (adaptive->interval * 2, adaptive->interval + 1);
+    adaptive_set (adaptive, now_us, MIN (next, config->max_interval),
+        adaptive->prev_objects ? "static scene" : "empty scene");
+  }
+
+  *interval = adaptive->interval;
+  return adaptive->interval != old;
+}
+
+void
+nvds_adaptive_interval_get_stats (NvDsAdaptiveInterval * adaptive,
+    NvDsAdaptiveStats * stats)
+{
+  guint64 baseline;
+
+  *stats = adaptive->stats;
+  /* The configured interval runs the GIE on every (interval + 1)th batch. */
+  baseline = (stats->num_batches + adaptive->base_interval) /
+      (adaptive->base_interval + 1);
+  stats->num_saved = baseline > stats->num_inferred ?
+      baseline - stats->num_inferred : 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_ADAPTIVE_H__
+#define __NVGSTDS_APP_ADAPTIVE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+typedef struct
+{
+  gboolean enable;
+  /** Interval while the scene is active. */
+  guint min_interval;
+  /** Interval of an empty or static scene. */
+  guint max_interval;
+  /** Only objects of this class count; -1 counts every class. */
+  gint class_id;
+  /** Objects faster than this, in frame heights per second, drop the
+   * interval to min_interval at once. */
+  gdouble fast_speed;
+  /** Objects slower than this count as static. */
+  gdouble still_speed;
+  /** Quiet time before the interval is raised. */
+  guint idle_ms;
+  /** Time between two raises, and after a drop. */
+  guint step_ms;
+} NvDsAdaptiveConfig;
+
+typedef struct
+{
+  guint64 num_batches;
+  /** Batches the primary GIE ran on. */
+  guint64 num_inferred;
+  /** Inference runs saved against the configured interval. */
+  guint64 num_saved;
+  guint64 num_raises;
+  guint64 num_drops;
+  guint interval;
+  guint max_interval_seen;
+} NvDsAdaptiveStats;
+
+typedef struct _NvDsAdaptiveInterval NvDsAdaptiveInterval;
+
+/**
+ * @base_interval is the interval of the [primary-gie] group; the savings
+ * are counted against it.
+ *
+ * @return NULL if the config is disabled.
+ */
+NvDsAdaptiveInterval *nvds_adaptive_interval_new (NvDsAdaptiveConfig *
+    config, guint base_interval);
+
+void nvds_adaptive_interval_free (NvDsAdaptiveInterval * adaptive);
+
+/**
+ * Feed one batch seen after the analytics: whether the primary GIE ran
+ * on it, the objects it found (only meaningful when @inferred) and the
+ * fastest tracked object, in frame heights per second. Call from the
+ * analytics probe only.
+ *
+ * @return TRUE if the interval changed; the new one is in *@interval.
+ */
+gboolean nvds_adaptive_interval_update (NvDsAdaptiveInterval * adaptive,
+    gint64 now_us, gboolean inferred, guint num_objects, gdouble max_speed,
+    guint * interval);
+
+/**
+ * Take new limits, speeds and timings from @config. Callable from any
+ * thread; the next update applies them and brings the interval inside
+ * the new limits.
+ */
+void nvds_adaptive_interval_set_config (NvDsAdaptiveInterval * adaptive,
+    NvDsAdaptiveConfig * config);
+
+void nvds_adaptive_interval_get_stats (NvDsAdaptiveInterval * adaptive,
+    NvDsAdaptiveStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "deepstream_app_bench.h"
+
+#define BENCH_FRAME_DURATION_NS G_GUINT64_CONSTANT (33333333)
+#define BENCH_NUM_CLASSES 4
+
+static const gchar *bench_labels[] = {
+  "black", "blue", "red", "white", "sedan", "suv", "truck", "van",
+  "adult", "child", "standing", "sitting",
+};
+
+typedef struct
+{
+  const gchar *name;
+  /** guint64 ns, one per measured batch. */
+  GArray *samples;
+} BenchStage;
+
+struct _NvDsBench
+{
+  NvDsBenchConfig config;
+  BenchStage *stages;
+  guint num_stages;
+  guint batch;
+  NvDsReplayFrame *frames;
+  NvDsDetectionLogRecord *objects;
+};
+
+guint64
+nvds_bench_now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (guint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+NvDsBench *
+nvds_bench_new (NvDsBenchConfig * config, const gchar * const *stages,
+    guint num_stages)
+{
+  NvDsBench *bench = g_malloc0 (sizeof (NvDsBench));
+  guint i;
+
+  bench->config = *config;
+  bench->config.num_sources = MAX (config->num_sources, 1);
+  bench->config.frame_width = config->frame_width ? config->frame_width : 1280;
+  bench->config.frame_height =
+      config->frame_height ? config->frame_height : 720;
+
+  bench->num_stages = num_stages;
+  bench->stages = g_new0 (BenchStage, num_stages);
+  for (i = 0; i < num_stages; i++) {
+    bench->stages[i].name = stages[i];
+    bench->stages[i].samples = g_array_sized_new (FALSE, FALSE,
+        sizeof (guint64), config->num_batches);
+  }
+
+  bench->frames = g_new0 (NvDsReplayFrame, bench->config.num_sources);
+  bench->objects = g_new0 (NvDsDetectionLogRecord,
+      bench->config.num_sources * MAX (config->num_objects, 1));
+  return bench;
+}
+
+void
+nvds_bench_free (NvDsBench * bench)
+{
+  guint i;
+
+  if (!bench)
+    return;
+
+  for (i = 0; i < bench->num_stages; i++)
+    g_array_free (bench->stages[i].samples, TRUE);
+  g_free (bench->stages);
+  g_free (bench->frames);
+  g_free (bench->objects);
+  g_free (bench);
+}
+
+guint
+nvds_bench_next_batch (NvDsBench * bench, const NvDsReplayFrame ** frames)
+{
+  NvDsBenchConfig *config = &bench->config;
+  guint s, i;
+
+  if (bench->batch >= config->num_warmup + config->num_batches) {
+    *frames = NULL;
+    return 0;
+  }
+
+  for (s = 0; s < config->num_sources; s++) {
+    NvDsReplayFrame *frame = &bench->frames[s];
+    NvDsDetectionLogRecord *objects =
+        &bench->objects[s * MAX (config->num_objects, 1)];
+
+    frame->source_id = s;
+    frame->frame_num = bench->batch;
+    frame->pts = bench->batch * BENCH_FRAME_DURATION_NS;
+    frame->num_objects = config->num_objects;
+    frame->objects = objects;
+
+    for (i = 0; i < config->num_objects; i++) {
+      NvDsDetectionLogRecord *obj = &objects[i];
+      guint w = 40 + (i * 37) % 160;
+      guint h = 80 + (i * 53) % 240;
+      guint span_x = config->frame_width > w ? config->frame_width - w : 1;
+      guint span_y = config->frame_height > h ? config->frame_height - h : 1;
+
+      obj->type = NV_DS_DETECTION_LOG_OBJECT;
+      obj->class_id = i % BENCH_NUM_CLASSES;
+      obj->object_id = (guint64) s << 32 | i;
+      obj->left = (i * 97 + bench->batch * (1 + i % 5)) % span_x;
+      obj->top = (i * 61 + bench->batch * (1 + i % 3)) % span_y;
+      obj->width = w;
+      obj->height = h;
+      obj->confidence = 0.5 + (i % 50) / 100.0;
+      obj->component_id = config->component_id;
+      g_snprintf (obj->label, sizeof (obj->label), "class%u", obj->class_id);
+    }
+  }
+
+  bench->batch++;
+  *frames = bench->frames;
+  return config->num_sources;
+}
+
+const gchar *
+nvds_bench_get_label (NvDsBench * bench, guint object, guint label)
+{
+  return bench_labels[(object * 3 + label) % G_N_ELEMENTS (bench_labels)];
+}
+
+void
+nvds_bench_record (NvDsBench * bench, guint stage, guint64 ns)
+{
+  if (stage >= bench->num_stages || bench->batch <= bench->config.num_warmup)
+    return;
+  g_array_append_val (bench->stages[stage].samples, ns);
+}
+
+static gint
+bench_compare_ns (gconstpointer a, gconstpointer b)
+{
+  guint64 na = *(const guint64 *) a;
+  guint64 nb = *(const guint64 *) b;
+
+  return na < nb ? -1 : na > nb;
+}
+
+/* Nearest-rank percentile of sorted @samples. */
+static guint64
+bench_percentile (GArray * samples, gdouble p)
+{
+  guint rank;
+
+  if (samples->len == 0)
+    return 0;
+  rank = (guint) (p / 100 * samples->len + 0.999999);
+  rank = CLAMP (rank, 1, samples->len);
+  return g_array_index (samples, guint64, rank - 1);
+}
+
+gboolean
+nvds_bench_write_results (NvDsBench * bench)
+{
+  NvDsBenchConfig *config = &bench->config;
+  FILE *out = stdout;
+  guint i, j;
+
+  if (config->output_path && strcmp (config->output_path, "-") != 0) {
+    out = fopen (config->output_path, "w");
+    if (!out) {
+      g_printerr ("bench: cannot write %s\n", config->output_path);
+      return FALSE;
+    }
+  }
+
+  fprintf (out, "{\n  \"config\": {\"sources\": %u, \"objects_per_frame\": %u, "
+      "\"labels_per_object\": %u, \"batches\": %u, \"warmup\": %u, "
+      "\"frame_width\": %u, \"frame_height\": %u},\n  \"stages\": [\n",
+      config->num_sources, config->num_objects, config->num_labels,
+      config->num_batches, config->num_warmup, config->frame_width,
+      config->frame_height);
+
+  for (i = 0; i < bench->num_stages; i++) {
+    GArray *samples = bench->stages[i].samples;
+    guint64 total = 0;
+
+    g_array_sort (samples, bench_compare_ns);
+    for (j = 0; j < samples->len; j++)
+      total += g_array_index (samples, guint64, j);
+
+    fprintf (out, "    {\"name\": \"%s\", \"count\": %u, \"mean_ns\": %.1f, "
+        "\"min_ns\": %lu, \"p50_ns\": %lu, \"p90_ns\": %lu, "
+        "\"p99_ns\": %lu, \"p999_ns\": %lu, \"max_ns\": %lu}%s\n",
+        bench->stages[i].name, samples->len,
+        samples->len ? (gdouble) total / samples->len : 0,
+        (gulong) bench_percentile (samples, 0),
+        (gulong) bench_percentile (samples, 50),
+        (gulong) bench_percentile (samples, 90),
+        (gulong) bench_percentile (samples, 99),
+        (gulong) bench_percentile (samples, 99.9),
+        (gulong) bench_percentile (samples, 100),
+        i + 1 < bench->num_stages ? "," : "");
+  }
+  fprintf (out, "  ]\n}\n");
+
+  if (out != stdout)
+    fclose (out);
+  return TRUE;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_BENCH_H__
+#define __NVGSTDS_APP_BENCH_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_replay.h"
+
+typedef struct
+{
+  /** Where to write the JSON results, "-" for stdout. */
+  gchar *output_path;
+  guint num_sources;
+  guint num_objects;
+  /** Classifier labels attached to every object, one classifier each. */
+  guint num_labels;
+  /** Measured batches, and batches run before measuring starts. */
+  guint num_batches;
+  guint num_warmup;
+  guint frame_width;
+  guint frame_height;
+  /** unique_component_id of the generated objects. */
+  guint component_id;
+} NvDsBenchConfig;
+
+typedef struct _NvDsBench NvDsBench;
+
+/**
+ * Set up a run timing each of the @num_stages named stages once per batch.
+ */
+NvDsBench *nvds_bench_new (NvDsBenchConfig * config,
+    const gchar * const *stages, guint num_stages);
+
+void nvds_bench_free (NvDsBench * bench);
+
+guint64 nvds_bench_now_ns (void);
+
+/**
+ * Generate the next synthetic batch: one frame per source with
+ * num_objects boxes drifting across the frame under stable object ids,
+ * as a tracker would report them.
+ *
+ * @return number of frames, 0 once warm-up and measured batches are done.
+ */
+guint nvds_bench_next_batch (NvDsBench * bench,
+    const NvDsReplayFrame ** frames);
+
+/**
+ * Text of classifier label @label of the @object'th object of a frame.
+ */
+const gchar *nvds_bench_get_label (NvDsBench * bench, guint object,
+    guint label);
+
+/**
+ * Account @ns to @stage for the current batch; ignored during warm-up.
+ */
+void nvds_bench_record (NvDsBench * bench, guint stage, guint64 ns);
+
+/**
+ * Write count, mean, min, max and percentiles of every stage as JSON.
+ */
+gboolean nvds_bench_write_results (NvDsBench * bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -28,39 +28,1060 @@
 #define CONFIG_GROUP_APP_PERF_MEASUREMENT_INTERVAL "perf-measurement-interval-sec"
 #define CONFIG_GROUP_APP_GIE_OUTPUT_DIR "gie-kitti-output-dir"
 #define CONFIG_GROUP_APP_GIE_TRACK_OUTPUT_DIR "kitti-track-output-dir"
+#define CONFIG_GROUP_APP_GIE_LOG_DIR "gie-detection-log-dir"
+#define CONFIG_GROUP_APP_TRACK_LOG_DIR "track-detection-log-dir"
+#define CONFIG_GROUP_APP_ENABLE_STAGE_LATENCY "enable-stage-latency"
 
 #define CONFIG_GROUP_TESTS "tests"
 #define CONFIG_GROUP_TESTS_FILE_LOOP "file-loop"
 
+#define CONFIG_GROUP_MOTOR "motor"
+#define CONFIG_GROUP_MOTOR_ENABLE "enable"
+#define CONFIG_GROUP_MOTOR_BACKEND "backend"
+#define CONFIG_GROUP_MOTOR_DEVICE "device"
+#define CONFIG_GROUP_MOTOR_I2C_ADDRESS "i2c-address"
+#define CONFIG_GROUP_MOTOR_LEFT_CHANNEL "left-channel"
+#define CONFIG_GROUP_MOTOR_RIGHT_CHANNEL "right-channel"
+#define CONFIG_GROUP_MOTOR_VERTICAL_CHANNEL "vertical-channel"
+
+#define CONFIG_GROUP_SERVO "servo"
+#define CONFIG_GROUP_SERVO_ENABLE "enable"
+#define CONFIG_GROUP_SERVO_DEVICE "device"
+#define CONFIG_GROUP_SERVO_BAUD_RATE "baud-rate"
+#define CONFIG_GROUP_SERVO_MOVE_TIME "move-time"
+
+#define CONFIG_GROUP_PANTILT "pan-tilt"
+#define CONFIG_GROUP_PANTILT_ENABLE "enable"
+#define CONFIG_GROUP_PANTILT_PAN_KP "pan-kp"
+#define CONFIG_GROUP_PANTILT_PAN_KI "pan-ki"
+#define CONFIG_GROUP_PANTILT_TILT_KP "tilt-kp"
+#define CONFIG_GROUP_PANTILT_TILT_KI "tilt-ki"
+#define CONFIG_GROUP_PANTILT_DEADBAND "deadband"
+#define CONFIG_GROUP_PANTILT_MAX_SLEW "max-slew"
+#define CONFIG_GROUP_PANTILT_PAN_HOME "pan-home"
+#define CONFIG_GROUP_PANTILT_TILT_HOME "tilt-home"
+
+#define CONFIG_GROUP_TARGET "target"
+#define CONFIG_GROUP_TARGET_CLASS_ID "class-id"
+#define CONFIG_GROUP_TARGET_SWITCH_MARGIN "switch-margin"
+#define CONFIG_GROUP_TARGET_SWITCH_FRAMES "switch-frames"
+#define CONFIG_GROUP_TARGET_LOST_FRAMES "lost-frames"
+
+#define CONFIG_GROUP_PREDICTOR "predictor"
+#define CONFIG_GROUP_PREDICTOR_ENABLE "enable"
+#define CONFIG_GROUP_PREDICTOR_ACTUATOR_DELAY "actuator-delay-ms"
+#define CONFIG_GROUP_PREDICTOR_PROCESS_NOISE "process-noise"
+#define CONFIG_GROUP_PREDICTOR_MEASUREMENT_NOISE "measurement-noise"
+
+#define CONFIG_GROUP_FALL "fall-detection"
+#define CONFIG_GROUP_FALL_ENABLE "enable"
+#define CONFIG_GROUP_FALL_CLASS_ID "class-id"
+#define CONFIG_GROUP_FALL_STAND_RATIO "stand-ratio"
+#define CONFIG_GROUP_FALL_LIE_RATIO "lie-ratio"
+#define CONFIG_GROUP_FALL_MAX_FALL_MS "max-fall-ms"
+#define CONFIG_GROUP_FALL_MIN_DROP "min-drop"
+
+#define CONFIG_GROUP_ZONE "zone"
+#define CONFIG_GROUP_ZONE_ENABLE "enable"
+#define CONFIG_GROUP_ZONE_NAME "name"
+#define CONFIG_GROUP_ZONE_SOURCE_ID "source-id"
+#define CONFIG_GROUP_ZONE_POINTS "points"
+#define CONFIG_GROUP_ZONE_LINGER_SEC "linger-sec"
+#define CONFIG_GROUP_ZONE_LEAVE_AFTER_SEC "leave-after-sec"
+#define CONFIG_GROUP_ZONE_START_HOUR "start-hour"
+#define CONFIG_GROUP_ZONE_END_HOUR "end-hour"
+
+#define CONFIG_GROUP_RECORDER "recorder"
+#define CONFIG_GROUP_RECORDER_ENABLE "enable"
+#define CONFIG_GROUP_RECORDER_PRE_EVENT_SEC "pre-event-sec"
+#define CONFIG_GROUP_RECORDER_POST_EVENT_SEC "post-event-sec"
+#define CONFIG_GROUP_RECORDER_CONTAINER "container"
+#define CONFIG_GROUP_RECORDER_OUTPUT_DIR "output-dir"
+#define CONFIG_GROUP_RECORDER_ENCODER "encoder"
+#define CONFIG_GROUP_RECORDER_BITRATE "bitrate"
+#define CONFIG_GROUP_RECORDER_IFRAME_INTERVAL "iframe-interval"
+#define CONFIG_GROUP_RECORDER_MAX_RING_KB "max-ring-kb"
+
+#define CONFIG_GROUP_META_WRITER "meta-writer"
+#define CONFIG_GROUP_META_WRITER_QUEUE_SIZE "queue-size"
+#define CONFIG_GROUP_META_WRITER_BATCH_SIZE "batch-size"
+#define CONFIG_GROUP_META_WRITER_OVERFLOW_POLICY "overflow-policy"
+
+#define CONFIG_GROUP_METRICS "metrics"
+#define CONFIG_GROUP_METRICS_ENABLE "enable"
+#define CONFIG_GROUP_METRICS_PORT "port"
+#define CONFIG_GROUP_METRICS_UNIX_SOCKET "unix-socket"
+
+#define CONFIG_GROUP_ADAPTIVE "adaptive-interval"
+#define CONFIG_GROUP_ADAPTIVE_ENABLE "enable"
+#define CONFIG_GROUP_ADAPTIVE_MIN_INTERVAL "min-interval"
+#define CONFIG_GROUP_ADAPTIVE_MAX_INTERVAL "max-interval"
+#define CONFIG_GROUP_ADAPTIVE_CLASS_ID "class-id"
+#define CONFIG_GROUP_ADAPTIVE_FAST_SPEED "fast-speed"
+#define CONFIG_GROUP_ADAPTIVE_STILL_SPEED "still-speed"
+#define CONFIG_GROUP_ADAPTIVE_IDLE_MS "idle-ms"
+#define CONFIG_GROUP_ADAPTIVE_STEP_MS "step-ms"
+
+#define CONFIG_GROUP_GOVERNOR "governor"
+#define CONFIG_GROUP_GOVERNOR_ENABLE "enable"
+#define CONFIG_GROUP_GOVERNOR_SYSFS_ROOT "sysfs-root"
+#define CONFIG_GROUP_GOVERNOR_POLL_MS "poll-ms"
+#define CONFIG_GROUP_GOVERNOR_THERMAL_ZONE "thermal-zone"
+#define CONFIG_GROUP_GOVERNOR_WARM_TEMP "warm-temp"
+#define CONFIG_GROUP_GOVERNOR_HOT_TEMP "hot-temp"
+#define CONFIG_GROUP_GOVERNOR_CRITICAL_TEMP "critical-temp"
+#define CONFIG_GROUP_GOVERNOR_HYSTERESIS "hysteresis"
+#define CONFIG_GROUP_GOVERNOR_POWER_FILE "power-file"
+#define CONFIG_GROUP_GOVERNOR_POWER_LIMIT_MW "power-limit-mw"
+#define CONFIG_GROUP_GOVERNOR_INTERVAL "interval"
+#define CONFIG_GROUP_GOVERNOR_CRITICAL_INTERVAL "critical-interval"
+
+#define CONFIG_GROUP_MOTION_GATE "motion-gate"
+#define CONFIG_GROUP_MOTION_GATE_ENABLE "enable"
+#define CONFIG_GROUP_MOTION_GATE_CELL_SIZE "cell-size"
+#define CONFIG_GROUP_MOTION_GATE_PIXEL_THRESHOLD "pixel-threshold"
+#define CONFIG_GROUP_MOTION_GATE_THRESHOLD "threshold"
+#define CONFIG_GROUP_MOTION_GATE_FORCE_INTERVAL "force-interval"
+#define CONFIG_GROUP_MOTION_GATE_SIMD "simd"
+
+#define CONFIG_GROUP_PERF_REPORT "perf-report"
+#define CONFIG_GROUP_PERF_REPORT_ENABLE "enable"
+#define CONFIG_GROUP_PERF_REPORT_PATH "path"
+#define CONFIG_GROUP_PERF_REPORT_FORMAT "format"
+#define CONFIG_GROUP_PERF_REPORT_MAX_SIZE_MB "max-size-mb"
+
 GST_DEBUG_CATEGORY_EXTERN (APP_CFG_PARSER_CAT);
 
 
-#define CHECK_ERROR(error) \
-    if (error) { \
-        GST_CAT_ERROR (APP_CFG_PARSER_CAT, "%s", error->message); \
-        goto done; \
+#define CHECK_ERROR(error) \
+    if (error) { \
+        GST_CAT_ERROR (APP_CFG_PARSER_CAT, "%s", error->message); \
+        goto done; \
+    }
+
+static gboolean
+parse_tests (NvDsConfig *config, GKeyFile *key_file)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_TESTS, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_TESTS_FILE_LOOP)) {
+      config->file_loop =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_TESTS,
+          CONFIG_GROUP_TESTS_FILE_LOOP, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_TESTS);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_motor (NvDsMotorConfig *config, GKeyFile *key_file, gchar *cfg_file_path)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_MOTOR, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_MOTOR_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTOR,
+          CONFIG_GROUP_MOTOR_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTOR_BACKEND)) {
+      gchar *backend = g_key_file_get_string (key_file, CONFIG_GROUP_MOTOR,
+          CONFIG_GROUP_MOTOR_BACKEND, &error);
+      CHECK_ERROR (error);
+      if (!g_strcmp0 (backend, "python")) {
+        config->backend = NV_DS_MOTOR_BACKEND_PYTHON;
+      } else if (!g_strcmp0 (backend, "i2c")) {
+        config->backend = NV_DS_MOTOR_BACKEND_I2C;
+      } else if (!g_strcmp0 (backend, "file")) {
+        config->backend = NV_DS_MOTOR_BACKEND_FILE;
+      } else {
+        NVGSTDS_ERR_MSG_V ("Unknown motor backend '%s'", backend);
+        g_free (backend);
+        goto done;
+      }
+      g_free (backend);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTOR_DEVICE)) {
+      config->device = get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_MOTOR,
+          CONFIG_GROUP_MOTOR_DEVICE, &error));
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTOR_I2C_ADDRESS)) {
+      config->i2c_address =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTOR,
+          CONFIG_GROUP_MOTOR_I2C_ADDRESS, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTOR_LEFT_CHANNEL)) {
+      config->left_channel =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTOR,
+          CONFIG_GROUP_MOTOR_LEFT_CHANNEL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTOR_RIGHT_CHANNEL)) {
+      config->right_channel =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTOR,
+          CONFIG_GROUP_MOTOR_RIGHT_CHANNEL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTOR_VERTICAL_CHANNEL)) {
+      config->vertical_channel =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTOR,
+          CONFIG_GROUP_MOTOR_VERTICAL_CHANNEL, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_MOTOR);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_servo (NvDsServoConfig *config, GKeyFile *key_file, gchar *cfg_file_path)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_SERVO, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_SERVO_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_SERVO,
+          CONFIG_GROUP_SERVO_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_SERVO_DEVICE)) {
+      config->device = get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_SERVO,
+          CONFIG_GROUP_SERVO_DEVICE, &error));
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_SERVO_BAUD_RATE)) {
+      config->baud_rate =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_SERVO,
+          CONFIG_GROUP_SERVO_BAUD_RATE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_SERVO_MOVE_TIME)) {
+      config->move_time =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_SERVO,
+          CONFIG_GROUP_SERVO_MOVE_TIME, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_SERVO);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_pantilt (NvDsPanTiltConfig *config, GKeyFile *key_file)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_PANTILT, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_PAN_KP)) {
+      config->pan_kp =
+          g_key_file_get_double (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_PAN_KP, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_PAN_KI)) {
+      config->pan_ki =
+          g_key_file_get_double (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_PAN_KI, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_TILT_KP)) {
+      config->tilt_kp =
+          g_key_file_get_double (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_TILT_KP, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_TILT_KI)) {
+      config->tilt_ki =
+          g_key_file_get_double (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_TILT_KI, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_DEADBAND)) {
+      config->deadband =
+          g_key_file_get_double (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_DEADBAND, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_MAX_SLEW)) {
+      config->max_slew =
+          g_key_file_get_double (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_MAX_SLEW, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_PAN_HOME)) {
+      config->pan_home =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_PAN_HOME, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PANTILT_TILT_HOME)) {
+      config->tilt_home =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_PANTILT,
+          CONFIG_GROUP_PANTILT_TILT_HOME, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_PANTILT);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_target (NvDsTargetConfig *config, GKeyFile *key_file)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_TARGET, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_TARGET_CLASS_ID)) {
+      config->class_id =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_TARGET,
+          CONFIG_GROUP_TARGET_CLASS_ID, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TARGET_SWITCH_MARGIN)) {
+      config->switch_margin =
+          g_key_file_get_double (key_file, CONFIG_GROUP_TARGET,
+          CONFIG_GROUP_TARGET_SWITCH_MARGIN, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TARGET_SWITCH_FRAMES)) {
+      config->switch_frames =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_TARGET,
+          CONFIG_GROUP_TARGET_SWITCH_FRAMES, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TARGET_LOST_FRAMES)) {
+      config->lost_frames =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_TARGET,
+          CONFIG_GROUP_TARGET_LOST_FRAMES, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_TARGET);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_predictor (NvDsPredictorConfig *config, GKeyFile *key_file)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_PREDICTOR, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_PREDICTOR_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_PREDICTOR,
+          CONFIG_GROUP_PREDICTOR_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PREDICTOR_ACTUATOR_DELAY)) {
+      config->actuator_delay_ms =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_PREDICTOR,
+          CONFIG_GROUP_PREDICTOR_ACTUATOR_DELAY, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PREDICTOR_PROCESS_NOISE)) {
+      config->process_noise =
+          g_key_file_get_double (key_file, CONFIG_GROUP_PREDICTOR,
+          CONFIG_GROUP_PREDICTOR_PROCESS_NOISE, &error);
+      CHECK_ERROR (error);
+      /* The Kalman gain divides by the noise covariances. */
+      if (config->process_noise <= 0) {
+        NVGSTDS_ERR_MSG_V ("[%s] %s must be > 0", CONFIG_GROUP_PREDICTOR,
+            CONFIG_GROUP_PREDICTOR_PROCESS_NOISE);
+        goto done;
+      }
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PREDICTOR_MEASUREMENT_NOISE)) {
+      config->measurement_noise =
+          g_key_file_get_double (key_file, CONFIG_GROUP_PREDICTOR,
+          CONFIG_GROUP_PREDICTOR_MEASUREMENT_NOISE, &error);
+      CHECK_ERROR (error);
+      if (config->measurement_noise <= 0) {
+        NVGSTDS_ERR_MSG_V ("[%s] %s must be > 0", CONFIG_GROUP_PREDICTOR,
+            CONFIG_GROUP_PREDICTOR_MEASUREMENT_NOISE);
+        goto done;
+      }
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_PREDICTOR);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_fall (NvDsFallConfig *config, GKeyFile *key_file)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_FALL, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_FALL_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_FALL,
+          CONFIG_GROUP_FALL_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_FALL_CLASS_ID)) {
+      config->class_id =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_FALL,
+          CONFIG_GROUP_FALL_CLASS_ID, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_FALL_STAND_RATIO)) {
+      config->stand_ratio =
+          g_key_file_get_double (key_file, CONFIG_GROUP_FALL,
+          CONFIG_GROUP_FALL_STAND_RATIO, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_FALL_LIE_RATIO)) {
+      config->lie_ratio =
+          g_key_file_get_double (key_file, CONFIG_GROUP_FALL,
+          CONFIG_GROUP_FALL_LIE_RATIO, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_FALL_MAX_FALL_MS)) {
+      config->max_fall_ms =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_FALL,
+          CONFIG_GROUP_FALL_MAX_FALL_MS, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_FALL_MIN_DROP)) {
+      config->min_drop =
+          g_key_file_get_double (key_file, CONFIG_GROUP_FALL,
+          CONFIG_GROUP_FALL_MIN_DROP, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_FALL);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+/**
+ * Parse a [zoneN] group. points is a list of x;y pairs in streammux
+ * resolution, e.g. points=100;400;500;400;500;700;100;700
+ */
+static gboolean
+parse_zone (NvDsZoneConfig *config, GKeyFile *key_file, gchar *group)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+  gdouble *points = NULL;
+  gsize length, i;
+
+  keys = g_key_file_get_keys (key_file, group, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_ZONE_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_ZONE_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ZONE_NAME)) {
+      config->name =
+          g_key_file_get_string (key_file, group,
+          CONFIG_GROUP_ZONE_NAME, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ZONE_SOURCE_ID)) {
+      config->source_id =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_ZONE_SOURCE_ID, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ZONE_POINTS)) {
+      points =
+          g_key_file_get_double_list (key_file, group,
+          CONFIG_GROUP_ZONE_POINTS, &length, &error);
+      CHECK_ERROR (error);
+      if (length % 2 || length < 6 || length > 2 * NVDS_ZONE_MAX_POINTS) {
+        NVGSTDS_ERR_MSG_V ("[%s] needs 3 to %d x;y points", group,
+            NVDS_ZONE_MAX_POINTS);
+        goto done;
+      }
+      config->num_points = length / 2;
+      for (i = 0; i < config->num_points; i++) {
+        config->points_x[i] = points[2 * i];
+        config->points_y[i] = points[2 * i + 1];
+      }
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ZONE_LINGER_SEC)) {
+      config->linger_sec =
+          g_key_file_get_double (key_file, group,
+          CONFIG_GROUP_ZONE_LINGER_SEC, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ZONE_LEAVE_AFTER_SEC)) {
+      config->leave_after_sec =
+          g_key_file_get_double (key_file, group,
+          CONFIG_GROUP_ZONE_LEAVE_AFTER_SEC, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ZONE_START_HOUR)) {
+      config->start_hour =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_ZONE_START_HOUR, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ZONE_END_HOUR)) {
+      config->end_hour =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_ZONE_END_HOUR, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key, group);
+    }
+  }
+
+  if (config->enable && config->num_points == 0) {
+    NVGSTDS_ERR_MSG_V ("[%s] has no points", group);
+    goto done;
+  }
+  if (!config->name) {
+    config->name = g_strdup (group);
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  g_free (points);
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_recorder (NvDsRecorderConfig *config, GKeyFile *key_file,
+    gchar *cfg_file_path)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_RECORDER, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_RECORDER,
+          CONFIG_GROUP_RECORDER_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_PRE_EVENT_SEC)) {
+      config->pre_event_sec =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_RECORDER,
+          CONFIG_GROUP_RECORDER_PRE_EVENT_SEC, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_POST_EVENT_SEC)) {
+      config->post_event_sec =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_RECORDER,
+          CONFIG_GROUP_RECORDER_POST_EVENT_SEC, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_CONTAINER)) {
+      gchar *container = g_key_file_get_string (key_file,
+          CONFIG_GROUP_RECORDER, CONFIG_GROUP_RECORDER_CONTAINER, &error);
+      CHECK_ERROR (error);
+      if (!g_strcmp0 (container, "mp4")) {
+        config->container = NV_DS_RECORDER_CONTAINER_MP4;
+      } else if (!g_strcmp0 (container, "mkv")) {
+        config->container = NV_DS_RECORDER_CONTAINER_MKV;
+      } else {
+        NVGSTDS_ERR_MSG_V ("Unknown recorder container '%s'", container);
+        g_free (container);
+        goto done;
+      }
+      g_free (container);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_OUTPUT_DIR)) {
+      config->output_dir = get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_RECORDER,
+          CONFIG_GROUP_RECORDER_OUTPUT_DIR, &error));
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_ENCODER)) {
+      config->encoder =
+          g_key_file_get_string (key_file, CONFIG_GROUP_RECORDER,
+          CONFIG_GROUP_RECORDER_ENCODER, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_BITRATE)) {
+      config->bitrate =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_RECORDER,
+          CONFIG_GROUP_RECORDER_BITRATE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_IFRAME_INTERVAL)) {
+      config->iframe_interval =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_RECORDER,
+          CONFIG_GROUP_RECORDER_IFRAME_INTERVAL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_RECORDER_MAX_RING_KB)) {
+      config->max_ring_kb =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_RECORDER,
+          CONFIG_GROUP_RECORDER_MAX_RING_KB, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_RECORDER);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_meta_writer (NvDsMetaWriterConfig *config, GKeyFile *key_file)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_META_WRITER, NULL,
+      &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_META_WRITER_QUEUE_SIZE)) {
+      config->queue_size =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_META_WRITER,
+          CONFIG_GROUP_META_WRITER_QUEUE_SIZE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_META_WRITER_BATCH_SIZE)) {
+      config->batch_size =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_META_WRITER,
+          CONFIG_GROUP_META_WRITER_BATCH_SIZE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_META_WRITER_OVERFLOW_POLICY)) {
+      gchar *policy = g_key_file_get_string (key_file,
+          CONFIG_GROUP_META_WRITER, CONFIG_GROUP_META_WRITER_OVERFLOW_POLICY,
+          &error);
+      CHECK_ERROR (error);
+      if (!g_strcmp0 (policy, "block")) {
+        config->overflow_policy = NV_DS_META_WRITER_BLOCK;
+      } else if (!g_strcmp0 (policy, "drop")) {
+        config->overflow_policy = NV_DS_META_WRITER_DROP;
+      } else if (!g_strcmp0 (policy, "count")) {
+        config->overflow_policy = NV_DS_META_WRITER_COUNT;
+      } else {
+        NVGSTDS_ERR_MSG_V ("Unknown overflow policy '%s'", policy);
+        g_free (policy);
+        goto done;
+      }
+      g_free (policy);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_META_WRITER);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_metrics (NvDsMetricsConfig *config, GKeyFile *key_file,
+    gchar *cfg_file_path)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_METRICS, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_METRICS_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_METRICS,
+          CONFIG_GROUP_METRICS_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_METRICS_PORT)) {
+      config->port =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_METRICS,
+          CONFIG_GROUP_METRICS_PORT, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_METRICS_UNIX_SOCKET)) {
+      config->unix_socket = get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_METRICS,
+          CONFIG_GROUP_METRICS_UNIX_SOCKET, &error));
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_METRICS);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_adaptive (NvDsAdaptiveConfig *config, GKeyFile *key_file)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_ADAPTIVE, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_ADAPTIVE_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_ADAPTIVE,
+          CONFIG_GROUP_ADAPTIVE_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ADAPTIVE_MIN_INTERVAL)) {
+      config->min_interval =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_ADAPTIVE,
+          CONFIG_GROUP_ADAPTIVE_MIN_INTERVAL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ADAPTIVE_MAX_INTERVAL)) {
+      config->max_interval =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_ADAPTIVE,
+          CONFIG_GROUP_ADAPTIVE_MAX_INTERVAL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ADAPTIVE_CLASS_ID)) {
+      config->class_id =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_ADAPTIVE,
+          CONFIG_GROUP_ADAPTIVE_CLASS_ID, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ADAPTIVE_FAST_SPEED)) {
+      config->fast_speed =
+          g_key_file_get_double (key_file, CONFIG_GROUP_ADAPTIVE,
+          CONFIG_GROUP_ADAPTIVE_FAST_SPEED, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ADAPTIVE_STILL_SPEED)) {
+      config->still_speed =
+          g_key_file_get_double (key_file, CONFIG_GROUP_ADAPTIVE,
+          CONFIG_GROUP_ADAPTIVE_STILL_SPEED, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ADAPTIVE_IDLE_MS)) {
+      config->idle_ms =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_ADAPTIVE,
+          CONFIG_GROUP_ADAPTIVE_IDLE_MS, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_ADAPTIVE_STEP_MS)) {
+      config->step_ms =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_ADAPTIVE,
+          CONFIG_GROUP_ADAPTIVE_STEP_MS, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_ADAPTIVE);
     }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
 
 static gboolean
-parse_tests (NvDsConfig *config, GKeyFile *key_file)
+parse_governor (NvDsGovernorConfig *config, GKeyFile *key_file,
+    gchar *cfg_file_path)
 {
   gboolean ret = FALSE;
   gchar **keys = NULL;
   gchar **key = NULL;
   GError *error = NULL;
 
-  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_TESTS, NULL, &error);
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_GOVERNOR, NULL, &error);
   CHECK_ERROR (error);
 
   for (key = keys; *key; key++) {
-    if (!g_strcmp0 (*key, CONFIG_GROUP_TESTS_FILE_LOOP)) {
-      config->file_loop =
-          g_key_file_get_integer (key_file, CONFIG_GROUP_TESTS,
-          CONFIG_GROUP_TESTS_FILE_LOOP, &error);
+    if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_SYSFS_ROOT)) {
+      config->sysfs_root = get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_SYSFS_ROOT, &error));
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_POLL_MS)) {
+      config->poll_ms =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_POLL_MS, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_THERMAL_ZONE)) {
+      config->thermal_zone =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_THERMAL_ZONE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_WARM_TEMP)) {
+      config->band_temp[NV_DS_GOVERNOR_WARM - 1] =
+          g_key_file_get_double (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_WARM_TEMP, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_HOT_TEMP)) {
+      config->band_temp[NV_DS_GOVERNOR_HOT - 1] =
+          g_key_file_get_double (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_HOT_TEMP, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_CRITICAL_TEMP)) {
+      config->band_temp[NV_DS_GOVERNOR_CRITICAL - 1] =
+          g_key_file_get_double (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_CRITICAL_TEMP, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_HYSTERESIS)) {
+      config->hysteresis =
+          g_key_file_get_double (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_HYSTERESIS, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_POWER_FILE)) {
+      /* Relative to sysfs-root, not to the config file. */
+      config->power_file = g_key_file_get_string (key_file,
+          CONFIG_GROUP_GOVERNOR, CONFIG_GROUP_GOVERNOR_POWER_FILE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_POWER_LIMIT_MW)) {
+      config->power_limit_mw =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_POWER_LIMIT_MW, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_INTERVAL)) {
+      config->interval =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_INTERVAL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_GOVERNOR_CRITICAL_INTERVAL)) {
+      config->critical_interval =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_GOVERNOR,
+          CONFIG_GROUP_GOVERNOR_CRITICAL_INTERVAL, &error);
       CHECK_ERROR (error);
     } else {
       NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
-          CONFIG_GROUP_TESTS);
+          CONFIG_GROUP_GOVERNOR);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+static gboolean
+parse_motion_gate (NvDsMotionGateConfig *config, GKeyFile *key_file)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_MOTION_GATE, NULL,
+      &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_MOTION_GATE_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTION_GATE,
+          CONFIG_GROUP_MOTION_GATE_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTION_GATE_CELL_SIZE)) {
+      config->cell_size =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTION_GATE,
+          CONFIG_GROUP_MOTION_GATE_CELL_SIZE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTION_GATE_PIXEL_THRESHOLD)) {
+      config->pixel_threshold =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTION_GATE,
+          CONFIG_GROUP_MOTION_GATE_PIXEL_THRESHOLD, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTION_GATE_THRESHOLD)) {
+      config->threshold =
+          g_key_file_get_double (key_file, CONFIG_GROUP_MOTION_GATE,
+          CONFIG_GROUP_MOTION_GATE_THRESHOLD, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTION_GATE_FORCE_INTERVAL)) {
+      config->force_interval =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTION_GATE,
+          CONFIG_GROUP_MOTION_GATE_FORCE_INTERVAL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_MOTION_GATE_SIMD)) {
+      config->simd =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_MOTION_GATE,
+          CONFIG_GROUP_MOTION_GATE_SIMD, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_MOTION_GATE);
     }
   }
 
@@ -78,6 +1099,68 @@ done:
   return ret;
 }
 
+static gboolean
+parse_perf_report (NvDsPerfReportConfig *config, GKeyFile *key_file,
+    gchar *cfg_file_path)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  keys = g_key_file_get_keys (key_file, CONFIG_GROUP_PERF_REPORT, NULL,
+      &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_PERF_REPORT_ENABLE)) {
+      config->enable =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_PERF_REPORT,
+          CONFIG_GROUP_PERF_REPORT_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PERF_REPORT_PATH)) {
+      config->path = get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_PERF_REPORT,
+          CONFIG_GROUP_PERF_REPORT_PATH, &error));
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PERF_REPORT_FORMAT)) {
+      gchar *format = g_key_file_get_string (key_file,
+          CONFIG_GROUP_PERF_REPORT, CONFIG_GROUP_PERF_REPORT_FORMAT, &error);
+      CHECK_ERROR (error);
+      if (!g_strcmp0 (format, "csv")) {
+        config->format = NV_DS_PERF_REPORT_CSV;
+      } else if (!g_strcmp0 (format, "json")) {
+        config->format = NV_DS_PERF_REPORT_JSON;
+      } else {
+        NVGSTDS_ERR_MSG_V ("Unknown perf report format '%s'", format);
+        g_free (format);
+        goto done;
+      }
+      g_free (format);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_PERF_REPORT_MAX_SIZE_MB)) {
+      config->max_size_mb =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_PERF_REPORT,
+          CONFIG_GROUP_PERF_REPORT_MAX_SIZE_MB, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
+          CONFIG_GROUP_PERF_REPORT);
+    }
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
 
 static gboolean
 parse_app (NvDsConfig *config, GKeyFile *key_file, gchar *cfg_file_path)
@@ -101,6 +1184,11 @@ parse_app (NvDsConfig *config, GKeyFile *key_file, gchar *cfg_file_path)
           g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
           CONFIG_GROUP_APP_PERF_MEASUREMENT_INTERVAL, &error);
       CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ENABLE_STAGE_LATENCY)) {
+      config->enable_stage_latency =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ENABLE_STAGE_LATENCY, &error);
+      CHECK_ERROR (error);
     } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_GIE_OUTPUT_DIR)) {
       config->bbox_dir_path = get_absolute_file_path (cfg_file_path,
           g_key_file_get_string (key_file, CONFIG_GROUP_APP,
@@ -111,6 +1199,16 @@ parse_app (NvDsConfig *config, GKeyFile *key_file, gchar *cfg_file_path)
           g_key_file_get_string (key_file, CONFIG_GROUP_APP,
           CONFIG_GROUP_APP_GIE_TRACK_OUTPUT_DIR, &error));
       CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_GIE_LOG_DIR)) {
+      config->bbox_log_dir_path = get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_GIE_LOG_DIR, &error));
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_TRACK_LOG_DIR)) {
+      config->track_log_dir_path = get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_TRACK_LOG_DIR, &error));
+      CHECK_ERROR (error);
     } else {
       NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
                           CONFIG_GROUP_APP);
@@ -131,6 +1229,69 @@ done:
   return ret;
 }
 
+static void
+set_config_defaults (NvDsConfig *config)
+{
+  /* The robot has always been driven through jetbot.Robot and the camera
+   * gimbal has always been on; keep that when the config has no [motor] or
+   * [servo] group. */
+  config->motor_config.enable = TRUE;
+  config->motor_config.backend = NV_DS_MOTOR_BACKEND_PYTHON;
+  config->servo_config.enable = TRUE;
+
+  /* Pan/tilt tracking is off unless enabled; it starts from the "camera to
+   * front" preset and settles a stationary target in well under a second. */
+  config->pantilt_config.pan_kp = -500;
+  config->pantilt_config.pan_ki = -1500;
+  config->pantilt_config.tilt_kp = 400;
+  config->pantilt_config.tilt_ki = 1200;
+  config->pantilt_config.deadband = 0.05;
+  config->pantilt_config.max_slew = 2000;
+  config->pantilt_config.pan_home = 2100;
+  config->pantilt_config.tilt_home = 1500;
+
+  /* Follow any class, as before, but stick with one tracked object. */
+  config->target_config.class_id = -1;
+  config->target_config.switch_margin = 0.15;
+  config->target_config.switch_frames = 10;
+  config->target_config.lost_frames = 15;
+
+  config->predictor_config.enable = TRUE;
+  config->predictor_config.actuator_delay_ms = 50;
+  config->predictor_config.process_noise = 1000;
+  config->predictor_config.measurement_noise = 8;
+
+  config->fall_config.enable = TRUE;
+  config->fall_config.class_id = -1;
+  config->fall_config.stand_ratio = 0.8;
+  config->fall_config.lie_ratio = 1.2;
+  config->fall_config.max_fall_ms = 1500;
+  config->fall_config.min_drop = 0.1;
+
+  config->adaptive_config.max_interval = 8;
+  config->adaptive_config.class_id = -1;
+  config->adaptive_config.fast_speed = 0.5;
+  config->adaptive_config.still_speed = 0.05;
+  config->adaptive_config.idle_ms = 10000;
+  config->adaptive_config.step_ms = 5000;
+
+  config->governor_config.poll_ms = 1000;
+  config->governor_config.thermal_zone = -1;
+  config->governor_config.band_temp[0] = 60;
+  config->governor_config.band_temp[1] = 70;
+  config->governor_config.band_temp[2] = 80;
+  config->governor_config.hysteresis = 5;
+  config->governor_config.interval = 4;
+  config->governor_config.critical_interval = 8;
+  config->motion_gate_config.cell_size = 16;
+  config->motion_gate_config.pixel_threshold = 12;
+  config->motion_gate_config.threshold = 0.5;
+  config->motion_gate_config.force_interval = 30;
+  config->motion_gate_config.simd = TRUE;
+
+  config->recorder_config.pre_event_sec = 10;
+  config->recorder_config.post_event_sec = 20;
+}
 
 gboolean
 parse_config_file (NvDsConfig *config, gchar *cfg_file_path)
@@ -146,6 +1307,8 @@ parse_config_file (NvDsConfig *config, gchar *cfg_file_path)
     GST_DEBUG_CATEGORY_INIT (APP_CFG_PARSER_CAT, "NVDS_CFG_PARSER", 0, NULL);
   }
 
+  set_config_defaults (config);
+
   if (!g_key_file_load_from_file (cfg_file, cfg_file_path, G_KEY_FILE_NONE,
           &error)) {
     GST_CAT_ERROR (APP_CFG_PARSER_CAT, "Failed to load uri file: %s",
@@ -236,6 +1399,79 @@ parse_config_file (NvDsConfig *config, gchar *cfg_file_path)
       parse_err = !parse_tests (config, cfg_file);
     }
 
+    if (!g_strcmp0 (*group, CONFIG_GROUP_MOTOR)) {
+      parse_err = !parse_motor (&config->motor_config, cfg_file, cfg_file_path);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_SERVO)) {
+      parse_err = !parse_servo (&config->servo_config, cfg_file, cfg_file_path);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_PANTILT)) {
+      parse_err = !parse_pantilt (&config->pantilt_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_TARGET)) {
+      parse_err = !parse_target (&config->target_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_PREDICTOR)) {
+      parse_err = !parse_predictor (&config->predictor_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_FALL)) {
+      parse_err = !parse_fall (&config->fall_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_RECORDER)) {
+      parse_err = !parse_recorder (&config->recorder_config, cfg_file,
+          cfg_file_path);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_META_WRITER)) {
+      parse_err = !parse_meta_writer (&config->meta_writer_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_METRICS)) {
+      parse_err = !parse_metrics (&config->metrics_config, cfg_file,
+          cfg_file_path);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_ADAPTIVE)) {
+      parse_err = !parse_adaptive (&config->adaptive_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_GOVERNOR)) {
+      parse_err = !parse_governor (&config->governor_config, cfg_file,
+          cfg_file_path);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_MOTION_GATE)) {
+      parse_err = !parse_motion_gate (&config->motion_gate_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_PERF_REPORT)) {
+      parse_err = !parse_perf_report (&config->perf_report_config, cfg_file,
+          cfg_file_path);
+    }
+
+    if (!strncmp (*group, CONFIG_GROUP_ZONE, sizeof (CONFIG_GROUP_ZONE) - 1)) {
+      if (config->num_zones == NVDS_MAX_ZONES) {
+        NVGSTDS_ERR_MSG_V ("App supports max %d zones", NVDS_MAX_ZONES);
+        ret = FALSE;
+        goto done;
+      }
+      /* A disabled zone leaves its slot to the next group. */
+      g_free (config->zone_config[config->num_zones].name);
+      memset (&config->zone_config[config->num_zones], 0,
+          sizeof (NvDsZoneConfig));
+      parse_err = !parse_zone (&config->zone_config[config->num_zones],
+          cfg_file, *group);
+      if (config->zone_config[config->num_zones].enable) {
+        config->num_zones++;
+      }
+    }
+
     if (parse_err) {
       GST_CAT_ERROR (APP_CFG_PARSER_CAT, "Failed to parse '%s' group", *group);
       goto done;
@@ -306,3 +1542,127 @@ done:
   }
   return ret;
 }
+
+void
+free_bbox_color_table (GHashTable *table)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  if (!table)
+    return;
+
+  /* The colours are allocated one by one and owned by the table. */
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    g_free (value);
+  g_hash_table_unref (table);
+}
+
+static void
+free_gie_config (NvDsGieConfig *config)
+{
+  g_free (config->config_file_path);
+  g_free (config->model_engine_file_path);
+  g_free (config->label_file_path);
+  g_free (config->raw_output_directory);
+  g_free (config->list_operate_on_class_ids);
+  free_bbox_color_table (config->bbox_border_color_table);
+  free_bbox_color_table (config->bbox_bg_color_table);
+  memset (config, 0, sizeof (NvDsGieConfig));
+}
+
+gboolean
+parse_reload_config (NvDsConfig *config, gchar *cfg_file_path)
+{
+  GKeyFile *cfg_file = g_key_file_new ();
+  GError *error = NULL;
+  gboolean ret = FALSE;
+  gchar **groups = NULL;
+  gchar **group;
+
+  set_config_defaults (config);
+
+  if (!g_key_file_load_from_file (cfg_file, cfg_file_path, G_KEY_FILE_NONE,
+          &error)) {
+    NVGSTDS_ERR_MSG_V ("Failed to load config file: %s", error->message);
+    goto done;
+  }
+  groups = g_key_file_get_groups (cfg_file, NULL);
+
+  for (group = groups; *group; group++) {
+    gboolean parse_err = FALSE;
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_OSD)) {
+      parse_err = !parse_osd (&config->osd_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_PRIMARY_GIE)) {
+      parse_err =
+          !parse_gie (&config->primary_gie_config, cfg_file,
+          CONFIG_GROUP_PRIMARY_GIE, cfg_file_path);
+    }
+
+    if (!strncmp (*group, CONFIG_GROUP_SECONDARY_GIE,
+                  sizeof (CONFIG_GROUP_SECONDARY_GIE) - 1)) {
+      NvDsGieConfig *sgie = &config->secondary_gie_sub_bin_config[config->
+          num_secondary_gie_sub_bins];
+
+      if (config->num_secondary_gie_sub_bins == MAX_SECONDARY_GIE_BINS) {
+        NVGSTDS_ERR_MSG_V ("App supports max %d secondary GIEs",
+            MAX_SECONDARY_GIE_BINS);
+        goto done;
+      }
+      parse_err = !parse_gie (sgie, cfg_file, *group, cfg_file_path);
+      if (sgie->enable)
+        config->num_secondary_gie_sub_bins++;
+      else
+        free_gie_config (sgie);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_PANTILT)) {
+      parse_err = !parse_pantilt (&config->pantilt_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_ADAPTIVE)) {
+      parse_err = !parse_adaptive (&config->adaptive_config, cfg_file);
+    }
+
+    if (!g_strcmp0 (*group, CONFIG_GROUP_MOTION_GATE)) {
+      parse_err = !parse_motion_gate (&config->motion_gate_config, cfg_file);
+    }
+
+    if (parse_err) {
+      GST_CAT_ERROR (APP_CFG_PARSER_CAT, "Failed to parse '%s' group", *group);
+      goto done;
+    }
+  }
+  ret = TRUE;
+
+done:
+  g_key_file_free (cfg_file);
+  if (groups) {
+    g_strfreev (groups);
+  }
+  if (error) {
+    g_error_free (error);
+  }
+  if (!ret) {
+    free_reload_config (config);
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
+void
+free_reload_config (NvDsConfig *config)
+{
+  guint i;
+
+  g_free (config->osd_config.font);
+  config->osd_config.font = NULL;
+  free_gie_config (&config->primary_gie_config);
+  for (i = 0; i < config->num_secondary_gie_sub_bins; i++)
+    free_gie_config (&config->secondary_gie_sub_bin_config[i]);
+  config->num_secondary_gie_sub_bins = 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "deepstream_app_detection.h"
+
+/*
+ * head and tail are free-running counters; index = counter & mask. The
+ * producer publishes head with a release store after the samples are
+ * written, and the consumer publishes tail after copying a sample out, so
+ * each side only ever reads the other's counter.
+ */
+
+NvDsDetectionChannel *
+nvds_detection_channel_new (guint capacity)
+{
+  NvDsDetectionChannel *chan = g_malloc0 (sizeof (NvDsDetectionChannel));
+  guint size = 1;
+
+  while (size < capacity)
+    size <<= 1;
+
+  chan->samples = g_malloc0 (size * sizeof (NvDsDetectionSample));
+  chan->mask = size - 1;
+  sem_init (&chan->wakeup, 0, 0);
+  return chan;
+}
+
+void
+nvds_detection_channel_free (NvDsDetectionChannel * chan)
+{
+  if (!chan)
+    return;
+
+  sem_destroy (&chan->wakeup);
+  g_free (chan->samples);
+  g_free (chan);
+}
+
+gboolean
+nvds_detection_channel_push (NvDsDetectionChannel * chan,
+    const NvDsDetectionSample * sample)
+{
+  guint head = (guint) chan->head + chan->pending;
+  guint tail = (guint) g_atomic_int_get (&chan->tail);
+
+  if (head - tail > chan->mask) {
+    chan->num_dropped++;
+    return FALSE;
+  }
+
+  chan->samples[head & chan->mask] = *sample;
+  chan->pending++;
+  chan->num_pushed++;
+  return TRUE;
+}
+
+void
+nvds_detection_channel_commit (NvDsDetectionChannel * chan)
+{
+  if (chan->pending == 0)
+    return;
+
+  g_atomic_int_set (&chan->head, (gint) ((guint) chan->head + chan->pending));
+  chan->pending = 0;
+  sem_post (&chan->wakeup);
+}
+
+gboolean
+nvds_detection_channel_wait (NvDsDetectionChannel * chan, gint64 timeout_us)
+{
+  struct timespec ts;
+  gint ret;
+
+  clock_gettime (CLOCK_REALTIME, &ts);
+  ts.tv_sec += timeout_us / G_USEC_PER_SEC;
+  ts.tv_nsec += (timeout_us % G_USEC_PER_SEC) * 1000;
+  if (ts.tv_nsec >= 1000000000) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000;
+  }
+
+  do {
+    ret = sem_timedwait (&chan->wakeup, &ts);
+  } while (ret < 0 && errno == EINTR);
+  if (ret < 0)
+    return FALSE;
+
+  /* Everything committed so far is drained in one go. */
+  while (sem_trywait (&chan->wakeup) == 0);
+  chan->num_wakeups++;
+  return TRUE;
+}
+
+gboolean
+nvds_detection_channel_pop (NvDsDetectionChannel * chan,
+    NvDsDetectionSample * sample)
+{
+  guint tail = (guint) chan->tail;
+  guint head = (guint) g_atomic_int_get (&chan->head);
+
+  if (tail == head)
+    return FALSE;
+
+  *sample = chan->samples[tail & chan->mask];
+  g_atomic_int_set (&chan->tail, (gint) (tail + 1));
+  chan->num_popped++;
+  return TRUE;
+}
+
+void
+nvds_detection_channel_get_stats (NvDsDetectionChannel * chan,
+    NvDsDetectionStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsDetectionStats));
+  if (!chan)
+    return;
+
+  stats->num_pushed = chan->num_pushed;
+  stats->num_dropped = chan->num_dropped;
+  stats->num_popped = chan->num_popped;
+  stats->num_wakeups = chan->num_wakeups;
+}
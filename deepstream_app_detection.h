@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_DETECTION_H__
+#define __NVGSTDS_APP_DETECTION_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+#include <semaphore.h>
+
+typedef struct
+{
+  gint frame_num;
+  guint64 pts;
+  /** Estimated capture time, g_get_monotonic_time() clock. */
+  gint64 capture_time;
+  guint source_id;
+  guint64 object_id;
+  gint class_id;
+  gfloat left;
+  gfloat top;
+  gfloat width;
+  gfloat height;
+  gfloat confidence;
+} NvDsDetectionSample;
+
+typedef struct
+{
+  guint64 num_pushed;
+  /** Samples lost because the consumer fell a full ring behind. */
+  guint64 num_dropped;
+  guint64 num_popped;
+  guint64 num_wakeups;
+} NvDsDetectionStats;
+
+/**
+ * Single-producer / single-consumer ring of detection samples. The producer
+ * (the pipeline callback) and the consumer (the follow controller) never
+ * take a lock; the ring indices are the only shared state.
+ */
+typedef struct
+{
+  NvDsDetectionSample *samples;
+  guint mask;
+  /** Free-running counters; written by the producer / consumer only. */
+  gint head;
+  gint tail;
+  /** Samples pushed since the last commit (producer private). */
+  guint pending;
+  sem_t wakeup;
+
+  guint64 num_pushed;
+  guint64 num_dropped;
+  guint64 num_popped;
+  guint64 num_wakeups;
+} NvDsDetectionChannel;
+
+/**
+ * Allocate a channel able to hold @capacity samples, rounded up to a power
+ * of two.
+ */
+NvDsDetectionChannel *nvds_detection_channel_new (guint capacity);
+
+void nvds_detection_channel_free (NvDsDetectionChannel * chan);
+
+/**
+ * Producer side. Append one sample; it is not visible to the consumer until
+ * nvds_detection_channel_commit() is called.
+ *
+ * @return FALSE if the ring is full and the sample was dropped.
+ */
+gboolean nvds_detection_channel_push (NvDsDetectionChannel * chan,
+    const NvDsDetectionSample * sample);
+
+/**
+ * Producer side. Publish everything pushed since the last commit and wake
+ * the consumer once. Call once per frame.
+ */
+void nvds_detection_channel_commit (NvDsDetectionChannel * chan);
+
+/**
+ * Consumer side. Block until a commit has happened or @timeout_us expires.
+ * Wakeups that piled up while the consumer was busy are folded into one.
+ *
+ * @return TRUE if new samples may be available.
+ */
+gboolean nvds_detection_channel_wait (NvDsDetectionChannel * chan,
+    gint64 timeout_us);
+
+/**
+ * Consumer side. Take the oldest published sample.
+ *
+ * @return FALSE if the ring is empty.
+ */
+gboolean nvds_detection_channel_pop (NvDsDetectionChannel * chan,
+    NvDsDetectionSample * sample);
+
+/**
+ * Counters may be read from any thread; values are approximate while the
+ * channel is in use.
+ */
+void nvds_detection_channel_get_stats (NvDsDetectionChannel * chan,
+    NvDsDetectionStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
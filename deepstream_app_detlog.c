@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "deepstream_app_detlog.h"
+
+/* stdio buffer per stream; a 30 fps stream with a handful of objects
+ * fills it about once per second. */
+#define DETLOG_BUFFER_SIZE (64 * 1024)
+
+typedef struct
+{
+  FILE *file;
+  FILE *index;
+  gchar *buffer;
+  /** Size of the log, including what is still in the stdio buffer. */
+  guint64 offset;
+  guint64 frame_num;
+  guint64 pts;
+  guint64 frames_since_index;
+  gboolean failed;
+} DetectionLogStream;
+
+struct _NvDsDetectionLog
+{
+  gchar *dir;
+  /** Start time of the run, "YYYYmmdd-HHMMSS", shared by its files. */
+  gchar *run;
+  guint instance;
+  guint index_interval;
+  /** DetectionLogStream, indexed by source id. */
+  GPtrArray *streams;
+  NvDsDetectionLogStats stats;
+};
+
+struct _NvDsDetectionLogReader
+{
+  FILE *file;
+  gchar *path;
+  NvDsDetectionLogHeader header;
+  NvDsDetectionLogIndexEntry *index;
+  guint num_index;
+  /** Record read ahead by seek, returned by the next call to next. */
+  NvDsDetectionLogRecord pending;
+  gboolean has_pending;
+};
+
+static void
+detlog_stream_close (DetectionLogStream * stream)
+{
+  if (stream->file)
+    fclose (stream->file);
+  if (stream->index)
+    fclose (stream->index);
+  g_free (stream->buffer);
+  g_free (stream);
+}
+
+static gboolean
+detlog_read_header (FILE * file, NvDsDetectionLogHeader * header)
+{
+  return fread (header, sizeof (*header), 1, file) == 1 &&
+      !memcmp (header->magic, NVDS_DETECTION_LOG_MAGIC,
+      sizeof (header->magic)) &&
+      header->version == NVDS_DETECTION_LOG_VERSION &&
+      header->record_size == sizeof (NvDsDetectionLogRecord);
+}
+
+static DetectionLogStream *
+detlog_stream_open (NvDsDetectionLog * log, guint source_id)
+{
+  DetectionLogStream *stream = g_malloc0 (sizeof (DetectionLogStream));
+  NvDsDetectionLogHeader header;
+  gchar *name = NULL, *path = NULL, *index_path = NULL;
+  guint attempt;
+
+  /* Frame numbers restart with every run, so each run gets files of its
+   * own; a second run within the same second takes the next number. */
+  for (attempt = 0; !stream->file && attempt < 100; attempt++) {
+    g_free (name);
+    g_free (path);
+    name = g_strdup_printf ("%02u_%03u_%s-%02u.detlog", log->instance,
+        source_id, log->run, attempt);
+    path = g_build_filename (log->dir, name, NULL);
+    stream->file = fopen (path, "wbx");
+    if (!stream->file && errno != EEXIST)
+      break;
+  }
+  if (stream->file) {
+    index_path = g_strconcat (path, ".idx", NULL);
+    stream->index = fopen (index_path, "wb");
+  }
+  if (!stream->file || !stream->index) {
+    g_printerr ("detection log: cannot open %s: %s\n", path,
+        strerror (errno));
+    stream->failed = TRUE;
+    goto done;
+  }
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, NVDS_DETECTION_LOG_MAGIC, sizeof (header.magic));
+  header.version = NVDS_DETECTION_LOG_VERSION;
+  header.record_size = sizeof (NvDsDetectionLogRecord);
+  header.instance = log->instance;
+  header.source_id = source_id;
+  header.index_interval = log->index_interval;
+  if (fwrite (&header, sizeof (header), 1, stream->file) != 1) {
+    stream->failed = TRUE;
+    goto done;
+  }
+  stream->offset = sizeof (header);
+
+  stream->buffer = g_malloc (DETLOG_BUFFER_SIZE);
+  setvbuf (stream->file, stream->buffer, _IOFBF, DETLOG_BUFFER_SIZE);
+  log->stats.num_streams++;
+
+done:
+  g_free (index_path);
+  g_free (path);
+  g_free (name);
+  return stream;
+}
+
+static DetectionLogStream *
+detlog_get_stream (NvDsDetectionLog * log, guint source_id)
+{
+  DetectionLogStream *stream;
+
+  if (source_id >= log->streams->len)
+    g_ptr_array_set_size (log->streams, source_id + 1);
+
+  stream = g_ptr_array_index (log->streams, source_id);
+  if (!stream) {
+    stream = detlog_stream_open (log, source_id);
+    g_ptr_array_index (log->streams, source_id) = stream;
+  }
+  return stream->failed ? NULL : stream;
+}
+
+static gboolean
+detlog_write (NvDsDetectionLog * log, DetectionLogStream * stream,
+    const NvDsDetectionLogRecord * record)
+{
+  if (fwrite (record, sizeof (*record), 1, stream->file) != 1) {
+    log->stats.num_errors++;
+    return FALSE;
+  }
+  stream->offset += sizeof (*record);
+  log->stats.num_bytes += sizeof (*record);
+  return TRUE;
+}
+
+NvDsDetectionLog *
+nvds_detection_log_new (const gchar * dir, guint instance,
+    guint index_interval)
+{
+  NvDsDetectionLog *log;
+  GDateTime *now;
+
+  if (!dir)
+    return NULL;
+
+  log = g_malloc0 (sizeof (NvDsDetectionLog));
+  log->dir = g_strdup (dir);
+  now = g_date_time_new_now_local ();
+  log->run = g_date_time_format (now, "%Y%m%d-%H%M%S");
+  g_date_time_unref (now);
+  log->instance = instance;
+  log->index_interval =
+      index_interval ? index_interval : NVDS_DETECTION_LOG_INDEX_INTERVAL;
+  log->streams = g_ptr_array_new ();
+  return log;
+}
+
+void
+nvds_detection_log_free (NvDsDetectionLog * log)
+{
+  guint i;
+
+  if (!log)
+    return;
+
+  for (i = 0; i < log->streams->len; i++) {
+    DetectionLogStream *stream = g_ptr_array_index (log->streams, i);
+    if (stream)
+      detlog_stream_close (stream);
+  }
+  g_ptr_array_free (log->streams, TRUE);
+  g_free (log->dir);
+  g_free (log->run);
+  g_free (log);
+}
+
+gboolean
+nvds_detection_log_begin_frame (NvDsDetectionLog * log, guint source_id,
+    guint64 frame_num, guint64 pts, guint num_objects)
+{
+  NvDsDetectionLogRecord record;
+  DetectionLogStream *stream;
+
+  if (!log || !(stream = detlog_get_stream (log, source_id)))
+    return FALSE;
+
+  if (stream->frames_since_index == 0) {
+    NvDsDetectionLogIndexEntry entry = { frame_num, stream->offset };
+    if (fwrite (&entry, sizeof (entry), 1, stream->index) != 1)
+      log->stats.num_errors++;
+  }
+  if (++stream->frames_since_index == log->index_interval)
+    stream->frames_since_index = 0;
+
+  memset (&record, 0, sizeof (record));
+  record.type = NV_DS_DETECTION_LOG_FRAME;
+  record.class_id = -1;
+  record.frame_num = frame_num;
+  record.pts = pts;
+  record.object_id = num_objects;
+  stream->frame_num = frame_num;
+  stream->pts = pts;
+
+  log->stats.num_frames++;
+  return detlog_write (log, stream, &record);
+}
+
+gboolean
+nvds_detection_log_add_object (NvDsDetectionLog * log, guint source_id,
+    NvDsDetectionLogRecord * record)
+{
+  DetectionLogStream *stream;
+
+  if (!log || !(stream = detlog_get_stream (log, source_id)))
+    return FALSE;
+
+  record->type = NV_DS_DETECTION_LOG_OBJECT;
+  record->frame_num = stream->frame_num;
+  record->pts = stream->pts;
+  record->label[NVDS_DETECTION_LOG_LABEL_SIZE - 1] = '\0';
+
+  log->stats.num_objects++;
+  return detlog_write (log, stream, record);
+}
+
+void
+nvds_detection_log_flush (NvDsDetectionLog * log)
+{
+  guint i;
+
+  if (!log)
+    return;
+
+  for (i = 0; i < log->streams->len; i++) {
+    DetectionLogStream *stream = g_ptr_array_index (log->streams, i);
+    if (stream && !stream->failed) {
+      /* Data first, so the index never points past the end of the log. */
+      fflush (stream->file);
+      fflush (stream->index);
+    }
+  }
+}
+
+void
+nvds_detection_log_get_stats (NvDsDetectionLog * log,
+    NvDsDetectionLogStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsDetectionLogStats));
+  if (!log)
+    return;
+
+  *stats = log->stats;
+}
+
+static void
+detlog_reader_load_index (NvDsDetectionLogReader * reader, guint64 size)
+{
+  gchar *index_path = g_strconcat (reader->path, ".idx", NULL);
+  gchar *contents = NULL;
+  gsize length = 0;
+  guint i, n;
+
+  if (g_file_get_contents (index_path, &contents, &length, NULL)) {
+    NvDsDetectionLogIndexEntry *entries =
+        (NvDsDetectionLogIndexEntry *) contents;
+
+    /* Only keep entries that point at a complete record; the log and its
+     * index are flushed separately. */
+    n = length / sizeof (NvDsDetectionLogIndexEntry);
+    reader->index = g_new (NvDsDetectionLogIndexEntry, MAX (n, 1));
+    for (i = 0; i < n; i++) {
+      if (entries[i].offset < sizeof (NvDsDetectionLogHeader) ||
+          (entries[i].offset - sizeof (NvDsDetectionLogHeader)) %
+          sizeof (NvDsDetectionLogRecord) ||
+          entries[i].offset + sizeof (NvDsDetectionLogRecord) > size)
+        continue;
+      reader->index[reader->num_index++] = entries[i];
+    }
+  }
+  g_free (contents);
+  g_free (index_path);
+}
+
+NvDsDetectionLogReader *
+nvds_detection_log_reader_open (const gchar * path)
+{
+  NvDsDetectionLogReader *reader =
+      g_malloc0 (sizeof (NvDsDetectionLogReader));
+  guint64 size;
+
+  reader->path = g_strdup (path);
+  reader->file = fopen (path, "rb");
+  if (!reader->file) {
+    g_printerr ("detection log: cannot open %s: %s\n", path,
+        strerror (errno));
+    goto error;
+  }
+  if (!detlog_read_header (reader->file, &reader->header)) {
+    g_printerr ("detection log: %s is not a compatible log\n", path);
+    goto error;
+  }
+
+  fseeko (reader->file, 0, SEEK_END);
+  size = ftello (reader->file);
+  fseeko (reader->file, sizeof (NvDsDetectionLogHeader), SEEK_SET);
+  detlog_reader_load_index (reader, size);
+  return reader;
+
+error:
+  nvds_detection_log_reader_close (reader);
+  return NULL;
+}
+
+void
+nvds_detection_log_reader_close (NvDsDetectionLogReader * reader)
+{
+  if (!reader)
+    return;
+
+  if (reader->file)
+    fclose (reader->file);
+  g_free (reader->index);
+  g_free (reader->path);
+  g_free (reader);
+}
+
+const NvDsDetectionLogHeader *
+nvds_detection_log_reader_get_header (NvDsDetectionLogReader * reader)
+{
+  return &reader->header;
+}
+
+gboolean
+nvds_detection_log_reader_seek (NvDsDetectionLogReader * reader,
+    guint64 frame_num)
+{
+  NvDsDetectionLogRecord record;
+  guint64 offset = sizeof (NvDsDetectionLogHeader);
+  guint lo = 0, hi = reader->num_index;
+
+  /* Last index entry at or before frame_num. */
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+    if (reader->index[mid].frame_num <= frame_num)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo > 0)
+    offset = reader->index[lo - 1].offset;
+
+  reader->has_pending = FALSE;
+  if (fseeko (reader->file, offset, SEEK_SET) < 0)
+    return FALSE;
+
+  while (nvds_detection_log_reader_next (reader, &record)) {
+    if (record.type == NV_DS_DETECTION_LOG_FRAME
+        && record.frame_num >= frame_num) {
+      reader->pending = record;
+      reader->has_pending = TRUE;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+gboolean
+nvds_detection_log_reader_next (NvDsDetectionLogReader * reader,
+    NvDsDetectionLogRecord * record)
+{
+  if (reader->has_pending) {
+    *record = reader->pending;
+    reader->has_pending = FALSE;
+    return TRUE;
+  }
+  return fread (record, sizeof (*record), 1, reader->file) == 1;
+}
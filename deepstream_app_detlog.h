@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_DETLOG_H__
+#define __NVGSTDS_APP_DETLOG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#define NVDS_DETECTION_LOG_MAGIC "NVDSDLOG"
+#define NVDS_DETECTION_LOG_VERSION 1
+#define NVDS_DETECTION_LOG_LABEL_SIZE 24
+/** Frames between two entries of the sparse index. */
+#define NVDS_DETECTION_LOG_INDEX_INTERVAL 32
+
+typedef enum
+{
+  NV_DS_DETECTION_LOG_FRAME = 1,
+  NV_DS_DETECTION_LOG_OBJECT,
+} NvDsDetectionLogRecordType;
+
+/**
+ * Fixed-size record, in host byte order. Every frame, with or without
+ * objects, opens with a frame record followed by its object records.
+ */
+typedef struct
+{
+  guint32 type;
+  /** -1 on frame records. */
+  gint32 class_id;
+  guint64 frame_num;
+  guint64 pts;
+  /** Tracker id of an object; number of objects on a frame record. */
+  guint64 object_id;
+  gfloat left;
+  gfloat top;
+  gfloat width;
+  gfloat height;
+  gfloat confidence;
+  guint32 component_id;
+  /** NUL-terminated, longer labels are truncated. */
+  gchar label[NVDS_DETECTION_LOG_LABEL_SIZE];
+} NvDsDetectionLogRecord;
+
+G_STATIC_ASSERT (sizeof (NvDsDetectionLogRecord) == 80);
+
+/** Start of every log file; records follow immediately. */
+typedef struct
+{
+  gchar magic[8];
+  guint32 version;
+  guint32 record_size;
+  guint32 instance;
+  guint32 source_id;
+  guint32 index_interval;
+  guint32 reserved[9];
+} NvDsDetectionLogHeader;
+
+G_STATIC_ASSERT (sizeof (NvDsDetectionLogHeader) == 64);
+
+/** Entry of the "<log>.idx" file: where the frame record of frame_num
+ * starts in the log. */
+typedef struct
+{
+  guint64 frame_num;
+  guint64 offset;
+} NvDsDetectionLogIndexEntry;
+
+typedef struct
+{
+  guint64 num_frames;
+  guint64 num_objects;
+  guint64 num_bytes;
+  guint64 num_errors;
+  guint num_streams;
+} NvDsDetectionLogStats;
+
+typedef struct _NvDsDetectionLog NvDsDetectionLog;
+typedef struct _NvDsDetectionLogReader NvDsDetectionLogReader;
+
+/**
+ * Log detections of processing instance @instance into @dir. Each source
+ * gets its own "<instance>_<source>_<run>.detlog" file, opened on its
+ * first frame; <run> is the local start time of the log and a number, so
+ * every run starts new files and later runs sort after earlier ones.
+ * Not thread-safe: one writer per log.
+ */
+NvDsDetectionLog *nvds_detection_log_new (const gchar * dir, guint instance,
+    guint index_interval);
+
+/**
+ * Flush and close every stream file.
+ */
+void nvds_detection_log_free (NvDsDetectionLog * log);
+
+/**
+ * Open frame @frame_num of @source_id; @num_objects object records are
+ * expected to follow.
+ */
+gboolean nvds_detection_log_begin_frame (NvDsDetectionLog * log,
+    guint source_id, guint64 frame_num, guint64 pts, guint num_objects);
+
+/**
+ * Append @record to the frame last opened on @source_id. Type, frame
+ * number and PTS are filled in from that frame.
+ */
+gboolean nvds_detection_log_add_object (NvDsDetectionLog * log,
+    guint source_id, NvDsDetectionLogRecord * record);
+
+void nvds_detection_log_flush (NvDsDetectionLog * log);
+
+void nvds_detection_log_get_stats (NvDsDetectionLog * log,
+    NvDsDetectionLogStats * stats);
+
+/**
+ * Open a log for reading; its index is loaded if present. A partly
+ * written last record is ignored.
+ */
+NvDsDetectionLogReader *nvds_detection_log_reader_open (const gchar * path);
+
+void nvds_detection_log_reader_close (NvDsDetectionLogReader * reader);
+
+const NvDsDetectionLogHeader *
+nvds_detection_log_reader_get_header (NvDsDetectionLogReader * reader);
+
+/**
+ * Position the reader on the first frame record with a frame number of at
+ * least @frame_num, using the index to skip ahead. Frame numbers are
+ * expected to grow through the file.
+ *
+ * @return FALSE if no such frame exists.
+ */
+gboolean nvds_detection_log_reader_seek (NvDsDetectionLogReader * reader,
+    guint64 frame_num);
+
+/**
+ * @return FALSE at the end of the log.
+ */
+gboolean nvds_detection_log_reader_next (NvDsDetectionLogReader * reader,
+    NvDsDetectionLogRecord * record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "deepstream_app_fall.h"
+
+#define FALL_UNTRACKED_ID G_MAXUINT64
+/* A track not seen for this long is free for reuse. */
+#define FALL_TRACK_TIMEOUT_SEC 5.0
+
+typedef struct
+{
+  gdouble time;
+  gdouble aspect;
+  /** Bbox centre height, fraction of frame height (0 = top). */
+  gdouble centre_y;
+  /** Downward centre velocity, frame heights per second. */
+  gdouble velocity;
+} FallSample;
+
+typedef struct
+{
+  guint source_id;
+  guint64 object_id;
+  gboolean in_use;
+  FallSample history[NVDS_FALL_HISTORY];
+  guint head;
+  guint count;
+  /** Last time the person was seen upright, < 0 if never. */
+  gdouble upright_time;
+  gboolean fallen;
+} FallTrack;
+
+struct _NvDsFallDetector
+{
+  NvDsFallConfig config;
+  gdouble frame_height;
+  FallTrack tracks[NVDS_FALL_MAX_TRACKS];
+  NvDsFallStats stats;
+};
+
+NvDsFallDetector *
+nvds_fall_detector_new (NvDsFallConfig * config, guint frame_height)
+{
+  NvDsFallDetector *det;
+
+  if (!config->enable || frame_height == 0)
+    return NULL;
+
+  det = g_malloc0 (sizeof (NvDsFallDetector));
+  det->config = *config;
+  det->frame_height = frame_height;
+  return det;
+}
+
+void
+nvds_fall_detector_free (NvDsFallDetector * det)
+{
+  g_free (det);
+}
+
+static FallSample *
+fall_track_last (FallTrack * track)
+{
+  if (track->count == 0)
+    return NULL;
+  return &track->history[(track->head + NVDS_FALL_HISTORY - 1) %
+      NVDS_FALL_HISTORY];
+}
+
+/**
+ * Find the track of (@source_id, @object_id) or claim a slot for it: a
+ * free or timed-out slot first, otherwise the one seen longest ago.
+ */
+static FallTrack *
+fall_track_get (NvDsFallDetector * det, guint source_id, guint64 object_id,
+    gdouble now)
+{
+  FallTrack *free_slot = NULL;
+  FallTrack *stalest = NULL;
+  FallTrack *track;
+  guint i;
+
+  for (i = 0; i < NVDS_FALL_MAX_TRACKS; i++) {
+    track = &det->tracks[i];
+    if (!track->in_use) {
+      if (!free_slot)
+        free_slot = track;
+      continue;
+    }
+    if (track->object_id == object_id && track->source_id == source_id)
+      return track;
+    if (!free_slot && now - fall_track_last (track)->time >
+        FALL_TRACK_TIMEOUT_SEC)
+      free_slot = track;
+    if (!stalest ||
+        fall_track_last (track)->time < fall_track_last (stalest)->time)
+      stalest = track;
+  }
+
+  track = free_slot;
+  if (!track) {
+    track = stalest;
+    det->stats.num_evictions++;
+  }
+
+  track->source_id = source_id;
+  track->object_id = object_id;
+  track->in_use = TRUE;
+  track->head = 0;
+  track->count = 0;
+  track->upright_time = -1;
+  track->fallen = FALSE;
+  return track;
+}
+
+gboolean
+nvds_fall_detector_update (NvDsFallDetector * det,
+    const NvDsDetectionSample * sample, NvDsFallEvent * event)
+{
+  FallTrack *track;
+  FallSample *prev, *cur;
+  gdouble now, top, peak;
+  guint i;
+
+  if (!det || sample->object_id == FALL_UNTRACKED_ID || sample->height <= 0)
+    return FALSE;
+  if (det->config.class_id >= 0 && sample->class_id != det->config.class_id)
+    return FALSE;
+
+  now = (gdouble) sample->pts / 1e9;
+  det->stats.num_updates++;
+  track = fall_track_get (det, sample->source_id, sample->object_id, now);
+
+  prev = fall_track_last (track);
+  cur = &track->history[track->head];
+  cur->time = now;
+  cur->aspect = sample->width / sample->height;
+  cur->centre_y = (sample->top + sample->height / 2) / det->frame_height;
+  cur->velocity = 0;
+  if (prev && now > prev->time)
+    cur->velocity = (cur->centre_y - prev->centre_y) / (now - prev->time);
+  track->head = (track->head + 1) % NVDS_FALL_HISTORY;
+  track->count = MIN (track->count + 1, NVDS_FALL_HISTORY);
+
+  if (cur->aspect <= det->config.stand_ratio) {
+    track->upright_time = now;
+    track->fallen = FALSE;
+    return FALSE;
+  }
+
+  if (track->fallen || track->upright_time < 0 ||
+      cur->aspect < det->config.lie_ratio)
+    return FALSE;
+  if ((now - track->upright_time) * 1000 > det->config.max_fall_ms)
+    return FALSE;
+
+  /* The drop is measured from the highest centre within the fall window,
+   * which covers the whole collapse and not only its lying part. */
+  top = cur->centre_y;
+  peak = 0;
+  for (i = 0; i < track->count; i++) {
+    FallSample *s = &track->history[i];
+    if ((now - s->time) * 1000 > det->config.max_fall_ms)
+      continue;
+    top = MIN (top, s->centre_y);
+    peak = MAX (peak, s->velocity);
+  }
+  if (cur->centre_y - top < det->config.min_drop)
+    return FALSE;
+
+  track->fallen = TRUE;
+  det->stats.num_events++;
+
+  event->source_id = sample->source_id;
+  event->object_id = sample->object_id;
+  event->frame_num = sample->frame_num;
+  event->fall_ms = (now - track->upright_time) * 1000;
+  event->drop = cur->centre_y - top;
+  event->peak_velocity = peak;
+  return TRUE;
+}
+
+void
+nvds_fall_detector_get_stats (NvDsFallDetector * det, NvDsFallStats * stats)
+{
+  guint i;
+
+  memset (stats, 0, sizeof (NvDsFallStats));
+  if (!det)
+    return;
+
+  *stats = det->stats;
+  for (i = 0; i < NVDS_FALL_MAX_TRACKS; i++)
+    stats->active_tracks += det->tracks[i].in_use;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_FALL_H__
+#define __NVGSTDS_APP_FALL_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_detection.h"
+
+/** Tracks watched at once; every slot is allocated up front. */
+#define NVDS_FALL_MAX_TRACKS 64
+/** Per-track history, in frames. */
+#define NVDS_FALL_HISTORY 32
+
+typedef struct
+{
+  gboolean enable;
+  /** Only objects of this class are watched; -1 watches every class. */
+  gint class_id;
+  /** Width / height at or below which a person counts as upright. */
+  gdouble stand_ratio;
+  /** Width / height at or above which a person counts as lying. */
+  gdouble lie_ratio;
+  /** Upright-to-lying transitions slower than this are not falls. */
+  guint max_fall_ms;
+  /** Minimum drop of the bbox centre within max_fall_ms, as a fraction of
+   * frame height. */
+  gdouble min_drop;
+} NvDsFallConfig;
+
+typedef struct
+{
+  guint source_id;
+  guint64 object_id;
+  gint frame_num;
+  /** Time from the last upright frame to the first lying frame. */
+  guint fall_ms;
+  /** Centre drop over the fall window, fraction of frame height. */
+  gdouble drop;
+  /** Peak downward centre velocity, frame heights per second. */
+  gdouble peak_velocity;
+} NvDsFallEvent;
+
+typedef struct
+{
+  guint64 num_updates;
+  guint64 num_events;
+  /** Tracks that had to take over the slot of the stalest track. */
+  guint64 num_evictions;
+  /** Slots holding a track, including ones about to time out. */
+  guint active_tracks;
+} NvDsFallStats;
+
+typedef struct _NvDsFallDetector NvDsFallDetector;
+
+NvDsFallDetector *nvds_fall_detector_new (NvDsFallConfig * config,
+    guint frame_height);
+
+void nvds_fall_detector_free (NvDsFallDetector * det);
+
+/**
+ * Add one detection to the history of its track. Samples must arrive in
+ * PTS order per source; objects without a tracker id are ignored.
+ *
+ * @return TRUE and fill @event when this sample completes a fall. A track
+ *         fires at most once until it is seen upright again.
+ */
+gboolean nvds_fall_detector_update (NvDsFallDetector * det,
+    const NvDsDetectionSample * sample, NvDsFallEvent * event);
+
+void nvds_fall_detector_get_stats (NvDsFallDetector * det,
+    NvDsFallStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
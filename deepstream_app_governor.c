@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "deepstream_app_governor.h"
+#include "deepstream_app_log.h"
+
+#define GOVERNOR_NO_TEMP -1000.0
+/** Power must fall this far below the limit to release its step. */
+#define GOVERNOR_POWER_RELEASE 0.9
+
+struct _NvDsGovernor
+{
+  NvDsGovernorConfig config;
+  NvDsGovernorFunc func;
+  gpointer user_data;
+  /** temp files of the watched zones. */
+  GPtrArray *zone_paths;
+  gchar *power_path;
+
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gboolean stop;
+
+  NvDsGovernorLevel temp_level;
+  gboolean power_over;
+  gint64 level_start_us;
+  NvDsGovernorStats stats;
+};
+
+static const gchar *level_names[NV_DS_GOVERNOR_NUM_LEVELS] = {
+  "normal", "warm", "hot", "critical"
+};
+
+const gchar *
+nvds_governor_level_name (NvDsGovernorLevel level)
+{
+  return level < NV_DS_GOVERNOR_NUM_LEVELS ? level_names[level] : "unknown";
+}
+
+static gboolean
+governor_read_int (const gchar * path, gint64 * value)
+{
+  gchar *contents = NULL;
+  gchar *end;
+
+  if (!g_file_get_contents (path, &contents, NULL, NULL))
+    return FALSE;
+  *value = g_ascii_strtoll (contents, &end, 10);
+  if (end == contents) {
+    g_free (contents);
+    return FALSE;
+  }
+  g_free (contents);
+  return TRUE;
+}
+
+static void
+governor_find_zones (NvDsGovernor * governor)
+{
+  gchar *dir_path = g_build_filename (governor->config.sysfs_root,
+      "sys/class/thermal", NULL);
+  GDir *dir;
+  const gchar *entry;
+
+  if (governor->config.thermal_zone >= 0) {
+    gchar *zone = g_strdup_printf ("thermal_zone%d",
+        governor->config.thermal_zone);
+    g_ptr_array_add (governor->zone_paths,
+        g_build_filename (dir_path, zone, "temp", NULL));
+    g_free (zone);
+    g_free (dir_path);
+    return;
+  }
+
+  dir = g_dir_open (dir_path, 0, NULL);
+  while (dir && (entry = g_dir_read_name (dir))) {
+    if (g_str_has_prefix (entry, "thermal_zone"))
+      g_ptr_array_add (governor->zone_paths,
+          g_build_filename (dir_path, entry, "temp", NULL));
+  }
+  if (dir)
+    g_dir_close (dir);
+  g_free (dir_path);
+}
+
+static void
+governor_read (NvDsGovernor * governor, NvDsGovernorReading * reading)
+{
+  gint64 value;
+  guint i;
+
+  reading->time_us = g_get_monotonic_time ();
+  reading->temp = GOVERNOR_NO_TEMP;
+  reading->power_mw = -1;
+
+  /* Zones report millidegrees C. */
+  for (i = 0; i < governor->zone_paths->len; i++) {
+    if (governor_read_int (g_ptr_array_index (governor->zone_paths, i),
+            &value))
+      reading->temp = MAX (reading->temp, value / 1000.0);
+  }
+  if (governor->power_path && governor_read_int (governor->power_path,
+          &value))
+    reading->power_mw = (gint) value;
+
+  if (reading->temp == GOVERNOR_NO_TEMP ||
+      (governor->power_path && reading->power_mw < 0))
+    governor->stats.num_errors++;
+}
+
+/**
+ * Go up to the band of @temp at once; come down one band at a time, and
+ * only once @temp is hysteresis below the current band.
+ */
+static NvDsGovernorLevel
+governor_temp_level (NvDsGovernor * governor, gdouble temp)
+{
+  NvDsGovernorConfig *config = &governor->config;
+  NvDsGovernorLevel level = governor->temp_level;
+
+  if (temp == GOVERNOR_NO_TEMP)
+    return level;
+
+  while (level < NV_DS_GOVERNOR_CRITICAL && temp >= config->band_temp[level])
+    level++;
+  if (level == governor->temp_level && level > NV_DS_GOVERNOR_NORMAL &&
+      temp < config->band_temp[level - 1] - config->hysteresis)
+    level--;
+  return level;
+}
+
+static void
+governor_poll (NvDsGovernor * governor)
+{
+  NvDsGovernorConfig *config = &governor->config;
+  NvDsGovernorReading reading;
+  NvDsGovernorLevel old = governor->stats.level;
+  NvDsGovernorLevel level;
+  gchar *stamp;
+  GDateTime *now;
+
+  governor_read (governor, &reading);
+  governor->stats.num_polls++;
+  governor->stats.max_temp = MAX (governor->stats.max_temp, reading.temp);
+  governor->stats.max_power_mw = MAX (governor->stats.max_power_mw,
+      reading.power_mw);
+
+  governor->temp_level = governor_temp_level (governor, reading.temp);
+  if (config->power_limit_mw && reading.power_mw >= 0) {
+    if (reading.power_mw > (gint) config->power_limit_mw)
+      governor->power_over = TRUE;
+    else if (reading.power_mw <
+        config->power_limit_mw * GOVERNOR_POWER_RELEASE)
+      governor->power_over = FALSE;
+  }
+  level = MIN (governor->temp_level + (governor->power_over ? 1 : 0),
+      NV_DS_GOVERNOR_CRITICAL);
+
+  if (level == old)
+    return;
+
+  governor->stats.level_us[old] += reading.time_us - governor->level_start_us;
+  governor->level_start_us = reading.time_us;
+  governor->stats.level = level;
+  governor->stats.num_transitions++;
+
+  now = g_date_time_new_now_local ();
+  stamp = g_date_time_format (now, "%Y-%m-%d %H:%M:%S");
+  NVDS_LOG_WARN ("governor: %s.%03d %s -> %s (%.1f C, %d mW%s)", stamp,
+      g_date_time_get_microsecond (now) / 1000, level_names[old],
+      level_names[level], reading.temp, reading.power_mw,
+      governor->power_over ? ", over power limit" : "");
+  g_free (stamp);
+  g_date_time_unref (now);
+
+  if (governor->func)
+    governor->func (level, old, &reading, governor->user_data);
+}
+
+static gpointer
+governor_thread (gpointer data)
+{
+  NvDsGovernor *governor = (NvDsGovernor *) data;
+  gint64 deadline = g_get_monotonic_time ();
+
+  g_mutex_lock (&governor->lock);
+  while (!governor->stop) {
+    governor_poll (governor);
+    deadline += governor->config.poll_ms * 1000LL;
+    while (!governor->stop &&
+        g_cond_wait_until (&governor->cond, &governor->lock, deadline));
+  }
+  g_mutex_unlock (&governor->lock);
+  return NULL;
+}
+
+NvDsGovernor *
+nvds_governor_new (NvDsGovernorConfig * config, NvDsGovernorFunc func,
+    gpointer user_data)
+{
+  NvDsGovernor *governor;
+  NvDsGovernorReading reading;
+  guint i;
+
+  if (!config->enable)
+    return NULL;
+
+  governor = g_new0 (NvDsGovernor, 1);
+  governor->config = *config;
+  governor->config.sysfs_root = g_strdup (config->sysfs_root ?
+      config->sysfs_root : "/");
+  governor->config.power_file = NULL;
+  governor->config.poll_ms = MAX (config->poll_ms, 10);
+  for (i = 1; i < G_N_ELEMENTS (config->band_temp); i++)
+    governor->config.band_temp[i] = MAX (governor->config.band_temp[i],
+        governor->config.band_temp[i - 1]);
+  governor->func = func;
+  governor->user_data = user_data;
+  governor->zone_paths = g_ptr_array_new_with_free_func (g_free);
+  if (config->power_limit_mw)
+    governor->power_path = g_build_filename (governor->config.sysfs_root,
+        config->power_file ? config->power_file :
+        NVDS_GOVERNOR_DEFAULT_POWER_FILE, NULL);
+  governor_find_zones (governor);
+
+  governor_read (governor, &reading);
+  if (reading.temp == GOVERNOR_NO_TEMP && reading.power_mw < 0) {
+    g_printerr ("governor: no thermal zone or power file under %s\n",
+        governor->config.sysfs_root);
+    nvds_governor_free (governor);
+    return NULL;
+  }
+  governor->stats.num_errors = 0;
+  governor->stats.max_temp = GOVERNOR_NO_TEMP;
+  governor->stats.max_power_mw = -1;
+  governor->level_start_us = reading.time_us;
+
+  g_mutex_init (&governor->lock);
+  g_cond_init (&governor->cond);
+  governor->thread = g_thread_new ("nvds-governor", governor_thread,
+      governor);
+  return governor;
+}
+
+void
+nvds_governor_free (NvDsGovernor * governor)
+{
+  if (!governor)
+    return;
+
+  if (governor->thread) {
+    g_mutex_lock (&governor->lock);
+    governor->stop = TRUE;
+    g_cond_signal (&governor->cond);
+    g_mutex_unlock (&governor->lock);
+    g_thread_join (governor->thread);
+    g_mutex_clear (&governor->lock);
+    g_cond_clear (&governor->cond);
+  }
+
+  g_ptr_array_free (governor->zone_paths, TRUE);
+  g_free (governor->power_path);
+  g_free (governor->config.sysfs_root);
+  g_free (governor);
+}
+
+void
+nvds_governor_get_stats (NvDsGovernor * governor, NvDsGovernorStats * stats)
+{
+  g_mutex_lock (&governor->lock);
+  *stats = governor->stats;
+  stats->level_us[stats->level] +=
+      g_get_monotonic_time () - governor->level_start_us;
+  g_mutex_unlock (&governor->lock);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_GOVERNOR_H__
+#define __NVGSTDS_APP_GOVERNOR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+/** INA3221 total input power of the Jetson Nano, in mW. */
+#define NVDS_GOVERNOR_DEFAULT_POWER_FILE \
+  "sys/bus/i2c/drivers/ina3221x/6-0040/iio:device0/in_power0_input"
+
+typedef enum
+{
+  NV_DS_GOVERNOR_NORMAL = 0,
+  /** Raise the primary GIE interval. */
+  NV_DS_GOVERNOR_WARM,
+  /** ... and stop drawing on the OSD. */
+  NV_DS_GOVERNOR_HOT,
+  /** ... and raise the interval further. */
+  NV_DS_GOVERNOR_CRITICAL,
+  NV_DS_GOVERNOR_NUM_LEVELS
+} NvDsGovernorLevel;
+
+typedef struct
+{
+  gboolean enable;
+  /** Prefix of the sysfs paths; a test directory can stand in for "/". */
+  gchar *sysfs_root;
+  guint poll_ms;
+  /** sys/class/thermal/thermal_zone<N>; -1 takes the hottest zone. */
+  gint thermal_zone;
+  /** Temperatures, in C, at which WARM, HOT and CRITICAL start. */
+  gdouble band_temp[NV_DS_GOVERNOR_NUM_LEVELS - 1];
+  /** A level is left once the temperature is this far below its band. */
+  gdouble hysteresis;
+  /** Power file under sysfs_root, in mW. */
+  gchar *power_file;
+  /** Above this power the level goes one step up; 0 ignores power. */
+  guint power_limit_mw;
+  /** Primary GIE interval from WARM on. */
+  guint interval;
+  /** Primary GIE interval at CRITICAL. */
+  guint critical_interval;
+} NvDsGovernorConfig;
+
+typedef struct
+{
+  /** Monotonic time of the reading. */
+  gint64 time_us;
+  /** -1000 if no thermal zone could be read. */
+  gdouble temp;
+  /** -1 if the power file could not be read. */
+  gint power_mw;
+} NvDsGovernorReading;
+
+typedef struct
+{
+  guint64 num_polls;
+  guint64 num_errors;
+  guint64 num_transitions;
+  NvDsGovernorLevel level;
+  gdouble max_temp;
+  gint max_power_mw;
+  /** Time spent at each level. */
+  guint64 level_us[NV_DS_GOVERNOR_NUM_LEVELS];
+} NvDsGovernorStats;
+
+typedef struct _NvDsGovernor NvDsGovernor;
+
+/**
+ * Called on the governor thread after every transition.
+ */
+typedef void (*NvDsGovernorFunc) (NvDsGovernorLevel level,
+    NvDsGovernorLevel old_level, const NvDsGovernorReading * reading,
+    gpointer user_data);
+
+/**
+ * Start the governor thread.
+ *
+ * @return NULL if the config is disabled or no sensor can be read.
+ */
+NvDsGovernor *nvds_governor_new (NvDsGovernorConfig * config,
+    NvDsGovernorFunc func, gpointer user_data);
+
+/**
+ * Stop the thread. The level is left as it is; restore it yourself.
+ */
+void nvds_governor_free (NvDsGovernor * governor);
+
+const gchar *nvds_governor_level_name (NvDsGovernorLevel level);
+
+void nvds_governor_get_stats (NvDsGovernor * governor,
+    NvDsGovernorStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
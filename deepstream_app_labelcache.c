@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "deepstream_app_labelcache.h"
+
+/* Entries per set; the least recently used one of a full set is reused. */
+#define LABEL_CACHE_WAYS 4
+
+typedef struct
+{
+  guint64 object_id;
+  guint source_id;
+  gboolean valid;
+  guint64 signature;
+  guint64 last_use;
+  gsize len;
+  gchar text[NVDS_LABEL_CACHE_TEXT_SIZE];
+} LabelCacheEntry;
+
+struct _NvDsLabelCache
+{
+  /** num_sets * LABEL_CACHE_WAYS entries, allocated once. */
+  LabelCacheEntry *entries;
+  guint num_sets;
+  guint64 clock;
+  /** Composition buffer for untracked objects. */
+  gchar scratch[NVDS_LABEL_CACHE_TEXT_SIZE];
+  NvDsLabelCacheStats stats;
+};
+
+NvDsLabelCache *
+nvds_label_cache_new (guint num_entries)
+{
+  NvDsLabelCache *cache = g_malloc0 (sizeof (NvDsLabelCache));
+  guint num_sets = 1;
+
+  while (num_sets * LABEL_CACHE_WAYS < num_entries)
+    num_sets <<= 1;
+  cache->num_sets = num_sets;
+  cache->entries = g_new0 (LabelCacheEntry, num_sets * LABEL_CACHE_WAYS);
+  cache->stats.num_entries = num_sets * LABEL_CACHE_WAYS;
+  return cache;
+}
+
+void
+nvds_label_cache_free (NvDsLabelCache * cache)
+{
+  if (!cache)
+    return;
+
+  g_free (cache->entries);
+  g_free (cache);
+}
+
+static inline guint64
+label_cache_hash (guint64 hash, const gchar * s)
+{
+  /* FNV-1a; the terminator is hashed too so "ab" + "c" != "a" + "bc". */
+  do {
+    hash ^= (guchar) * s;
+    hash *= G_GUINT64_CONSTANT (0x100000001b3);
+  } while (*s++);
+  return hash;
+}
+
+static guint64
+label_cache_signature (NvDsObjectMeta * obj)
+{
+  guint64 hash = G_GUINT64_CONSTANT (0xcbf29ce484222325);
+
+  hash = label_cache_hash (hash, obj->obj_label);
+  for (NvDsMetaList * l_class = obj->classifier_meta_list; l_class != NULL;
+      l_class = l_class->next) {
+    NvDsClassifierMeta *cmeta = (NvDsClassifierMeta *) l_class->data;
+
+    hash ^= (guint) cmeta->unique_component_id;
+    hash *= G_GUINT64_CONSTANT (0x100000001b3);
+    for (NvDsMetaList * l_label = cmeta->label_info_list; l_label != NULL;
+        l_label = l_label->next) {
+      NvDsLabelInfo *label = (NvDsLabelInfo *) l_label->data;
+
+      /* An empty pResult_label still adds a space, an empty result_label
+       * does not. */
+      hash ^= label->pResult_label ? 1 : 2;
+      hash = label_cache_hash (hash,
+          label->pResult_label ? label->pResult_label : label->result_label);
+    }
+  }
+  return hash;
+}
+
+static gint
+component_id_compare_func (gconstpointer a, gconstpointer b)
+{
+  NvDsClassifierMeta *cmetaa = (NvDsClassifierMeta *) a;
+  NvDsClassifierMeta *cmetab = (NvDsClassifierMeta *) b;
+
+  if (cmetaa->unique_component_id < cmetab->unique_component_id)
+    return -1;
+  if (cmetaa->unique_component_id > cmetab->unique_component_id)
+    return 1;
+  return 0;
+}
+
+static gsize
+label_cache_append (gchar * text, gsize len, const gchar * format,
+    const gchar * s)
+{
+  if (len < NVDS_LABEL_CACHE_TEXT_SIZE - 1) {
+    gint n = g_snprintf (text + len, NVDS_LABEL_CACHE_TEXT_SIZE - len,
+        format, s);
+    len = MIN (len + n, NVDS_LABEL_CACHE_TEXT_SIZE - 1);
+  }
+  return len;
+}
+
+/**
+ * Join the labels (PGIE + SGIEs) of @obj into @text, truncated to the
+ * buffer size.
+ */
+static gsize
+label_cache_compose (NvDsObjectMeta * obj, gchar * text)
+{
+  gsize len = 0;
+
+  text[0] = '\0';
+  if (obj->obj_label[0] != '\0')
+    len = label_cache_append (text, len, "%s", obj->obj_label);
+
+  if (obj->object_id != UNTRACKED_OBJECT_ID) {
+    gchar id[24];
+    g_snprintf (id, sizeof (id), "%" G_GUINT64_FORMAT, obj->object_id);
+    len = label_cache_append (text, len, " %s", id);
+  }
+
+  obj->classifier_meta_list =
+      g_list_sort (obj->classifier_meta_list, component_id_compare_func);
+  for (NvDsMetaList * l_class = obj->classifier_meta_list; l_class != NULL;
+      l_class = l_class->next) {
+    NvDsClassifierMeta *cmeta = (NvDsClassifierMeta *) l_class->data;
+    for (NvDsMetaList * l_label = cmeta->label_info_list; l_label != NULL;
+        l_label = l_label->next) {
+      NvDsLabelInfo *label = (NvDsLabelInfo *) l_label->data;
+      if (label->pResult_label) {
+        len = label_cache_append (text, len, " %s", label->pResult_label);
+      } else if (label->result_label[0] != '\0') {
+        len = label_cache_append (text, len, " %s", label->result_label);
+      }
+    }
+  }
+  return len;
+}
+
+const gchar *
+nvds_label_cache_get (NvDsLabelCache * cache, guint source_id,
+    NvDsObjectMeta * obj, gsize * len)
+{
+  LabelCacheEntry *set, *entry = NULL, *victim;
+  guint64 signature, hash;
+  guint i;
+
+  if (obj->object_id == UNTRACKED_OBJECT_ID) {
+    cache->stats.num_uncached++;
+    *len = label_cache_compose (obj, cache->scratch);
+    return cache->scratch;
+  }
+
+  hash = (obj->object_id * G_GUINT64_CONSTANT (0x9e3779b97f4a7c15)) >> 32;
+  set = &cache->entries[((hash ^ source_id) & (cache->num_sets - 1)) *
+      LABEL_CACHE_WAYS];
+  victim = &set[0];
+  for (i = 0; i < LABEL_CACHE_WAYS; i++) {
+    if (set[i].valid && set[i].object_id == obj->object_id &&
+        set[i].source_id == source_id) {
+      entry = &set[i];
+      break;
+    }
+    if (!set[i].valid || (victim->valid &&
+            set[i].last_use < victim->last_use))
+      victim = &set[i];
+  }
+
+  signature = label_cache_signature (obj);
+  if (entry && entry->signature == signature) {
+    cache->stats.num_hits++;
+  } else {
+    if (!entry) {
+      entry = victim;
+      if (entry->valid)
+        cache->stats.num_evictions++;
+      entry->valid = TRUE;
+      entry->object_id = obj->object_id;
+      entry->source_id = source_id;
+    }
+    cache->stats.num_misses++;
+    entry->signature = signature;
+    entry->len = label_cache_compose (obj, entry->text);
+  }
+
+  entry->last_use = ++cache->clock;
+  *len = entry->len;
+  return entry->text;
+}
+
+void
+nvds_label_cache_get_stats (NvDsLabelCache * cache,
+    NvDsLabelCacheStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsLabelCacheStats));
+  if (!cache)
+    return;
+
+  *stats = cache->stats;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_LABELCACHE_H__
+#define __NVGSTDS_APP_LABELCACHE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "nvdsmeta.h"
+
+/** Size of the display_text buffer process_meta hands to the OSD. */
+#define NVDS_LABEL_CACHE_TEXT_SIZE 128
+
+typedef struct
+{
+  guint64 num_hits;
+  /** Tracks seen for the first time or whose labels changed. */
+  guint64 num_misses;
+  /** Untracked objects, composed every time. */
+  guint64 num_uncached;
+  guint64 num_evictions;
+  guint num_entries;
+} NvDsLabelCacheStats;
+
+typedef struct _NvDsLabelCache NvDsLabelCache;
+
+/**
+ * Cache the label text of up to @num_entries tracks (rounded up to whole
+ * sets). Not thread-safe: one cache per streaming thread.
+ */
+NvDsLabelCache *nvds_label_cache_new (guint num_entries);
+
+void nvds_label_cache_free (NvDsLabelCache * cache);
+
+/**
+ * Text to display for @obj of @source_id: its label, its tracker id and
+ * the classifier results in component id order. The text is composed
+ * again only when a signature of the label and classifier results
+ * differs from the cached one; the classifier list is sorted in place
+ * when that happens.
+ *
+ * @return the text, valid until the next call; its length in @len.
+ */
+const gchar *nvds_label_cache_get (NvDsLabelCache * cache, guint source_id,
+    NvDsObjectMeta * obj, gsize * len);
+
+void nvds_label_cache_get_stats (NvDsLabelCache * cache,
+    NvDsLabelCacheStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_app_latency.h"
+#include "deepstream_app_log.h"
+
+/** Frames per source whose stage times are kept; must cover the frames in
+ * flight between the streammux and the sink. Power of two. */
+#define LATENCY_FRAME_RING 64
+/** Sub-buckets per power of two; bounds the bucket error to 1/16. */
+#define LATENCY_SUB_BUCKET_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_NUM_BUCKETS NVDS_LATENCY_NUM_BUCKETS
+
+static const gchar *stage_names[NV_DS_STAGE_SGIE_FIRST] = {
+  "mux", "pgie", "tracker", "sgie", "tiler", "osd", "sink", "total"
+};
+
+typedef struct
+{
+  guint frame_num;
+  gint64 stamps[NV_DS_STAGE_NUM];
+} LatencyFrame;
+
+struct _NvDsStageLatency
+{
+  guint instance;
+  guint num_sources;
+  NvDsMetric *metric;
+  gboolean enabled[NV_DS_STAGE_NUM];
+  NvDsStage prev[NV_DS_STAGE_NUM];
+  gchar names[NV_DS_STAGE_NUM][16];
+  /** num_sources rings of LATENCY_FRAME_RING frames. */
+  LatencyFrame *frames;
+  /**
+   * Bucket counts of every (stage, source) cell. A cell has a single
+   * writer; the reporter reads the aligned 32-bit counts without locking
+   * and tolerates counts that lag by a sample.
+   */
+  guint32 *buckets;
+  /** The reporter's copy of buckets at the previous report. */
+  guint32 *snapshot;
+};
+
+static inline guint32 *
+cell_buckets (guint32 * buckets, NvDsStageLatency * latency, guint stage,
+    guint source_id)
+{
+  return buckets + ((gsize) stage * latency->num_sources +
+      source_id) * LATENCY_NUM_BUCKETS;
+}
+
+guint
+nvds_latency_bucket_index (guint64 value)
+{
+  guint exp;
+  guint index;
+
+  if (value < 2 * LATENCY_SUB_BUCKETS)
+    return (guint) value;
+
+  exp = (63 - __builtin_clzll (value)) - LATENCY_SUB_BUCKET_BITS;
+  index = LATENCY_SUB_BUCKETS * (exp + 1) +
+      (guint) (value >> exp) - LATENCY_SUB_BUCKETS;
+  return MIN (index, LATENCY_NUM_BUCKETS - 1);
+}
+
+guint64
+nvds_latency_bucket_value (guint index)
+{
+  guint exp;
+  guint64 mantissa;
+
+  if (index < 2 * LATENCY_SUB_BUCKETS)
+    return index;
+
+  exp = index / LATENCY_SUB_BUCKETS - 1;
+  mantissa = index % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS;
+  return ((mantissa + 1) << exp) - 1;
+}
+
+NvDsStageLatency *
+nvds_stage_latency_new (guint instance, guint num_sources)
+{
+  NvDsStageLatency *latency = g_new0 (NvDsStageLatency, 1);
+  gsize num_buckets;
+  guint i;
+
+  num_sources = MAX (num_sources, 1);
+  num_buckets = (gsize) NV_DS_STAGE_NUM * num_sources * LATENCY_NUM_BUCKETS;
+
+  latency->instance = instance;
+  latency->num_sources = num_sources;
+  latency->frames = g_new0 (LatencyFrame, num_sources * LATENCY_FRAME_RING);
+  latency->buckets = g_new0 (guint32, num_buckets);
+  latency->snapshot = g_new0 (guint32, num_buckets);
+
+  /* No frame has been stamped yet; G_MAXUINT never matches a frame_num. */
+  for (i = 0; i < num_sources * LATENCY_FRAME_RING; i++)
+    latency->frames[i].frame_num = G_MAXUINT;
+
+  return latency;
+}
+
+void
+nvds_stage_latency_free (NvDsStageLatency * latency)
+{
+  if (!latency)
+    return;
+
+  g_free (latency->frames);
+  g_free (latency->buckets);
+  g_free (latency->snapshot);
+  g_free (latency);
+}
+
+void
+nvds_stage_latency_stage_name (NvDsStage stage, gchar * buf, gsize size)
+{
+  if (stage < NV_DS_STAGE_SGIE_FIRST)
+    g_strlcpy (buf, stage_names[stage], size);
+  else
+    g_snprintf (buf, size, "sgie%u", stage - NV_DS_STAGE_SGIE_FIRST);
+}
+
+void
+nvds_stage_latency_add_stage (NvDsStageLatency * latency, NvDsStage stage,
+    NvDsStage prev)
+{
+  g_return_if_fail (stage < NV_DS_STAGE_NUM && prev < NV_DS_STAGE_NUM);
+
+  latency->enabled[stage] = TRUE;
+  latency->prev[stage] = prev;
+  nvds_stage_latency_stage_name (stage, latency->names[stage],
+      sizeof (latency->names[stage]));
+}
+
+void
+nvds_stage_latency_set_metric (NvDsStageLatency * latency,
+    NvDsMetric * metric)
+{
+  latency->metric = metric;
+}
+
+static inline void
+record (NvDsStageLatency * latency, NvDsStage stage, guint source_id,
+    gint64 value_us)
+{
+  guint32 *buckets;
+
+  if (value_us < 0)
+    value_us = 0;
+
+  buckets = cell_buckets (latency->buckets, latency, stage, source_id);
+  buckets[nvds_latency_bucket_index ((guint64) value_us)]++;
+
+  if (latency->metric)
+    nvds_metric_observe (latency->metric, stage, value_us / 1000.0);
+}
+
+void
+nvds_stage_latency_stamp (NvDsStageLatency * latency, NvDsStage stage,
+    guint source_id, guint frame_num, gint64 now_us, gint64 mux_wait_us)
+{
+  LatencyFrame *frame;
+  gint64 prev_us;
+
+  if (stage >= NV_DS_STAGE_NUM || !latency->enabled[stage] ||
+      source_id >= latency->num_sources)
+    return;
+
+  frame = &latency->frames[source_id * LATENCY_FRAME_RING +
+      (frame_num & (LATENCY_FRAME_RING - 1))];
+
+  if (stage == NV_DS_STAGE_MUX) {
+    /* Downstream stages of the frame that used this slot before are done
+     * by now; claim it for the new frame. */
+    memset (frame->stamps, 0, sizeof (frame->stamps));
+    frame->frame_num = frame_num;
+    frame->stamps[NV_DS_STAGE_MUX] = now_us;
+    if (mux_wait_us >= 0)
+      record (latency, stage, source_id, mux_wait_us);
+    return;
+  }
+
+  if (frame->frame_num != frame_num)
+    return;
+
+  frame->stamps[stage] = now_us;
+  prev_us = frame->stamps[latency->prev[stage]];
+  if (prev_us)
+    record (latency, stage, source_id, now_us - prev_us);
+
+  if (stage == NV_DS_STAGE_SINK && latency->enabled[NV_DS_STAGE_TOTAL])
+    record (latency, NV_DS_STAGE_TOTAL, source_id,
+        now_us - frame->stamps[NV_DS_STAGE_MUX]);
+}
+
+gdouble
+nvds_latency_percentile (const guint32 * counts, guint64 total,
+    gdouble quantile)
+{
+  guint64 rank = (guint64) (quantile * total + 0.5);
+  guint64 seen = 0;
+  guint i;
+
+  rank = CLAMP (rank, 1, total);
+  for (i = 0; i < LATENCY_NUM_BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank)
+      return nvds_latency_bucket_value (i) / 1000.0;
+  }
+  return nvds_latency_bucket_value (LATENCY_NUM_BUCKETS - 1) / 1000.0;
+}
+
+static void
+report_line (NvDsStageLatency * latency, guint stage, const gchar * source,
+    const guint32 * counts)
+{
+  guint64 total = 0;
+  guint max = 0;
+  guint i;
+
+  for (i = 0; i < LATENCY_NUM_BUCKETS; i++) {
+    if (counts[i]) {
+      total += counts[i];
+      max = i;
+    }
+  }
+  if (!total)
+    return;
+
+  NVDS_LOG_INFO ("**LATENCY %u %-10s %-4s: %6lu frames p50 %.2f p90 %.2f "
+      "p99 %.2f max %.2f ms", latency->instance, latency->names[stage],
+      source, (gulong) total, nvds_latency_percentile (counts, total, 0.50),
+      nvds_latency_percentile (counts, total, 0.90),
+      nvds_latency_percentile (counts, total, 0.99),
+      nvds_latency_bucket_value (max) / 1000.0);
+}
+
+void
+nvds_stage_latency_report (NvDsStageLatency * latency)
+{
+  guint32 all[LATENCY_NUM_BUCKETS];
+  guint32 counts[LATENCY_NUM_BUCKETS];
+  gchar source[16];
+  guint stage;
+  guint src;
+  guint i;
+
+  for (stage = 0; stage < NV_DS_STAGE_NUM; stage++) {
+    if (!latency->enabled[stage])
+      continue;
+
+    memset (all, 0, sizeof (all));
+    for (src = 0; src < latency->num_sources; src++) {
+      guint32 *live = cell_buckets (latency->buckets, latency, stage, src);
+      guint32 *last = cell_buckets (latency->snapshot, latency, stage, src);
+
+      for (i = 0; i < LATENCY_NUM_BUCKETS; i++) {
+        guint32 now = live[i];
+
+        counts[i] = now - last[i];
+        last[i] = now;
+        all[i] += counts[i];
+      }
+      if (latency->num_sources > 1) {
+        g_snprintf (source, sizeof (source), "%u", src);
+        report_line (latency, stage, source, counts);
+      }
+    }
+    report_line (latency, stage, "all", all);
+  }
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_LATENCY_H__
+#define __NVGSTDS_APP_LATENCY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_metrics.h"
+
+/** Secondary GIEs that get a stage of their own. */
+#define NVDS_STAGE_LATENCY_MAX_SGIES 16
+
+/**
+ * Buckets of a log-linear latency histogram in us: exact below 32 us,
+ * then 16 buckets per power of two up to 2^27 us (134 s).
+ */
+#define NVDS_LATENCY_NUM_BUCKETS 384
+
+typedef enum
+{
+  /** Streammux output; measured from the frame's arrival at the muxer. */
+  NV_DS_STAGE_MUX = 0,
+  NV_DS_STAGE_PGIE,
+  NV_DS_STAGE_TRACKER,
+  /** Output of the secondary GIE bin, once every SGIE is done. */
+  NV_DS_STAGE_SGIE,
+  NV_DS_STAGE_TILER,
+  NV_DS_STAGE_OSD,
+  NV_DS_STAGE_SINK,
+  /** Streammux output to sink, recorded with NV_DS_STAGE_SINK. */
+  NV_DS_STAGE_TOTAL,
+  /** One stage per secondary GIE, by config index. */
+  NV_DS_STAGE_SGIE_FIRST,
+  NV_DS_STAGE_NUM = NV_DS_STAGE_SGIE_FIRST + NVDS_STAGE_LATENCY_MAX_SGIES
+} NvDsStage;
+
+typedef struct _NvDsStageLatency NvDsStageLatency;
+
+/** Bucket of a @value_us sample; longer samples go to the last bucket. */
+guint nvds_latency_bucket_index (guint64 value_us);
+
+/** Largest value, in us, that falls into bucket @index. */
+guint64 nvds_latency_bucket_value (guint index);
+
+/**
+ * Value, in ms, below which @quantile of the @total samples counted in
+ * @counts fall. @total must not be 0.
+ */
+gdouble nvds_latency_percentile (const guint32 * counts, guint64 total,
+    gdouble quantile);
+
+NvDsStageLatency *nvds_stage_latency_new (guint instance, guint num_sources);
+
+void nvds_stage_latency_free (NvDsStageLatency * latency);
+
+/**
+ * Measure @stage from the time frames leave @prev. Stages are added while
+ * the pipeline is built, before any buffer flows.
+ */
+void nvds_stage_latency_add_stage (NvDsStageLatency * latency,
+    NvDsStage stage, NvDsStage prev);
+
+/**
+ * Write the name of @stage ("pgie", "sgie2", ...) into @buf.
+ */
+void nvds_stage_latency_stage_name (NvDsStage stage, gchar * buf,
+    gsize size);
+
+/**
+ * Also record every sample, in ms, into cell @stage of histogram @metric.
+ */
+void nvds_stage_latency_set_metric (NvDsStageLatency * latency,
+    NvDsMetric * metric);
+
+/**
+ * Record that frame @frame_num of @source_id left @stage at @now_us
+ * (monotonic). At NV_DS_STAGE_MUX @mux_wait_us is the time the frame
+ * waited for its batch, or negative if unknown; other stages ignore it.
+ * Each (stage, source) pair must be stamped from one thread only.
+ */
+void nvds_stage_latency_stamp (NvDsStageLatency * latency, NvDsStage stage,
+    guint source_id, guint frame_num, gint64 now_us, gint64 mux_wait_us);
+
+/**
+ * Log p50 / p90 / p99 / max of every stage, over all sources and per
+ * source, for the samples recorded since the previous report.
+ */
+void nvds_stage_latency_report (NvDsStageLatency * latency);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,789 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deepstream_app_log.h"
+
+#define DEFAULT_LOG_RING_SIZE (64 * 1024)
+#define LOG_DRAIN_INTERVAL_US (10 * G_TIME_SPAN_MILLISECOND)
+#define LOG_LINE_SIZE 1024
+
+/** num_args of a format the records cannot carry; the call site formats
+ * it into a single string instead. */
+#define LOG_FORMAT_RAW (NVDS_LOG_MAX_ARGS + 1)
+/** suppressed value marking the unused tail of a ring before it wraps. */
+#define LOG_PADDING G_MAXUINT32
+
+typedef enum
+{
+  LOG_ARG_INT = 0,
+  LOG_ARG_LONG,
+  LOG_ARG_LLONG,
+  LOG_ARG_SIZE,
+  LOG_ARG_DOUBLE,
+  LOG_ARG_STRING,
+  LOG_ARG_POINTER,
+} LogArgType;
+
+typedef enum
+{
+  LOG_RING_LIVE = 0,
+  /** The owning thread exited; the drainer frees the ring once empty. */
+  LOG_RING_RETIRED,
+  /** The drainer stopped; the owning thread frees the ring. */
+  LOG_RING_CLOSED,
+} LogRingState;
+
+/**
+ * Followed by one 8-byte slot per argument and the bytes of the string
+ * arguments, in argument order. Records are 8-byte aligned.
+ */
+typedef struct
+{
+  guint32 size;
+  guint32 suppressed;
+  NvDsLogSite *site;
+  gint64 time_us;
+} LogRecord;
+
+typedef union
+{
+  gint64 i;
+  gdouble d;
+  gpointer p;
+} LogSlot;
+
+/** Single producer (the owning thread), single consumer (the drainer). */
+typedef struct
+{
+  guint8 *data;
+  guint size;
+  gint generation;
+  gint state;
+  /** Free-running byte counters, only ever advanced. */
+  gint head;
+  gint tail;
+  gint dropped;
+  guint max_fill;
+  guint reported_dropped;
+} LogRing;
+
+NvDsLogLevel nvds_log_level = NV_DS_LOG_INFO;
+
+static void log_ring_release (gpointer data);
+
+static GPrivate log_ring_key = G_PRIVATE_INIT (log_ring_release);
+static GMutex log_lock;
+static GCond log_cond;
+static GThread *log_thread;
+static gboolean log_stop;
+static GPtrArray *log_rings;
+static guint log_ring_size;
+/** Non-zero while the drainer runs; rings of older runs are replaced. */
+static gint log_generation;
+static gint log_last_generation;
+static NvDsLogStats log_stats;
+
+static const gchar *log_level_names[] = {
+  "error", "warn", "info", "debug", "trace"
+};
+
+gboolean
+nvds_log_parse_level (const gchar * str, NvDsLogLevel * level)
+{
+  gchar *end;
+  guint64 num;
+  guint i;
+
+  if (!str)
+    return FALSE;
+
+  for (i = 0; i < G_N_ELEMENTS (log_level_names); i++) {
+    if (!g_ascii_strcasecmp (str, log_level_names[i])) {
+      *level = i;
+      return TRUE;
+    }
+  }
+  num = g_ascii_strtoull (str, &end, 10);
+  if (end == str || *end || num > NV_DS_LOG_TRACE)
+    return FALSE;
+  *level = num;
+  return TRUE;
+}
+
+/**
+ * Work out the argument types of a printf format once per site. Anything
+ * the binary records cannot reproduce ('*' widths, long double, %n, ...)
+ * makes the site fall back to formatting at the call.
+ */
+static void
+log_parse_format (NvDsLogSite * site)
+{
+  const gchar *p = site->format;
+  guint8 types[NVDS_LOG_MAX_ARGS];
+  gint n = 0;
+
+  while ((p = strchr (p, '%'))) {
+    gint longs = 0;
+    gboolean size = FALSE, other = FALSE;
+    LogArgType type;
+
+    p++;
+    if (*p == '%') {
+      p++;
+      continue;
+    }
+    while (*p && strchr ("-+ #0'", *p))
+      p++;
+    while (g_ascii_isdigit (*p))
+      p++;
+    if (*p == '.') {
+      p++;
+      while (g_ascii_isdigit (*p))
+        p++;
+    }
+    for (;; p++) {
+      if (*p == 'l')
+        longs++;
+      else if (*p == 'h')
+        ;
+      else if (*p == 'z')
+        size = TRUE;
+      else if (*p && strchr ("jtLq*", *p))
+        other = TRUE;
+      else
+        break;
+    }
+    if (other || n == NVDS_LOG_MAX_ARGS)
+      goto raw;
+
+    switch (*p) {
+      case 'd':
+      case 'i':
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'c':
+        type = size ? LOG_ARG_SIZE : longs == 0 ? LOG_ARG_INT :
+            longs == 1 ? LOG_ARG_LONG : LOG_ARG_LLONG;
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        type = LOG_ARG_DOUBLE;
+        break;
+      case 's':
+        if (longs)
+          goto raw;
+        type = LOG_ARG_STRING;
+        break;
+      case 'p':
+        type = LOG_ARG_POINTER;
+        break;
+      default:
+        goto raw;
+    }
+    types[n++] = type;
+    p++;
+  }
+
+  memcpy (site->arg_types, types, n);
+  g_atomic_int_set (&site->num_args, n);
+  return;
+
+raw:
+  g_atomic_int_set (&site->num_args, LOG_FORMAT_RAW);
+}
+
+static gint
+log_fetch_and_clear (gint * value)
+{
+  gint old;
+
+  do {
+    old = g_atomic_int_get (value);
+  } while (old && !g_atomic_int_compare_and_exchange (value, old, 0));
+  return old;
+}
+
+/**
+ * Per-site limit over one-second windows. Threads sharing a site race on
+ * the window start, which at worst lets a few extra records through.
+ */
+static gboolean
+log_rate_limited (NvDsLogSite * site, gint64 now)
+{
+  if (now - site->window_start >= G_USEC_PER_SEC) {
+    site->window_start = now;
+    g_atomic_int_set (&site->window_count, 0);
+  }
+  if ((guint) g_atomic_int_add (&site->window_count, 1) < site->rate_limit)
+    return FALSE;
+  g_atomic_int_inc (&site->suppressed);
+  return TRUE;
+}
+
+static FILE *
+log_stream (NvDsLogLevel level)
+{
+  return level <= NV_DS_LOG_WARN ? stderr : stdout;
+}
+
+static gsize
+log_suppressed_note (gchar * buf, gsize size, guint32 suppressed)
+{
+  if (!suppressed)
+    return 0;
+  return g_snprintf (buf, size, " (%u similar suppressed)", suppressed);
+}
+
+static void
+log_write_direct (NvDsLogSite * site, guint32 suppressed, va_list args)
+{
+  gchar line[LOG_LINE_SIZE];
+  gsize len;
+
+  len = g_vsnprintf (line, sizeof (line) - 1, site->format, args);
+  len = MIN (len, sizeof (line) - 2);
+  len += log_suppressed_note (line + len, sizeof (line) - 1 - len,
+      suppressed);
+  len = MIN (len, sizeof (line) - 2);
+  line[len++] = '\n';
+  fwrite (line, 1, len, log_stream (site->level));
+}
+
+static LogRing *
+log_ring_new (gint generation)
+{
+  LogRing *ring = g_malloc0 (sizeof (LogRing));
+
+  ring->size = log_ring_size;
+  ring->data = g_malloc (ring->size);
+  ring->generation = generation;
+  return ring;
+}
+
+static void
+log_ring_free (LogRing * ring)
+{
+  g_free (ring->data);
+  g_free (ring);
+}
+
+static void
+log_ring_release (gpointer data)
+{
+  LogRing *ring = (LogRing *) data;
+
+  if (!g_atomic_int_compare_and_exchange (&ring->state, LOG_RING_LIVE,
+          LOG_RING_RETIRED))
+    log_ring_free (ring);
+}
+
+static LogRing *
+log_get_ring (gint generation)
+{
+  LogRing *ring = g_private_get (&log_ring_key);
+
+  if (ring && ring->generation == generation)
+    return ring;
+
+  g_mutex_lock (&log_lock);
+  if (g_atomic_int_get (&log_generation) != generation) {
+    g_mutex_unlock (&log_lock);
+    return NULL;
+  }
+  ring = log_ring_new (generation);
+  g_ptr_array_add (log_rings, ring);
+  g_mutex_unlock (&log_lock);
+
+  /* Releases the ring of an earlier run, if any. */
+  g_private_replace (&log_ring_key, ring);
+  return ring;
+}
+
+static gsize
+log_record_size (NvDsLogSite * site, va_list args)
+{
+  gsize size = sizeof (LogRecord) + site->num_args * sizeof (LogSlot);
+  gint i;
+
+  for (i = 0; i < site->num_args; i++) {
+    switch (site->arg_types[i]) {
+      case LOG_ARG_INT:
+        va_arg (args, gint);
+        break;
+      case LOG_ARG_LONG:
+        va_arg (args, glong);
+        break;
+      case LOG_ARG_LLONG:
+        va_arg (args, gint64);
+        break;
+      case LOG_ARG_SIZE:
+        va_arg (args, gsize);
+        break;
+      case LOG_ARG_DOUBLE:
+        va_arg (args, gdouble);
+        break;
+      case LOG_ARG_POINTER:
+        va_arg (args, gpointer);
+        break;
+      case LOG_ARG_STRING:{
+        const gchar *str = va_arg (args, const gchar *);
+        size += (str ? strnlen (str, NVDS_LOG_MAX_STRING - 1) : 6) + 1;
+        break;
+      }
+    }
+  }
+  return (size + 7) & ~(gsize) 7;
+}
+
+static void
+log_record_fill (NvDsLogSite * site, guint8 * data, va_list args)
+{
+  LogSlot *slots = (LogSlot *) (data + sizeof (LogRecord));
+  gchar *strings = (gchar *) (slots + site->num_args);
+  gint i;
+
+  for (i = 0; i < site->num_args; i++) {
+    switch (site->arg_types[i]) {
+      case LOG_ARG_INT:
+        slots[i].i = va_arg (args, gint);
+        break;
+      case LOG_ARG_LONG:
+        slots[i].i = va_arg (args, glong);
+        break;
+      case LOG_ARG_LLONG:
+        slots[i].i = va_arg (args, gint64);
+        break;
+      case LOG_ARG_SIZE:
+        slots[i].i = va_arg (args, gsize);
+        break;
+      case LOG_ARG_DOUBLE:
+        slots[i].d = va_arg (args, gdouble);
+        break;
+      case LOG_ARG_POINTER:
+        slots[i].p = va_arg (args, gpointer);
+        break;
+      case LOG_ARG_STRING:{
+        const gchar *str = va_arg (args, const gchar *);
+        gsize len;
+
+        if (!str)
+          str = "(null)";
+        len = strnlen (str, NVDS_LOG_MAX_STRING - 1);
+        memcpy (strings, str, len);
+        strings[len] = '\0';
+        slots[i].i = len;
+        strings += len + 1;
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * Reserve @size contiguous bytes. A record never wraps: the tail of the
+ * ring is skipped with a padding record instead.
+ */
+static guint8 *
+log_ring_reserve (LogRing * ring, gsize size, guint * head)
+{
+  guint tail = g_atomic_int_get (&ring->tail);
+  guint pos = *head % ring->size;
+  guint contiguous = ring->size - pos;
+  guint needed = size <= contiguous ? size : contiguous + size;
+
+  if (size > ring->size || ring->size - (*head - tail) < needed)
+    return NULL;
+
+  if (size > contiguous) {
+    LogRecord *pad = (LogRecord *) (ring->data + pos);
+    pad->size = contiguous;
+    pad->suppressed = LOG_PADDING;
+    *head += contiguous;
+    pos = 0;
+  }
+  return ring->data + pos;
+}
+
+void
+nvds_log_write (NvDsLogSite * site, ...)
+{
+  gint generation = g_atomic_int_get (&log_generation);
+  gint64 now = g_get_monotonic_time ();
+  gchar raw[NVDS_LOG_MAX_STRING];
+  guint32 suppressed;
+  LogRing *ring = NULL;
+  LogRecord *rec;
+  va_list args, copy;
+  guint head, fill;
+  gsize size;
+
+  if (site->rate_limit && log_rate_limited (site, now))
+    return;
+  suppressed = g_atomic_int_get (&site->suppressed) ?
+      log_fetch_and_clear (&site->suppressed) : 0;
+  if (g_atomic_int_get (&site->num_args) < 0)
+    log_parse_format (site);
+
+  va_start (args, site);
+  if (generation)
+    ring = log_get_ring (generation);
+  if (!ring) {
+    log_write_direct (site, suppressed, args);
+    va_end (args);
+    return;
+  }
+
+  if (site->num_args == LOG_FORMAT_RAW) {
+    g_vsnprintf (raw, sizeof (raw), site->format, args);
+    size = (sizeof (LogRecord) + sizeof (LogSlot) +
+        strlen (raw) + 1 + 7) & ~(gsize) 7;
+  } else {
+    va_copy (copy, args);
+    size = log_record_size (site, copy);
+    va_end (copy);
+  }
+
+  head = ring->head;
+  rec = (LogRecord *) log_ring_reserve (ring, size, &head);
+  if (!rec) {
+    g_atomic_int_inc (&ring->dropped);
+    /* Hand the held back count to the next record that fits. */
+    if (suppressed)
+      g_atomic_int_add (&site->suppressed, suppressed);
+    va_end (args);
+    return;
+  }
+
+  rec->size = size;
+  rec->suppressed = suppressed;
+  rec->site = site;
+  rec->time_us = now;
+  if (site->num_args == LOG_FORMAT_RAW) {
+    LogSlot *slot = (LogSlot *) (rec + 1);
+    slot->i = strlen (raw);
+    memcpy (slot + 1, raw, slot->i + 1);
+  } else {
+    log_record_fill (site, (guint8 *) rec, args);
+  }
+  va_end (args);
+
+  fill = head + size - g_atomic_int_get (&ring->tail);
+  if (fill > ring->max_fill)
+    ring->max_fill = fill;
+  g_atomic_int_set (&ring->head, head + size);
+
+  /* The drainer polls; only wake it early when a ring is filling up. */
+  if (fill >= ring->size / 2 && fill - size < ring->size / 2)
+    g_cond_signal (&log_cond);
+}
+
+/**
+ * Format one record. The format is walked again and every conversion is
+ * printed on its own with the value from the matching slot.
+ */
+static gsize
+log_format_record (const LogRecord * rec, gchar * line, gsize size)
+{
+  const NvDsLogSite *site = rec->site;
+  const LogSlot *slots = (const LogSlot *) (rec + 1);
+  const gchar *strings;
+  const gchar *p = site->format;
+  gsize len = 0;
+  gint n = 0;
+
+  size--;
+  if (site->num_args == LOG_FORMAT_RAW) {
+    len = MIN ((gsize) slots[0].i, size);
+    memcpy (line, slots + 1, len);
+    return len;
+  }
+
+  strings = (const gchar *) (slots + site->num_args);
+  while (*p && len < size) {
+    const gchar *start = p;
+    gchar spec[32];
+    gsize spec_len;
+    gint ret = 0;
+
+    if (*p != '%') {
+      while (*p && *p != '%')
+        p++;
+      spec_len = MIN ((gsize) (p - start), size - len);
+      memcpy (line + len, start, spec_len);
+      len += spec_len;
+      continue;
+    }
+    if (p[1] == '%') {
+      line[len++] = '%';
+      p += 2;
+      continue;
+    }
+
+    p++;
+    while (*p && !strchr ("diouxXceEfFgGaAsp", *p))
+      p++;
+    if (*p)
+      p++;
+    spec_len = MIN ((gsize) (p - start), sizeof (spec) - 1);
+    memcpy (spec, start, spec_len);
+    spec[spec_len] = '\0';
+
+    switch (site->arg_types[n]) {
+      case LOG_ARG_INT:
+        ret = g_snprintf (line + len, size - len + 1, spec,
+            (gint) slots[n].i);
+        break;
+      case LOG_ARG_LONG:
+        ret = g_snprintf (line + len, size - len + 1, spec,
+            (glong) slots[n].i);
+        break;
+      case LOG_ARG_LLONG:
+        ret = g_snprintf (line + len, size - len + 1, spec,
+            (long long) slots[n].i);
+        break;
+      case LOG_ARG_SIZE:
+        ret = g_snprintf (line + len, size - len + 1, spec,
+            (gsize) slots[n].i);
+        break;
+      case LOG_ARG_DOUBLE:
+        ret = g_snprintf (line + len, size - len + 1, spec, slots[n].d);
+        break;
+      case LOG_ARG_POINTER:
+        ret = g_snprintf (line + len, size - len + 1, spec, slots[n].p);
+        break;
+      case LOG_ARG_STRING:
+        ret = g_snprintf (line + len, size - len + 1, spec, strings);
+        strings += slots[n].i + 1;
+        break;
+    }
+    len = MIN (len + ret, size);
+    n++;
+  }
+  return len;
+}
+
+/** Next record of @ring, skipping padding; NULL if the ring is empty. */
+static LogRecord *
+log_ring_peek (LogRing * ring)
+{
+  guint head = g_atomic_int_get (&ring->head);
+
+  while (ring->tail != (gint) head) {
+    LogRecord *rec = (LogRecord *) (ring->data + (guint) ring->tail %
+        ring->size);
+    if (rec->suppressed != LOG_PADDING)
+      return rec;
+    g_atomic_int_set (&ring->tail, ring->tail + rec->size);
+  }
+  return NULL;
+}
+
+/**
+ * Print every record buffered so far, merged across threads in time
+ * order. Runs on the drainer only.
+ */
+static void
+log_drain (LogRing ** rings, guint num_rings)
+{
+  gchar line[LOG_LINE_SIZE];
+  guint64 num_records = 0, num_bytes = 0, num_suppressed = 0;
+  guint i;
+
+  while (TRUE) {
+    LogRecord *first = NULL;
+    LogRing *first_ring = NULL;
+    gsize len;
+
+    for (i = 0; i < num_rings; i++) {
+      LogRecord *rec = log_ring_peek (rings[i]);
+      if (rec && (!first || rec->time_us < first->time_us)) {
+        first = rec;
+        first_ring = rings[i];
+      }
+    }
+    if (!first)
+      break;
+
+    len = log_format_record (first, line, sizeof (line) - 1);
+    len += log_suppressed_note (line + len, sizeof (line) - 1 - len,
+        first->suppressed);
+    len = MIN (len, sizeof (line) - 2);
+    line[len++] = '\n';
+    fwrite (line, 1, len, log_stream (first->site->level));
+
+    num_records++;
+    num_bytes += len;
+    num_suppressed += first->suppressed;
+    g_atomic_int_set (&first_ring->tail, first_ring->tail + first->size);
+  }
+
+  for (i = 0; i < num_rings; i++) {
+    guint dropped = g_atomic_int_get (&rings[i]->dropped);
+    if (dropped != rings[i]->reported_dropped) {
+      fprintf (stderr, "log: %u records dropped, ring of %u bytes full\n",
+          dropped - rings[i]->reported_dropped, rings[i]->size);
+      rings[i]->reported_dropped = dropped;
+    }
+  }
+
+  if (num_records) {
+    fflush (stdout);
+    fflush (stderr);
+  }
+
+  g_mutex_lock (&log_lock);
+  log_stats.num_records += num_records;
+  log_stats.num_bytes += num_bytes;
+  log_stats.num_suppressed += num_suppressed;
+  g_mutex_unlock (&log_lock);
+}
+
+/** Fold the counters of a ring that goes away into the totals. */
+static void
+log_ring_retire_stats (LogRing * ring)
+{
+  log_stats.num_dropped += g_atomic_int_get (&ring->dropped);
+  log_stats.max_ring_fill = MAX (log_stats.max_ring_fill, ring->max_fill);
+}
+
+static gpointer
+log_thread_func (gpointer data)
+{
+  GPtrArray *snapshot = g_ptr_array_new ();
+  gboolean stop = FALSE;
+  guint i;
+
+  while (!stop) {
+    g_mutex_lock (&log_lock);
+    stop = log_stop;
+    if (!stop) {
+      g_cond_wait_until (&log_cond, &log_lock,
+          g_get_monotonic_time () + LOG_DRAIN_INTERVAL_US);
+      stop = log_stop;
+    }
+    g_ptr_array_set_size (snapshot, 0);
+    for (i = 0; i < log_rings->len; i++)
+      g_ptr_array_add (snapshot, g_ptr_array_index (log_rings, i));
+    g_mutex_unlock (&log_lock);
+
+    log_drain ((LogRing **) snapshot->pdata, snapshot->len);
+
+    /* Rings of exited threads go once they are empty. */
+    g_mutex_lock (&log_lock);
+    for (i = 0; i < log_rings->len;) {
+      LogRing *ring = g_ptr_array_index (log_rings, i);
+      if (g_atomic_int_get (&ring->state) == LOG_RING_RETIRED &&
+          ring->tail == g_atomic_int_get (&ring->head)) {
+        log_ring_retire_stats (ring);
+        g_ptr_array_remove_index_fast (log_rings, i);
+        log_ring_free (ring);
+        continue;
+      }
+      i++;
+    }
+    g_mutex_unlock (&log_lock);
+  }
+
+  g_ptr_array_free (snapshot, TRUE);
+  return NULL;
+}
+
+void
+nvds_log_init (NvDsLogLevel level, guint ring_size)
+{
+  g_mutex_lock (&log_lock);
+  if (log_thread) {
+    g_mutex_unlock (&log_lock);
+    return;
+  }
+  nvds_log_level = level;
+  log_ring_size = ring_size ? ring_size : DEFAULT_LOG_RING_SIZE;
+  log_ring_size = (log_ring_size + 7) & ~7u;
+  log_rings = g_ptr_array_new ();
+  log_stop = FALSE;
+  log_thread = g_thread_new ("nvds-log", log_thread_func, NULL);
+  g_atomic_int_set (&log_generation, ++log_last_generation);
+  g_mutex_unlock (&log_lock);
+}
+
+void
+nvds_log_shutdown (void)
+{
+  guint i;
+
+  g_mutex_lock (&log_lock);
+  if (!log_thread) {
+    g_mutex_unlock (&log_lock);
+    return;
+  }
+  g_atomic_int_set (&log_generation, 0);
+  log_stop = TRUE;
+  g_cond_signal (&log_cond);
+  g_mutex_unlock (&log_lock);
+
+  /* The drainer empties every ring before it exits. */
+  g_thread_join (log_thread);
+
+  g_mutex_lock (&log_lock);
+  log_thread = NULL;
+  for (i = 0; i < log_rings->len; i++) {
+    LogRing *ring = g_ptr_array_index (log_rings, i);
+    log_ring_retire_stats (ring);
+    /* Live threads still hold their ring and free it on exit. */
+    if (!g_atomic_int_compare_and_exchange (&ring->state, LOG_RING_LIVE,
+            LOG_RING_CLOSED))
+      log_ring_free (ring);
+  }
+  g_ptr_array_free (log_rings, TRUE);
+  log_rings = NULL;
+  g_mutex_unlock (&log_lock);
+}
+
+void
+nvds_log_get_stats (NvDsLogStats * stats)
+{
+  guint i;
+
+  g_mutex_lock (&log_lock);
+  *stats = log_stats;
+  if (log_rings) {
+    stats->num_rings = log_rings->len;
+    for (i = 0; i < log_rings->len; i++) {
+      LogRing *ring = g_ptr_array_index (log_rings, i);
+      stats->num_dropped += g_atomic_int_get (&ring->dropped);
+      stats->max_ring_fill = MAX (stats->max_ring_fill, ring->max_fill);
+    }
+  }
+  g_mutex_unlock (&log_lock);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_LOG_H__
+#define __NVGSTDS_APP_LOG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+#include <glib/gprintf.h>
+
+typedef enum
+{
+  NV_DS_LOG_ERROR = 0,
+  NV_DS_LOG_WARN,
+  NV_DS_LOG_INFO,
+  NV_DS_LOG_DEBUG,
+  NV_DS_LOG_TRACE,
+} NvDsLogLevel;
+
+/** Sites above this level are removed by the compiler. */
+#ifndef NVDS_LOG_COMPILE_LEVEL
+#define NVDS_LOG_COMPILE_LEVEL NV_DS_LOG_DEBUG
+#endif
+
+/** Arguments a binary record can carry; longer formats are pre-formatted. */
+#define NVDS_LOG_MAX_ARGS 16
+/** Longest %s argument copied into a record, including the NUL. */
+#define NVDS_LOG_MAX_STRING 512
+
+/** One log statement; the macros keep a static instance per call site. */
+typedef struct
+{
+  NvDsLogLevel level;
+  const gchar *format;
+  /** Records per second let through; 0 for no limit. */
+  guint rate_limit;
+
+  /* Filled in at run time. */
+  gint num_args;
+  guint8 arg_types[NVDS_LOG_MAX_ARGS];
+  gint64 window_start;
+  gint window_count;
+  gint suppressed;
+} NvDsLogSite;
+
+typedef struct
+{
+  guint64 num_records;
+  /** Records lost because the ring of their thread was full. */
+  guint64 num_dropped;
+  /** Records held back by per-site rate limits. */
+  guint64 num_suppressed;
+  guint64 num_bytes;
+  guint num_rings;
+  /** Highest fill level any ring reached, in bytes. */
+  guint max_ring_fill;
+} NvDsLogStats;
+
+/** Records above this level are discarded at the call site. */
+extern NvDsLogLevel nvds_log_level;
+
+/**
+ * Start the drainer thread. Every thread that logs afterwards gets its own
+ * ring of @ring_size bytes (0 for the default); the call sites only copy
+ * their arguments into it, formatting and console I/O happen on the
+ * drainer. Before this call and after nvds_log_shutdown() records are
+ * printed directly.
+ */
+void nvds_log_init (NvDsLogLevel level, guint ring_size);
+
+/**
+ * Print everything still buffered and stop the drainer.
+ */
+void nvds_log_shutdown (void);
+
+/**
+ * Map "error", "warn", "info", "debug", "trace" or a number to a level.
+ *
+ * @return FALSE if @str is not a level.
+ */
+gboolean nvds_log_parse_level (const gchar * str, NvDsLogLevel * level);
+
+void nvds_log_write (NvDsLogSite * site, ...);
+
+void nvds_log_get_stats (NvDsLogStats * stats);
+
+/**
+ * Log one line (no trailing newline) at @level, at most @per_sec times a
+ * second from this call site. Held back records are counted and reported
+ * with the next one that gets through.
+ */
+#define NVDS_LOG_RATE(level, per_sec, fmt, ...) \
+  G_STMT_START { \
+    if ((level) <= NVDS_LOG_COMPILE_LEVEL && (level) <= nvds_log_level) { \
+      static NvDsLogSite _nvds_log_site = { (level), fmt, (per_sec), -1 }; \
+      /* Never runs; lets the compiler check the format. */ \
+      if (0) \
+        g_printf (fmt, ##__VA_ARGS__); \
+      nvds_log_write (&_nvds_log_site, ##__VA_ARGS__); \
+    } \
+  } G_STMT_END
+
+#define NVDS_LOG(level, fmt, ...) NVDS_LOG_RATE (level, 0, fmt, ##__VA_ARGS__)
+
+#define NVDS_LOG_ERROR(fmt, ...) NVDS_LOG (NV_DS_LOG_ERROR, fmt, ##__VA_ARGS__)
+#define NVDS_LOG_WARN(fmt, ...) NVDS_LOG (NV_DS_LOG_WARN, fmt, ##__VA_ARGS__)
+#define NVDS_LOG_INFO(fmt, ...) NVDS_LOG (NV_DS_LOG_INFO, fmt, ##__VA_ARGS__)
+#define NVDS_LOG_DEBUG(fmt, ...) NVDS_LOG (NV_DS_LOG_DEBUG, fmt, ##__VA_ARGS__)
+#define NVDS_LOG_TRACE(fmt, ...) NVDS_LOG (NV_DS_LOG_TRACE, fmt, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,6 +23,7 @@
 #include "deepstream_app.h"
 #include "deepstream_config_file_parser.h"
 #include "nvds_version.h"
+#include <math.h>
 #include <string.h>
 #include <unistd.h>
 #include <termios.h>
@@ -37,6 +38,7 @@
 #include <sys/types.h> 
 #include <sys/stat.h> 
 #include <fcntl.h>
+#include <time.h>
 ////////////////////////////
 
 #define MAX_INSTANCES 128
@@ -45,6 +47,21 @@
 #define DEFAULT_X_WINDOW_WIDTH 1920
 #define DEFAULT_X_WINDOW_HEIGHT 1080
 
+/* Cells of the nvds_queue_depth and nvds_dropped_total metrics; every
+ * instance has its own meta writer cell from METRICS_QUEUE_META_WRITER. */
+typedef enum
+{
+  METRICS_QUEUE_DETECTIONS = 0,
+  METRICS_QUEUE_ACTUATOR,
+  METRICS_QUEUE_LOG,
+  METRICS_QUEUE_META_WRITER,
+} MetricsQueue;
+
+/* Trajectory history: about two seconds per object at 30 fps. */
+#define TRAJECTORY_MAX_TRACKS 128
+#define TRAJECTORY_HISTORY 64
+#define TRAJECTORY_EXPIRE_FRAMES 30
+
 // jayden.choe
 void python_test( void );
 void init_python3 (char *argv[] );
@@ -52,6 +69,8 @@ void end_python3 ( void );
 void call_python3_command( char *p_command_string );
 void call_python3_file ( char *p_filename );
 void *thread_a ( void* pArg );
+static void actuator_post_drive (gdouble turn_left, gdouble turn_right);
+static void pantilt_track (const NvDsDetectionSample * sample);
 ///////////////////////////////////////////
 
 AppCtx *appCtx[MAX_INSTANCES];
@@ -59,6 +78,10 @@ static guint cintr = FALSE;
 static GMainLoop *main_loop = NULL;
 static gchar **cfg_files = NULL;
 static gchar **input_files = NULL;
+static gchar **replay_paths = NULL;
+static gdouble replay_speed = 1.0;
+static gchar *log_level_name = NULL;
+static NvDsBenchConfig bench_config = { NULL, 4, 20, 2, 10000, 500 };
 static gboolean print_version = FALSE;
 static gboolean show_bbox_text = FALSE;
 static gboolean print_dependencies_version = FALSE;
@@ -66,10 +89,7 @@ static gboolean quit = FALSE;
 static gint return_value = 0;
 static guint num_instances;
 static guint num_input_files;
-static GMutex fps_lock;
-static gdouble fps[MAX_SOURCE_BINS];
-static gdouble fps_avg[MAX_SOURCE_BINS];
-static guint num_fps_inst = 0;
+static NvDsPerfReport *s_perf_report = NULL;
 
 static Display *display = NULL;
 static Window windows[MAX_INSTANCES] = { 0 };
@@ -81,10 +101,30 @@ static GMutex disp_lock;
 
 // jayden.choe
 static int s_b_terminate_thread = FALSE;
-static sem_t sem_one;
-static sem_t sem_two;
-static int s_human_x = 0;
-static int s_human_y = 0;
+/* Detections of instance 0 flow to thread_a; the callback is the only
+ * producer and thread_a the only consumer. */
+static NvDsDetectionChannel *s_detections = NULL;
+static NvDsTargetSelector s_target;
+static NvDsPredictor *s_predictor = NULL;
+static NvDsFallDetector *s_fall[MAX_INSTANCES];
+static NvDsZoneEngine *s_zones[MAX_INSTANCES];
+static NvDsTrajectoryStore *s_trajectories[MAX_INSTANCES];
+static NvDsAdaptiveInterval *s_adaptive[MAX_INSTANCES];
+static NvDsGovernor *s_governor = NULL;
+static NvDsMotor *s_motor = NULL;
+static NvDsServo *s_servo = NULL;
+static NvDsActuatorScheduler *s_actuator = NULL;
+static NvDsPanTilt *s_pantilt = NULL;
+static NvDsConfigWatch *s_config_watch[MAX_INSTANCES];
+static GThread *s_replay_threads[MAX_INSTANCES];
+static gint s_replays_running = 0;
+static NvDsMetrics *s_metrics = NULL;
+static NvDsMetric *s_metric_fps = NULL;
+static NvDsMetric *s_metric_fps_avg = NULL;
+static NvDsMetric *s_metric_frames = NULL;
+static NvDsMetric *s_metric_objects = NULL;
+static NvDsMetric *s_metric_queue_depth = NULL;
+static NvDsMetric *s_metric_dropped = NULL;
 
 GST_DEBUG_CATEGORY (NVDS_APP);
 
@@ -104,10 +144,110 @@ GOptionEntry entries[] = {
   {"input-file", 'i', 0, G_OPTION_ARG_FILENAME_ARRAY, &input_files,
       "Set the input file", NULL}
   ,
+  {"replay", 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &replay_paths,
+      "Replay a detection log or KITTI directory instead of running the "
+      "pipeline, one per config file", NULL}
+  ,
+  {"replay-speed", 0, 0, G_OPTION_ARG_DOUBLE, &replay_speed,
+      "Replay rate: 1 is real time, 0 as fast as possible", NULL}
+  ,
+  {"log-level", 0, 0, G_OPTION_ARG_STRING, &log_level_name,
+      "Console log level: error, warn, info (default), debug or trace",
+      "LEVEL"}
+  ,
+  {NULL}
+  ,
+};
+
+static GOptionEntry bench_entries[] = {
+  {"bench", 0, 0, G_OPTION_ARG_FILENAME, &bench_config.output_path,
+      "Time the metadata callbacks on synthetic batches instead of running "
+      "the pipeline, write JSON results to FILE (- for stdout)", "FILE"}
+  ,
+  {"bench-sources", 0, 0, G_OPTION_ARG_INT, &bench_config.num_sources,
+      "Frames per batch (default 4)", "N"}
+  ,
+  {"bench-objects", 0, 0, G_OPTION_ARG_INT, &bench_config.num_objects,
+      "Objects per frame (default 20)", "N"}
+  ,
+  {"bench-labels", 0, 0, G_OPTION_ARG_INT, &bench_config.num_labels,
+      "Classifier labels per object (default 2)", "N"}
+  ,
+  {"bench-batches", 0, 0, G_OPTION_ARG_INT, &bench_config.num_batches,
+      "Measured batches (default 10000)", "N"}
+  ,
+  {"bench-warmup", 0, 0, G_OPTION_ARG_INT, &bench_config.num_warmup,
+      "Batches run before measuring (default 500)", "N"}
+  ,
   {NULL}
   ,
 };
 
+/**
+ * Metrics cell of a stream: the column it has in the **PERF lines.
+ */
+static guint
+metrics_stream (AppCtx * appCtx, guint source_id)
+{
+  return num_instances > 1 ? appCtx->index : source_id;
+}
+
+static void
+fill_detection_sample (NvDsDetectionSample * sample,
+    NvDsFrameMeta * frame_meta, NvDsObjectMeta * obj)
+{
+  sample->frame_num = frame_meta->frame_num;
+  sample->pts = frame_meta->buf_pts;
+  sample->capture_time = 0;
+  sample->source_id = frame_meta->source_id;
+  sample->object_id = obj->object_id;
+  sample->class_id = obj->class_id;
+  sample->left = obj->rect_params.left;
+  sample->top = obj->rect_params.top;
+  sample->width = obj->rect_params.width;
+  sample->height = obj->rect_params.height;
+  sample->confidence = obj->confidence;
+}
+
+/**
+ * Save a clip around an event seen on @source_id. With the tiler there is
+ * a single processing instance, and its recorder sees every source.
+ */
+static void
+record_event (AppCtx * appCtx, guint source_id, const gchar * reason)
+{
+  guint i = appCtx->config.tiled_display_config.enable ? 0 : source_id;
+
+  if (i < MAX_SOURCE_BINS)
+    nvds_recorder_trigger (appCtx->pipeline.instance_bins[i].recorder,
+        reason);
+}
+
+static void
+report_zone_events (AppCtx * appCtx, NvDsZoneEngine * zones,
+    NvDsDetectionSample * sample, gint local_hour)
+{
+  NvDsZoneEvent events[4];
+  guint num_events, i;
+
+  num_events = nvds_zone_engine_update (zones, sample, local_hour, events,
+      G_N_ELEMENTS (events));
+  for (i = 0; i < num_events; i++) {
+    if (events[i].type == NV_DS_ZONE_EVENT_LEAVE) {
+      NVGSTDS_WARN_MSG_V ("Zone event: object %" G_GUINT64_FORMAT " left '%s' "
+          "after %.0f s (source %u frame %d)", events[i].object_id,
+          events[i].zone_name, events[i].dwell_sec, events[i].source_id,
+          events[i].frame_num);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Zone event: object %" G_GUINT64_FORMAT " lingering "
+          "at '%s' for %.0f s (source %u frame %d)", events[i].object_id,
+          events[i].zone_name, events[i].dwell_sec, events[i].source_id,
+          events[i].frame_num);
+      record_event (appCtx, events[i].source_id, "linger");
+    }
+  }
+}
+
 /**
  * Callback function to be called once all inferences (Primary + Secondary)
  * are done. This is opportunity to modify content of the metadata.
@@ -125,11 +265,36 @@ all_bbox_generated (AppCtx * appCtx, GstBuffer * buf,
   // jayden.choe
   guint center_x = 0;
   guint center_y = 0;
+  NvDsDetectionChannel *detections = appCtx->index == 0 ? s_detections : NULL;
+  NvDsZoneEngine *zones = s_zones[appCtx->index];
+  GstClockTime running_time = GST_CLOCK_TIME_NONE;
+  gint64 now = 0;
+  gint64 frame_time = s_perf_report ? g_get_monotonic_time () : 0;
+  gint local_hour = 0;
 
  // g_print( "all_bbox_generated started\n" );
 
   memset (num_objects, 0, sizeof (num_objects));
 
+  /* Live sources stamp buffers with the pipeline running time at capture,
+   * so the PTS tells how long ago each frame was taken. */
+  if (detections) {
+    GstClock *clock = appCtx->pipeline.pipeline ?
+        gst_element_get_clock (appCtx->pipeline.pipeline) : NULL;
+    now = g_get_monotonic_time ();
+    if (clock) {
+      running_time = gst_clock_get_time (clock) -
+          gst_element_get_base_time (appCtx->pipeline.pipeline);
+      gst_object_unref (clock);
+    }
+  }
+  if (zones) {
+    time_t t = time (NULL);
+    struct tm tm;
+    localtime_r (&t, &tm);
+    local_hour = tm.tm_hour;
+  }
+
   for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
       l_frame = l_frame->next) {
     NvDsFrameMeta *frame_meta = l_frame->data;
@@ -144,9 +309,26 @@ all_bbox_generated (AppCtx * appCtx, GstBuffer * buf,
           // jayden.choe
         center_x = (obj->rect_params.left + obj->rect_params.width) / 2;
         center_y = (obj->rect_params.top + obj->rect_params.height) / 2; 
-        g_printf( "c-id: %d, center x: %d, center y: %d\n", obj->class_id, center_x, center_y );
-        s_human_x = center_x;
-        s_human_y = center_y;
+        NVDS_LOG_RATE (NV_DS_LOG_DEBUG, 100,
+            "c-id: %d, center x: %u, center y: %u", obj->class_id, center_x,
+            center_y);
+        if (detections) {
+          NvDsDetectionSample sample;
+          fill_detection_sample (&sample, frame_meta, obj);
+          sample.capture_time = now;
+          if (GST_CLOCK_TIME_IS_VALID (running_time)
+              && frame_meta->buf_pts <= running_time
+              && running_time - frame_meta->buf_pts < 5 * GST_SECOND) {
+            sample.capture_time -=
+                (running_time - frame_meta->buf_pts) / GST_USECOND;
+          }
+          nvds_detection_channel_push (detections, &sample);
+        }
+        if (zones) {
+          NvDsDetectionSample sample;
+          fill_detection_sample (&sample, frame_meta, obj);
+          report_zone_events (appCtx, zones, &sample, local_hour);
+        }
         
         // jayden.choe below condition never fit        
         if (appCtx->person_class_id > -1
@@ -163,9 +345,109 @@ all_bbox_generated (AppCtx * appCtx, GstBuffer * buf,
         }
       }
     }
+    /* One wakeup per frame, after all of its objects are in the ring. */
+    if (detections)
+      nvds_detection_channel_commit (detections);
+    nvds_metric_add (s_metric_frames, metrics_stream (appCtx,
+            frame_meta->source_id), 1);
+    nvds_perf_report_frame (s_perf_report, appCtx->index,
+        frame_meta->source_id, frame_time);
+  }
+
+  if (s_metric_objects) {
+    guint c;
+    for (c = 0; c < G_N_ELEMENTS (num_objects); c++) {
+      if (num_objects[c])
+        nvds_metric_add (s_metric_objects, c, num_objects[c]);
+    }
   }
 }
 
+/**
+ * Speed of the centre of a track between its last two points, in frame
+ * heights per second.
+ */
+static gdouble
+track_speed (const NvDsTrajectory * traj, guint frame_height)
+{
+  const NvDsTrajectoryPoint *p0, *p1;
+  gdouble dx, dy;
+
+  if (!traj || !frame_height)
+    return 0;
+  p0 = nvds_trajectory_point (traj, 0);
+  p1 = nvds_trajectory_point (traj, 1);
+  if (!p1 || p0->pts <= p1->pts)
+    return 0;
+
+  dx = (p0->left + p0->width / 2) - (p1->left + p1->width / 2);
+  dy = (p0->top + p0->height / 2) - (p1->top + p1->height / 2);
+  return sqrt (dx * dx + dy * dy) / frame_height /
+      ((p0->pts - p1->pts) / (gdouble) GST_SECOND);
+}
+
+/**
+ * Callback function to be called after the tracker, once object ids are
+ * stable. Records every tracked primary object in the trajectory store and
+ * feeds it to the fall detector.
+ */
+static void
+bbox_generated_post_analytics (AppCtx * appCtx, GstBuffer * buf,
+    NvDsBatchMeta * batch_meta, guint index)
+{
+  NvDsFallDetector *fall = s_fall[appCtx->index];
+  NvDsTrajectoryStore *trajectories = s_trajectories[appCtx->index];
+  NvDsAdaptiveInterval *adaptive = s_adaptive[appCtx->index];
+  NvDsAdaptiveConfig *adaptive_config = &appCtx->config.adaptive_config;
+  guint frame_height = appCtx->config.streammux_config.pipeline_height;
+  gboolean inferred = FALSE;
+  guint num_objects = 0;
+  gdouble max_speed = 0;
+  guint interval;
+
+  if (!fall && !trajectories && !adaptive)
+    return;
+
+  for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
+      l_frame = l_frame->next) {
+    NvDsFrameMeta *frame_meta = l_frame->data;
+    inferred |= frame_meta->bInferDone;
+    for (NvDsMetaList * l_obj = frame_meta->obj_meta_list; l_obj != NULL;
+        l_obj = l_obj->next) {
+      NvDsObjectMeta *obj = (NvDsObjectMeta *) l_obj->data;
+      const NvDsTrajectory *traj;
+      NvDsDetectionSample sample;
+      NvDsFallEvent event;
+
+      if (obj->unique_component_id !=
+          (gint) appCtx->config.primary_gie_config.unique_id)
+        continue;
+
+      fill_detection_sample (&sample, frame_meta, obj);
+      traj = nvds_trajectory_store_add (trajectories, &sample);
+      if (adaptive && (adaptive_config->class_id < 0 ||
+              obj->class_id == adaptive_config->class_id)) {
+        num_objects += frame_meta->bInferDone;
+        max_speed = MAX (max_speed, track_speed (traj, frame_height));
+      }
+      if (nvds_fall_detector_update (fall, &sample, &event)) {
+        NVGSTDS_WARN_MSG_V ("Fall detected: source %u object %" G_GUINT64_FORMAT
+            " frame %d, %u ms, drop %.2f, peak %.2f frame heights/s",
+            event.source_id, event.object_id, event.frame_num, event.fall_ms,
+            event.drop, event.peak_velocity);
+        record_event (appCtx, event.source_id, "fall");
+      }
+    }
+  }
+  /* A batch holds one frame of each source, so tracks age once per batch
+   * whatever the number of sources. */
+  nvds_trajectory_store_end_frame (trajectories);
+
+  if (nvds_adaptive_interval_update (adaptive, g_get_monotonic_time (),
+          inferred, num_objects, max_speed, &interval))
+    set_pgie_interval (appCtx, NV_DS_PGIE_INTERVAL_ADAPTIVE, interval);
+}
+
 /**
  * Function to handle program interrupt signal.
  * It installs default handler after handling the interrupt.
@@ -191,47 +473,36 @@ _intr_handler (int signum)
 static void
 perf_cb (gpointer context, NvDsAppPerfStruct * str)
 {
-  static guint header_print_cnt = 0;
   guint i;
   AppCtx *appCtx = (AppCtx *) context;
   guint numf = (num_instances == 1) ? str->num_instances : num_instances;
 
 //  g_print( "perf_cb started\n" );
 
-  g_mutex_lock (&fps_lock);
-  if (num_instances > 1) {
-    fps[appCtx->index] = str->fps[0];
-    fps_avg[appCtx->index] = str->fps_avg[0];
-  } else {
-    for (i = 0; i < numf; i++) {
-      fps[i] = str->fps[i];
-      fps_avg[i] = str->fps_avg[i];
-    }
+  if (appCtx->meta_writer) {
+    NvDsMetaWriterStats stats;
+    nvds_meta_writer_get_stats (appCtx->meta_writer, &stats);
+    NVDS_LOG_INFO ("**WRITER %u: queue %u/%u (max %u), %.0f records/s, %"
+        G_GUINT64_FORMAT " dropped", appCtx->index, stats.queue_depth,
+        stats.queue_size, stats.max_queue_depth, stats.records_per_sec,
+        stats.num_dropped);
+    nvds_metric_set (s_metric_queue_depth,
+        METRICS_QUEUE_META_WRITER + appCtx->index, stats.queue_depth);
+    nvds_metric_set (s_metric_dropped,
+        METRICS_QUEUE_META_WRITER + appCtx->index, stats.num_dropped);
   }
 
-  num_fps_inst++;
-  if (num_fps_inst < num_instances) {
-    g_mutex_unlock (&fps_lock);
-    return;
+  for (i = 0; i < numf && i < str->num_instances; i++) {
+    nvds_metric_set (s_metric_fps, metrics_stream (appCtx, i), str->fps[i]);
+    nvds_metric_set (s_metric_fps_avg, metrics_stream (appCtx, i),
+        str->fps_avg[i]);
   }
 
-  num_fps_inst = 0;
-
-  if (header_print_cnt % 20 == 0) {
-    g_print ("\n**PERF: ");
-    for (i = 0; i < numf; i++) {
-      g_print ("FPS %d (Avg)\t", i);
-    }
-    g_print ("\n");
-    header_print_cnt = 0;
-  }
-  header_print_cnt++;
-  g_print ("**PERF: ");
-  for (i = 0; i < numf; i++) {
-    g_print ("%.2f (%.2f)\t", fps[i], fps_avg[i]);
-  }
-  g_print ("\n");
-  g_mutex_unlock (&fps_lock);
+  /* The report thread prints and writes these on its own clock, so no
+   * instance waits for the others. */
+  for (i = 0; i < str->num_instances; i++)
+    nvds_perf_report_set_fps (s_perf_report, appCtx->index, i, str->fps[i],
+        str->fps_avg[i]);
 }
 
 /**
@@ -595,6 +866,268 @@ overlay_graphics (AppCtx * appCtx, GstBuffer * buf,
   return TRUE;
 }
 
+/**
+ * Runs on the metrics server thread before every scrape. Only reads stats
+ * that are lock-free or guarded by locks the streaming threads never take.
+ */
+static void
+metrics_collect (NvDsMetrics * metrics, gpointer data)
+{
+  NvDsDetectionStats det_stats;
+  NvDsActuatorStats act_stats;
+  NvDsLogStats log_stats;
+
+  if (s_detections) {
+    nvds_detection_channel_get_stats (s_detections, &det_stats);
+    nvds_metric_set (s_metric_queue_depth, METRICS_QUEUE_DETECTIONS,
+        det_stats.num_pushed - det_stats.num_popped);
+    nvds_metric_set (s_metric_dropped, METRICS_QUEUE_DETECTIONS,
+        det_stats.num_dropped);
+  }
+  if (s_actuator) {
+    nvds_actuator_get_stats (s_actuator, &act_stats);
+    nvds_metric_set (s_metric_queue_depth, METRICS_QUEUE_ACTUATOR,
+        act_stats.queue_depth);
+    nvds_metric_set (s_metric_dropped, METRICS_QUEUE_ACTUATOR,
+        act_stats.num_dropped);
+  }
+  nvds_log_get_stats (&log_stats);
+  nvds_metric_set (s_metric_dropped, METRICS_QUEUE_LOG,
+      log_stats.num_dropped);
+}
+
+/**
+ * Register the metrics of every instance and start serving them, if
+ * [metrics] is enabled in the first config file.
+ */
+static void
+create_metrics (void)
+{
+  static const gdouble latency_bounds_ms[] = {
+    10, 20, 33, 50, 66, 100, 150, 200, 300, 500, 1000
+  };
+  static const gdouble delay_bounds_ms[] = {
+    0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100
+  };
+  static const gdouble stage_bounds_ms[] = {
+    0.5, 1, 2, 5, 10, 20, 33, 50, 100, 200, 500
+  };
+  NvDsMetricsConfig *config = &appCtx[0]->config.metrics_config;
+  NvDsMetric *latency, *delay, *stage_latency;
+  guint num_streams, num_queues, i;
+  gchar *name;
+  gchar stage_name[16];
+
+  if (!config->enable)
+    return;
+
+  num_streams = num_instances > 1 ? num_instances :
+      MAX (appCtx[0]->config.num_source_sub_bins, 1);
+  num_queues = METRICS_QUEUE_META_WRITER + num_instances;
+
+  s_metrics = nvds_metrics_new ();
+  s_metric_fps = nvds_metrics_add (s_metrics, "nvds_stream_fps",
+      "Frames per second over the last perf interval.", NV_DS_METRIC_GAUGE,
+      "stream", num_streams);
+  s_metric_fps_avg = nvds_metrics_add (s_metrics, "nvds_stream_fps_avg",
+      "Frames per second since start.", NV_DS_METRIC_GAUGE, "stream",
+      num_streams);
+  s_metric_frames = nvds_metrics_add (s_metrics, "nvds_frames_total",
+      "Frames that reached the analytics callbacks.", NV_DS_METRIC_COUNTER,
+      "stream", num_streams);
+  s_metric_objects = nvds_metrics_add (s_metrics, "nvds_objects_total",
+      "Primary detector objects by class id.", NV_DS_METRIC_COUNTER, "class",
+      128);
+  latency = nvds_metrics_add_histogram (s_metrics, "nvds_frame_latency_ms",
+      "Capture to sink latency (NVDS_ENABLE_LATENCY_MEASUREMENT=1).",
+      "stream", num_streams, latency_bounds_ms,
+      G_N_ELEMENTS (latency_bounds_ms));
+  s_metric_queue_depth = nvds_metrics_add (s_metrics, "nvds_queue_depth",
+      "Entries waiting in a queue.", NV_DS_METRIC_GAUGE, "queue", num_queues);
+  s_metric_dropped = nvds_metrics_add (s_metrics, "nvds_dropped_total",
+      "Samples dropped because a queue was full.", NV_DS_METRIC_COUNTER,
+      "queue", num_queues);
+  delay = nvds_metrics_add_histogram (s_metrics,
+      "nvds_actuator_start_delay_ms",
+      "Delay from posting a motion command to starting the motors.", NULL,
+      1, delay_bounds_ms, G_N_ELEMENTS (delay_bounds_ms));
+  stage_latency = nvds_metrics_add_histogram (s_metrics,
+      "nvds_stage_latency_ms",
+      "Time a frame spent in each stage (enable-stage-latency=1).", "stage",
+      NV_DS_STAGE_NUM, stage_bounds_ms, G_N_ELEMENTS (stage_bounds_ms));
+
+  nvds_metric_set_cell_label (s_metric_queue_depth, METRICS_QUEUE_DETECTIONS,
+      "detections");
+  nvds_metric_set_cell_label (s_metric_queue_depth, METRICS_QUEUE_ACTUATOR,
+      "actuator");
+  for (i = 0; i < num_instances; i++) {
+    name = g_strdup_printf ("meta_writer_%u", i);
+    nvds_metric_set_cell_label (s_metric_queue_depth,
+        METRICS_QUEUE_META_WRITER + i, name);
+    nvds_metric_set_cell_label (s_metric_dropped,
+        METRICS_QUEUE_META_WRITER + i, name);
+    g_free (name);
+  }
+  nvds_metric_set_cell_label (s_metric_dropped, METRICS_QUEUE_DETECTIONS,
+      "detections");
+  nvds_metric_set_cell_label (s_metric_dropped, METRICS_QUEUE_ACTUATOR,
+      "actuator");
+  nvds_metric_set_cell_label (s_metric_dropped, METRICS_QUEUE_LOG, "log");
+  for (i = 0; i < NV_DS_STAGE_NUM; i++) {
+    nvds_stage_latency_stage_name (i, stage_name, sizeof (stage_name));
+    nvds_metric_set_cell_label (stage_latency, i, stage_name);
+  }
+  nvds_metrics_set_collect_func (s_metrics, metrics_collect, NULL);
+
+  if (!nvds_metrics_start (s_metrics, config)) {
+    g_printerr ("metrics: disabled\n");
+    nvds_metrics_free (s_metrics);
+    s_metrics = NULL;
+    s_metric_fps = s_metric_fps_avg = s_metric_frames = s_metric_objects =
+        s_metric_queue_depth = s_metric_dropped = NULL;
+    return;
+  }
+
+  for (i = 0; i < num_instances; i++) {
+    appCtx[i]->latency_metric = latency;
+    appCtx[i]->stage_latency_metric = stage_latency;
+    appCtx[i]->metrics_stream = num_instances > 1 ? (gint) i : -1;
+  }
+  nvds_actuator_set_delay_metric (s_actuator, delay);
+}
+
+/**
+ * An edit of the config file of one instance has settled. What can change
+ * in place is taken from a fresh parse of the file; the rest is reported.
+ */
+static gboolean
+config_changed (const gchar * path, const NvDsConfigChange * changes,
+    guint num_changes, gpointer user_data)
+{
+  AppCtx *ctx = (AppCtx *) user_data;
+  NvDsConfig *config;
+  guint flags = 0, num_restart = 0;
+  guint i;
+
+  config = g_new0 (NvDsConfig, 1);
+  if (!parse_reload_config (config, (gchar *) path)) {
+    NVDS_LOG_WARN ("reload: %s does not parse, keeping the running config",
+        path);
+    g_free (config);
+    return FALSE;
+  }
+
+  for (i = 0; i < num_changes; i++) {
+    guint key_flags = config_reload_flags (changes[i].group, changes[i].key);
+
+    if (!key_flags) {
+      NVDS_LOG_WARN ("reload: [%s] %s %s, needs a restart", changes[i].group,
+          changes[i].key, nvds_config_change_kind_name (changes[i].kind));
+      num_restart++;
+      continue;
+    }
+    NVDS_LOG_INFO ("reload: [%s] %s %s", changes[i].group, changes[i].key,
+        nvds_config_change_kind_name (changes[i].kind));
+    flags |= key_flags;
+  }
+
+  reload_pipeline_config (ctx, config, flags);
+
+  /* One robot per process, driven by the first config file. */
+  if ((flags & NV_DS_RELOAD_PANTILT) && ctx->index == 0)
+    nvds_pantilt_set_config (s_pantilt, &ctx->config.pantilt_config);
+  if (flags & NV_DS_RELOAD_ADAPTIVE)
+    nvds_adaptive_interval_set_config (s_adaptive[ctx->index],
+        &ctx->config.adaptive_config);
+  /* With the adaptive controller the interval is its own to choose. */
+  if ((flags & NV_DS_RELOAD_PGIE_INTERVAL) && !s_adaptive[ctx->index])
+    set_pgie_interval (ctx, NV_DS_PGIE_INTERVAL_ADAPTIVE,
+        ctx->config.primary_gie_config.interval);
+
+  NVDS_LOG_INFO ("reload: %s: %u changes, %u applied, %u need a restart",
+      path, num_changes, num_changes - num_restart, num_restart);
+  free_reload_config (config);
+  g_free (config);
+  return TRUE;
+}
+
+/**
+ * Step the pipelines down (or back up) on the governor thread: a higher
+ * primary GIE interval from WARM on, no OSD drawing from HOT on and a
+ * higher interval still at CRITICAL.
+ */
+static void
+governor_changed (NvDsGovernorLevel level, NvDsGovernorLevel old_level,
+    const NvDsGovernorReading * reading, gpointer user_data)
+{
+  NvDsGovernorConfig *config = &appCtx[0]->config.governor_config;
+  guint interval = 0;
+  guint i;
+
+  /* The streammux size stays: every consumer of pixel coordinates works
+   * in the configured resolution, and nvstreammux does not renegotiate
+   * a playing output anyway. */
+  if (level >= NV_DS_GOVERNOR_CRITICAL)
+    interval = MAX (config->critical_interval, config->interval);
+  else if (level >= NV_DS_GOVERNOR_WARM)
+    interval = config->interval;
+
+  for (i = 0; i < num_instances; i++) {
+    set_pgie_interval (appCtx[i], NV_DS_PGIE_INTERVAL_GOVERNOR, interval);
+    g_atomic_int_set (&appCtx[i]->osd_suspended,
+        level >= NV_DS_GOVERNOR_HOT);
+  }
+}
+
+/**
+ * Start the aggregator behind the **PERF lines and the [perf-report] file
+ * of the first config, for every instance that runs a pipeline.
+ */
+static void
+create_perf_report (void)
+{
+  NvDsConfig *config = &appCtx[0]->config;
+  guint num_sources[MAX_INSTANCES];
+  guint i;
+
+  if (replay_paths || bench_config.output_path ||
+      (!config->enable_perf_measurement && !config->perf_report_config.enable))
+    return;
+
+  for (i = 0; i < num_instances; i++)
+    num_sources[i] = appCtx[i]->config.num_source_sub_bins;
+  s_perf_report = nvds_perf_report_new (&config->perf_report_config,
+      config->perf_measurement_interval_sec, num_instances, num_sources);
+  for (i = 0; i < num_instances; i++)
+    appCtx[i]->perf_report = s_perf_report;
+}
+
+static gboolean
+replay_done (gpointer data)
+{
+  quit = TRUE;
+  g_main_loop_quit (main_loop);
+  return FALSE;
+}
+
+static gpointer
+replay_thread_func (gpointer data)
+{
+  AppCtx *ctx = (AppCtx *) data;
+  NvDsReplayConfig config = { 0 };
+
+  config.path = replay_paths[ctx->index];
+  config.instance = ctx->index;
+  config.speed = replay_speed;
+  if (!replay_pipeline (ctx, &config, bbox_generated_post_analytics,
+          all_bbox_generated))
+    ctx->return_value = -1;
+
+  if (g_atomic_int_dec_and_test (&s_replays_running))
+    g_idle_add (replay_done, NULL);
+  return NULL;
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -602,32 +1135,29 @@ main (int argc, char *argv[])
   GOptionGroup *group = NULL;
   GError *error = NULL;
   guint i;
+  NvDsLogLevel log_level = NV_DS_LOG_INFO;
 
 // jayden.choe
   pthread_t tA;
   int thread_err = 0;
-  sem_init(&sem_one, 0, 0);
-  sem_init(&sem_two, 0, 1);
+  gboolean thread_created = FALSE;
+  s_detections = nvds_detection_channel_new (256);
   
 
 
 // jayden.choe
   init_python3( (void*) argv );
-  python_test( );
-  gpio_export(14);
-  gpio_set_outdir(14, 1);
-  gpio_set(14, 1);
-  
-  thread_err = pthread_create(&tA, NULL, thread_a, (void*)argv );
-  if (thread_err != 0) {
-    g_printf( "thread A create fail: %d\n", thread_err);
-  }
 ////////////////////////////////////////////////////////////////
   ctx = g_option_context_new ("Nvidia DeepStream Demo");
   group = g_option_group_new ("abc", NULL, NULL, NULL, NULL);
   g_option_group_add_entries (group, entries);
 
   g_option_context_set_main_group (ctx, group);
+
+  group = g_option_group_new ("bench", "Callback benchmark options:",
+      "Show callback benchmark options", NULL, NULL);
+  g_option_group_add_entries (group, bench_entries);
+  g_option_context_add_group (ctx, group);
   
   g_option_context_add_group (ctx, gst_init_get_option_group ());
 
@@ -653,6 +1183,12 @@ main (int argc, char *argv[])
     return 0;
   }
 
+  if (log_level_name && !nvds_log_parse_level (log_level_name, &log_level)) {
+    NVGSTDS_ERR_MSG_V ("Unknown log level '%s'", log_level_name);
+    return -1;
+  }
+  nvds_log_init (log_level, 0);
+
   if (cfg_files) {
     num_instances = g_strv_length (cfg_files);
   }
@@ -668,11 +1204,18 @@ main (int argc, char *argv[])
     goto done;
   }
 
+  if (replay_paths && g_strv_length (replay_paths) != num_instances) {
+    NVGSTDS_ERR_MSG_V ("Specify one --replay per config file");
+    return_value = -1;
+    goto done;
+  }
+
   for (i = 0; i < num_instances; i++) {
     appCtx[i] = g_malloc0 (sizeof (AppCtx));
     appCtx[i]->person_class_id = -1;
     appCtx[i]->car_class_id = -1;
     appCtx[i]->index = i;
+    g_mutex_init (&appCtx[i]->pgie_interval_lock);
     if (show_bbox_text) {
       appCtx[i]->show_bbox_text = TRUE;
     }
@@ -690,8 +1233,61 @@ main (int argc, char *argv[])
     }
   }
 
+// jayden.choe
+  /* There is one robot per process; its motor driver comes from the first
+   * config file and stays open until exit. */
+  /* Benchmark runs feed synthetic targets to the controller; keep the
+   * robot still. */
+  s_motor = bench_config.output_path ? NULL :
+      nvds_motor_open (&appCtx[0]->config.motor_config);
+  if (!s_motor) {
+    g_print ("motor backend unavailable, robot will not move\n");
+  } else {
+    s_actuator = nvds_actuator_scheduler_new (s_motor, 8);
+  }
+  nvds_target_selector_init (&s_target, &appCtx[0]->config.target_config);
+  s_predictor = nvds_predictor_new (&appCtx[0]->config.predictor_config);
+  s_servo = bench_config.output_path ? NULL :
+      nvds_servo_open (&appCtx[0]->config.servo_config);
+  if (s_servo) {
+    s_pantilt = nvds_pantilt_new (&appCtx[0]->config.pantilt_config);
+  }
+  create_metrics ();
+  create_perf_report ();
+  python_test( );
+  gpio_export(14);
+  gpio_set_outdir(14, 1);
+  gpio_set(14, 1);
+  
+  thread_err = pthread_create(&tA, NULL, thread_a, (void*)argv );
+  if (thread_err != 0) {
+    g_printf( "thread A create fail: %d\n", thread_err);
+  } else {
+    thread_created = TRUE;
+  }
+////////////////////////////////////////////////////////////////
+
   for (i = 0; i < num_instances; i++) {
-    if (!create_pipeline (appCtx[i], NULL,
+    s_fall[i] = nvds_fall_detector_new (&appCtx[i]->config.fall_config,
+        appCtx[i]->config.streammux_config.pipeline_height);
+    s_trajectories[i] = nvds_trajectory_store_new (TRAJECTORY_MAX_TRACKS,
+        TRAJECTORY_HISTORY, TRAJECTORY_EXPIRE_FRAMES);
+    s_adaptive[i] = replay_paths || bench_config.output_path ? NULL :
+        nvds_adaptive_interval_new (&appCtx[i]->config.adaptive_config,
+        appCtx[i]->config.primary_gie_config.interval);
+    s_zones[i] = nvds_zone_engine_new (appCtx[i]->config.zone_config,
+        appCtx[i]->config.num_zones,
+        appCtx[i]->config.streammux_config.pipeline_width,
+        appCtx[i]->config.streammux_config.pipeline_height);
+    if (replay_paths) {
+      g_atomic_int_inc (&s_replays_running);
+      s_replay_threads[i] = g_thread_new ("nvds-replay", replay_thread_func,
+          appCtx[i]);
+      continue;
+    }
+    if (bench_config.output_path)
+      continue;
+    if (!create_pipeline (appCtx[i], bbox_generated_post_analytics,
             all_bbox_generated, perf_cb, overlay_graphics)) {
       NVGSTDS_ERR_MSG_V ("Failed to create pipeline");
       return_value = -1;
@@ -699,11 +1295,29 @@ main (int argc, char *argv[])
     }
   }
 
+  /* The benchmark uses the first config file only. Source 0 is shown so
+   * that overlay_graphics does its full work. */
+  if (bench_config.output_path) {
+    source_ids[0] = 0;
+    if (!bench_pipeline (appCtx[0], &bench_config,
+            bbox_generated_post_analytics, all_bbox_generated,
+            overlay_graphics))
+      return_value = -1;
+    goto done;
+  }
+
   main_loop = g_main_loop_new (NULL, FALSE);
 
   _intr_setup ();
   g_timeout_add (400, check_for_interrupt, NULL);
 
+  /* Replay has no pipeline and no windows; run until every recording has
+   * been played or the user interrupts. */
+  if (replay_paths) {
+    g_main_loop_run (main_loop);
+    goto done;
+  }
+
 
   g_mutex_init (&disp_lock);
   display = XOpenDisplay (NULL);
@@ -807,6 +1421,13 @@ main (int argc, char *argv[])
     }
   }
 
+  s_governor = nvds_governor_new (&appCtx[0]->config.governor_config,
+      governor_changed, NULL);
+
+  for (i = 0; i < num_instances; i++)
+    s_config_watch[i] = nvds_config_watch_new (cfg_files[i], config_changed,
+        appCtx[i]);
+
   print_runtime_commands ();
 
   changemode (1);
@@ -820,9 +1441,98 @@ done:
 
   g_print ("Quitting\n");
   for (i = 0; i < num_instances; i++) {
+    NvDsConfigWatchStats watch_stats;
+
+    if (!s_config_watch[i])
+      continue;
+    nvds_config_watch_get_stats (s_config_watch[i], &watch_stats);
+    g_print ("config reload[%u]: %" G_GUINT64_FORMAT " events, %"
+        G_GUINT64_FORMAT " reloads, %" G_GUINT64_FORMAT " failed, %"
+        G_GUINT64_FORMAT " keys changed\n", i, watch_stats.num_events,
+        watch_stats.num_reloads, watch_stats.num_failed,
+        watch_stats.num_changes);
+    nvds_config_watch_free (s_config_watch[i]);
+    s_config_watch[i] = NULL;
+  }
+  /* Before the pipelines go, since it sets their properties. */
+  if (s_governor) {
+    NvDsGovernorStats gov_stats;
+    nvds_governor_get_stats (s_governor, &gov_stats);
+    nvds_governor_free (s_governor);
+    s_governor = NULL;
+    g_print ("governor: %" G_GUINT64_FORMAT " polls, %" G_GUINT64_FORMAT
+        " read errors, %" G_GUINT64_FORMAT " transitions, max %.1f C / %d mW, "
+        "s at normal %" G_GUINT64_FORMAT " warm %" G_GUINT64_FORMAT " hot %"
+        G_GUINT64_FORMAT " critical %" G_GUINT64_FORMAT "\n",
+        gov_stats.num_polls, gov_stats.num_errors, gov_stats.num_transitions,
+        gov_stats.max_temp, gov_stats.max_power_mw,
+        gov_stats.level_us[NV_DS_GOVERNOR_NORMAL] / G_USEC_PER_SEC,
+        gov_stats.level_us[NV_DS_GOVERNOR_WARM] / G_USEC_PER_SEC,
+        gov_stats.level_us[NV_DS_GOVERNOR_HOT] / G_USEC_PER_SEC,
+        gov_stats.level_us[NV_DS_GOVERNOR_CRITICAL] / G_USEC_PER_SEC);
+  }
+  for (i = 0; i < num_instances; i++) {
+    /* Argument and config errors leave the later instances unallocated. */
+    if (!appCtx[i])
+      continue;
+    if (s_replay_threads[i]) {
+      appCtx[i]->quit = TRUE;
+      g_thread_join (s_replay_threads[i]);
+      s_replay_threads[i] = NULL;
+    } else if (!bench_config.output_path) {
+      destroy_pipeline (appCtx[i]);
+    }
     if (appCtx[i]->return_value == -1)
       return_value = -1;
-    destroy_pipeline (appCtx[i]);
+
+    if (s_fall[i]) {
+      NvDsFallStats fall_stats;
+      nvds_fall_detector_get_stats (s_fall[i], &fall_stats);
+      g_print ("fall detection[%u]: %" G_GUINT64_FORMAT " updates, %"
+          G_GUINT64_FORMAT " falls, %u tracks, %" G_GUINT64_FORMAT
+          " evictions\n", i, fall_stats.num_updates, fall_stats.num_events,
+          fall_stats.active_tracks, fall_stats.num_evictions);
+      nvds_fall_detector_free (s_fall[i]);
+      s_fall[i] = NULL;
+    }
+
+    if (s_adaptive[i]) {
+      NvDsAdaptiveStats adaptive_stats;
+      nvds_adaptive_interval_get_stats (s_adaptive[i], &adaptive_stats);
+      g_print ("adaptive interval[%u]: %" G_GUINT64_FORMAT " batches, %"
+          G_GUINT64_FORMAT " inferred, %" G_GUINT64_FORMAT " saved vs interval "
+          "%u, %" G_GUINT64_FORMAT " raises, %" G_GUINT64_FORMAT " drops, "
+          "interval %u (max %u)\n", i, adaptive_stats.num_batches,
+          adaptive_stats.num_inferred, adaptive_stats.num_saved,
+          appCtx[i]->config.primary_gie_config.interval,
+          adaptive_stats.num_raises, adaptive_stats.num_drops,
+          adaptive_stats.interval, adaptive_stats.max_interval_seen);
+      nvds_adaptive_interval_free (s_adaptive[i]);
+      s_adaptive[i] = NULL;
+    }
+
+    if (s_trajectories[i]) {
+      NvDsTrajectoryStats traj_stats;
+      nvds_trajectory_store_get_stats (s_trajectories[i], &traj_stats);
+      g_print ("trajectories[%u]: %" G_GUINT64_FORMAT " points, %"
+          G_GUINT64_FORMAT " tracks created, %" G_GUINT64_FORMAT " expired, %"
+          G_GUINT64_FORMAT " rejected, max probe %u\n", i,
+          traj_stats.num_points, traj_stats.num_created, traj_stats.num_expired,
+          traj_stats.num_rejected, traj_stats.max_probe);
+      nvds_trajectory_store_free (s_trajectories[i]);
+      s_trajectories[i] = NULL;
+    }
+
+    if (s_zones[i]) {
+      NvDsZoneStats zone_stats;
+      nvds_zone_engine_get_stats (s_zones[i], &zone_stats);
+      g_print ("zones[%u]: %" G_GUINT64_FORMAT " lookups, %" G_GUINT64_FORMAT
+          " exact tests, %" G_GUINT64_FORMAT " events, %" G_GUINT64_FORMAT
+          " evictions\n", i, zone_stats.num_lookups, zone_stats.num_exact_tests,
+          zone_stats.num_events, zone_stats.num_evictions);
+      nvds_zone_engine_free (s_zones[i]);
+      s_zones[i] = NULL;
+    }
 
     g_mutex_lock (&disp_lock);
     if (windows[i])
@@ -830,6 +1540,7 @@ done:
     windows[i] = 0;
     g_mutex_unlock (&disp_lock);
 
+    g_mutex_clear (&appCtx[i]->pgie_interval_lock);
     g_free (appCtx[i]);
   }
 
@@ -858,13 +1569,140 @@ done:
 
 // jayden.choe
   s_b_terminate_thread = TRUE;
-  thread_err = pthread_join(tA, NULL);
-  if ( thread_err != 0) {
-    g_print("thread A Join fail : %d\n", thread_err);
+  if (thread_created) {
+    thread_err = pthread_join(tA, NULL);
+    if ( thread_err != 0) {
+      g_print("thread A Join fail : %d\n", thread_err);
+    }
   }
 
-  sem_destroy(&sem_one);
-  sem_destroy(&sem_two);
+  /* The collector reads the modules freed below. */
+  if (s_metrics)
+    nvds_metrics_set_collect_func (s_metrics, NULL, NULL);
+
+  if (s_perf_report) {
+    NvDsPerfReportStats report_stats;
+    nvds_perf_report_get_stats (s_perf_report, &report_stats);
+    nvds_perf_report_free (s_perf_report);
+    s_perf_report = NULL;
+    g_print ("perf report: %" G_GUINT64_FORMAT " reports, %" G_GUINT64_FORMAT
+        " rolled, %" G_GUINT64_FORMAT " errors, last report %" G_GUINT64_FORMAT
+        " us\n", report_stats.num_reports, report_stats.num_rolls,
+        report_stats.num_errors, report_stats.last_report_us);
+  }
+
+  /* Every thread that logs has stopped; print what is still buffered. */
+  nvds_log_shutdown ();
+  {
+    NvDsLogStats log_stats;
+    nvds_log_get_stats (&log_stats);
+    g_print ("log: %" G_GUINT64_FORMAT " records, %" G_GUINT64_FORMAT
+        " dropped, %" G_GUINT64_FORMAT " suppressed, max ring fill %u bytes\n",
+        log_stats.num_records, log_stats.num_dropped, log_stats.num_suppressed,
+        log_stats.max_ring_fill);
+  }
+
+  if (s_actuator) {
+    NvDsActuatorStats act_stats;
+    nvds_actuator_get_stats (s_actuator, &act_stats);
+    g_print ("actuator: %" G_GUINT64_FORMAT " queued, %" G_GUINT64_FORMAT
+        " preempted, %" G_GUINT64_FORMAT " executed, %" G_GUINT64_FORMAT
+        " dropped, avg start delay %.1f us, max %" G_GUINT64_FORMAT " us\n",
+        act_stats.num_queued, act_stats.num_preempted, act_stats.num_executed,
+        act_stats.num_dropped,
+        act_stats.num_executed ?
+        (gdouble) act_stats.total_start_delay_us / act_stats.num_executed : 0,
+        act_stats.max_start_delay_us);
+    nvds_actuator_scheduler_free (s_actuator);
+    s_actuator = NULL;
+  }
+
+  if (s_motor) {
+    NvDsMotorStats motor_stats;
+    nvds_motor_get_stats (s_motor, &motor_stats);
+    g_print ("motor: %" G_GUINT64_FORMAT " commands, %" G_GUINT64_FORMAT
+        " failed, avg %.1f us, max %" G_GUINT64_FORMAT " us\n",
+        motor_stats.num_commands, motor_stats.num_failed,
+        motor_stats.num_commands ?
+        (gdouble) motor_stats.total_latency_us / motor_stats.num_commands : 0,
+        motor_stats.max_latency_us);
+    nvds_motor_close (s_motor);
+    s_motor = NULL;
+  }
+
+  if (s_pantilt) {
+    NvDsPanTiltStats pt_stats;
+    nvds_pantilt_get_stats (s_pantilt, &pt_stats);
+    g_print ("pan-tilt: %" G_GUINT64_FORMAT " updates, %" G_GUINT64_FORMAT
+        " moves, %" G_GUINT64_FORMAT " in deadband, %" G_GUINT64_FORMAT " slew "
+        "limited, %" G_GUINT64_FORMAT " saturated\n", pt_stats.num_updates,
+        pt_stats.num_moves, pt_stats.num_deadband, pt_stats.num_slew_limited,
+        pt_stats.num_saturated);
+    nvds_pantilt_free (s_pantilt);
+    s_pantilt = NULL;
+  }
+
+  if (s_servo) {
+    NvDsServoStats servo_stats;
+    nvds_servo_get_stats (s_servo, &servo_stats);
+    g_print ("servo: %" G_GUINT64_FORMAT " packets, %" G_GUINT64_FORMAT
+        " failed, avg %.1f us, max %" G_GUINT64_FORMAT " us\n",
+        servo_stats.num_packets, servo_stats.num_failed,
+        servo_stats.num_packets ?
+        (gdouble) servo_stats.total_latency_us / servo_stats.num_packets : 0,
+        servo_stats.max_latency_us);
+    nvds_servo_close (s_servo);
+    s_servo = NULL;
+  }
+
+  if (s_detections) {
+    NvDsDetectionStats det_stats;
+    nvds_detection_channel_get_stats (s_detections, &det_stats);
+    g_print ("detections: %" G_GUINT64_FORMAT " pushed, %" G_GUINT64_FORMAT
+        " dropped, %" G_GUINT64_FORMAT " consumed, %" G_GUINT64_FORMAT
+        " wakeups\n", det_stats.num_pushed, det_stats.num_dropped,
+        det_stats.num_popped, det_stats.num_wakeups);
+    nvds_detection_channel_free (s_detections);
+    s_detections = NULL;
+    g_print ("target: %" G_GUINT64_FORMAT " frames, %" G_GUINT64_FORMAT
+        " switches, %" G_GUINT64_FORMAT " lost, %" G_GUINT64_FORMAT " held\n",
+        s_target.stats.num_frames, s_target.stats.num_switches,
+        s_target.stats.num_lost, s_target.stats.num_held);
+  }
+
+  if (s_predictor) {
+    NvDsPredictorStats pred_stats;
+    nvds_predictor_get_stats (s_predictor, &pred_stats);
+    g_print ("predictor: %" G_GUINT64_FORMAT " updates, %" G_GUINT64_FORMAT
+        " predictions, avg cost %.0f ns, max %" G_GUINT64_FORMAT " ns\n",
+        pred_stats.num_updates, pred_stats.num_predictions,
+        pred_stats.num_updates + pred_stats.num_predictions ?
+        (gdouble) pred_stats.total_cost_ns / (pred_stats.num_updates +
+            pred_stats.num_predictions) : 0, pred_stats.max_cost_ns);
+    g_print ("predictor: avg error %.1f px (naive %.1f px), "
+        "avg latency %.1f ms, max %.1f ms\n",
+        pred_stats.num_errors ?
+        pred_stats.total_error_px / pred_stats.num_errors : 0,
+        pred_stats.num_errors ?
+        pred_stats.total_naive_error_px / pred_stats.num_errors : 0,
+        pred_stats.num_predictions ?
+        pred_stats.total_latency_us / 1000.0 / pred_stats.num_predictions : 0,
+        pred_stats.max_latency_us / 1000.0);
+    nvds_predictor_free (s_predictor);
+    s_predictor = NULL;
+  }
+
+  /* After the actuator, whose thread records into the metrics. */
+  if (s_metrics) {
+    NvDsMetricsStats metrics_stats;
+    nvds_metrics_get_stats (s_metrics, &metrics_stats);
+    g_print ("metrics: %" G_GUINT64_FORMAT " scrapes, %" G_GUINT64_FORMAT
+        " errors, last scrape %" G_GUINT64_FORMAT " us\n",
+        metrics_stats.num_scrapes, metrics_stats.num_errors,
+        metrics_stats.last_scrape_us);
+    nvds_metrics_free (s_metrics);
+    s_metrics = NULL;
+  }
   end_python3();
 //////////////////////////////////////////////
   return return_value;
@@ -872,6 +1710,7 @@ done:
 
 // jayden.choe
 wchar_t *g_p_program = NULL;
+static PyThreadState *g_py_main_state = NULL;
 
 void python_test( void ) {
 
@@ -882,7 +1721,10 @@ void python_test( void ) {
 //  call_python3_command_camera_to_center();
    call_python3_command_camera_to_front();
    call_python3_command_3beep();
-   call_python3_command_move_down();
+   {
+     NvDsActuatorCommand down = { NV_DS_ACTUATOR_CMD_VERTICAL, -1.0, 0, 1000 };
+     nvds_actuator_post (s_actuator, &down, 1);
+   }
  //  call_python3_command_move_down();
  //  call_python3_command_move_down();
 // call_python3_command_move_down();
@@ -911,33 +1753,53 @@ void init_python3 (char *argv[] ) {
   Py_SetProgramName(g_p_program);  /* optional but recommended */
  
   Py_Initialize();
+#if PY_VERSION_HEX < 0x03070000
+  PyEval_InitThreads();
+#endif
   g_printf( "Current folder has been appended to sys.path\n" );    
   PyObject *sys_path = PySys_GetObject("path");
   PyList_Append(sys_path, PyUnicode_FromString("/home/jetbot/deepstream_sdk_v4.0.2_jetson/sources/apps/sample_apps/deepstream-app"));
   PyList_Append(sys_path, PyUnicode_FromString("/home/jetbot/yahboom-jetbot"));
+  /* Hand the GIL back; from here on every thread, this one included,
+   * takes it with PyGILState_Ensure() around its calls. */
+  g_py_main_state = PyEval_SaveThread();
 }
 
 void end_python3 ( void ) {
   g_printf ( "end_python3\n");
+  if ( g_py_main_state != NULL ) {
+    PyEval_RestoreThread( g_py_main_state );
+    g_py_main_state = NULL;
+  }
   if ( g_p_program != NULL ) {
     PyMem_RawFree(g_p_program);
   }
 }
 
+/* Camera gimbal presets from adjust_camera_to_center.py and
+ * adjust_camera_to_front.py. The native driver sends them as one sync-write
+ * packet on the already open port; the Python scripts are only used when the
+ * port could not be opened. */
 void call_python3_command_camera_to_center( void ) {
-  PyRun_SimpleString( "from servoserial import ServoSerial\n"
+  if (s_servo && nvds_servo_pan_tilt (s_servo, 2100, 2048)) {
+    return;
+  }
+  call_python3_command( "from servoserial import ServoSerial\n"
                       "servo_device = ServoSerial()\n"
                       "servo_device.Servo_serial_double_control(1, 2100, 2, 2048)\n");  
 }
 
 void call_python3_command_camera_to_front( void ) {
-  PyRun_SimpleString( "from servoserial import ServoSerial\n"
+  if (s_servo && nvds_servo_pan_tilt (s_servo, 2100, 1500)) {
+    return;
+  }
+  call_python3_command( "from servoserial import ServoSerial\n"
                       "servo_device = ServoSerial()\n"
                       "servo_device.Servo_serial_double_control(1, 2100, 2, 1500)\n");  
 }
 
 void call_python3_command_move_up( void ) {
-  PyRun_SimpleString( "from jetbot import Robot\n"
+  call_python3_command( "from jetbot import Robot\n"
                       "import time\n"
                       "robot = Robot()\n"
                       "robot.up(1)\n"
@@ -946,7 +1808,7 @@ void call_python3_command_move_up( void ) {
 }
 
 void call_python3_command_move_down( void ) {
-  PyRun_SimpleString( "from jetbot import Robot\n"
+  call_python3_command( "from jetbot import Robot\n"
                       "import time\n"  
                       "robot = Robot()\n"
                       "robot.down(1)\n"
@@ -955,7 +1817,7 @@ void call_python3_command_move_down( void ) {
 }
 
 void call_python3_command_move_forward( void ) {
-  PyRun_SimpleString( "from jetbot import Robot\n"
+  call_python3_command( "from jetbot import Robot\n"
                       "import time\n"
                       "robot = Robot()\n"
                       "robot.forward(0.8)\n"
@@ -964,7 +1826,7 @@ void call_python3_command_move_forward( void ) {
 }
 
 void call_python3_command_move_backward( void ) {
-  PyRun_SimpleString( "from jetbot import Robot\n"
+  call_python3_command( "from jetbot import Robot\n"
                       "import time\n"
                       "robot = Robot()\n"
                       "robot.backward(0.8)\n"
@@ -973,7 +1835,7 @@ void call_python3_command_move_backward( void ) {
 }
 
 void call_python3_command_move_left( void ) {
-  PyRun_SimpleString( "from jetbot import Robot\n"
+  call_python3_command( "from jetbot import Robot\n"
                       "import time\n"
                       "robot = Robot()\n"  
                       "robot.left(0.7)\n"
@@ -982,7 +1844,7 @@ void call_python3_command_move_left( void ) {
 }
 
 void call_python3_command_move_right( void ) {
-  PyRun_SimpleString( "from jetbot import Robot\n"
+  call_python3_command( "from jetbot import Robot\n"
                       "import time\n"
                       "robot = Robot()\n"  
                       "robot.right(0.5)\n"
@@ -991,19 +1853,19 @@ void call_python3_command_move_right( void ) {
 }
 
 void call_python3_command_move_stop( void ) {
-  PyRun_SimpleString( "from jetbot import Robot\n"
+  call_python3_command( "from jetbot import Robot\n"
                       "import time\n"
                       "robot = Robot()\n"
                       "robot.stop()\n" );  
 }
 
 void call_python3_command_sleep( void ) {
-  PyRun_SimpleString( "import time\n"
+  call_python3_command( "import time\n"
                       "time.sleep(0.5)\n" );
 }
 
 void call_python3_command_3beep( void ) {
-  PyRun_SimpleString( "import RPi.GPIO as GPIO\n"
+  call_python3_command( "import RPi.GPIO as GPIO\n"
                       "import time\n"
                       "BEEP_pin = 6\n"
                       "GPIO.setmode(GPIO.BCM)\n" 
@@ -1023,13 +1885,18 @@ void call_python3_command_3beep( void ) {
                       );
 }
 
+/* The interpreter is shared with the motor's actuator thread; take the GIL
+ * for every call. */
 void call_python3_command( char *p_command_string ) {
+  PyGILState_STATE state = PyGILState_Ensure();
 
   PyRun_SimpleString(p_command_string);
+  PyGILState_Release(state);
   return;
 }
 
 void call_python3_file ( char *p_filename ) {
+  PyGILState_STATE state = PyGILState_Ensure();
   PyObject *obj = Py_BuildValue("s", p_filename );
   FILE *fp = _Py_fopen_obj(obj, "r+");
   if(!fp) {
@@ -1044,6 +1911,8 @@ void call_python3_file ( char *p_filename ) {
   }
   g_printf ( "fclose\n");
   fclose(fp);  
+  Py_DECREF(obj);
+  PyGILState_Release(state);
 }
 
 int gpio_export(int gpio)
@@ -1142,22 +2011,111 @@ int gpio_get(int gpio)
       return 0;
 }
 
+/**
+ * Post a turn followed by a short forward run as one intent. The detection
+ * loop never waits for the wheels; a newer target replaces whatever part of
+ * this motion has not run yet. A zero turn posts the forward run only.
+ */
+static void
+actuator_post_drive (gdouble turn_left, gdouble turn_right)
+{
+  NvDsActuatorCommand cmds[2] = {
+    {NV_DS_ACTUATOR_CMD_DRIVE, turn_left, turn_right, 500},
+    {NV_DS_ACTUATOR_CMD_DRIVE, 0.8, 0.8, 500},
+  };
+
+  if (turn_left == 0 && turn_right == 0)
+    nvds_actuator_post (s_actuator, &cmds[1], 1);
+  else
+    nvds_actuator_post (s_actuator, cmds, 2);
+}
+
+/**
+ * Steer the camera gimbal towards the sample's bbox centre. Runs once per
+ * frame; the time step comes from the buffer PTS so the gains do not depend
+ * on how quickly the thread was woken up.
+ */
+static void
+pantilt_track (const NvDsDetectionSample * sample)
+{
+  static guint64 last_pts = 0;
+  NvDsStreammuxConfig *mux = &appCtx[0]->config.streammux_config;
+  gdouble dt = 1.0 / 30;
+  gdouble err_x, err_y;
+  gint pan, tilt;
+
+  if (mux->pipeline_width <= 0 || mux->pipeline_height <= 0)
+    return;
+
+  if (last_pts && sample->pts > last_pts)
+    dt = MIN ((gdouble) (sample->pts - last_pts) / GST_SECOND, 0.2);
+  last_pts = sample->pts;
+
+  err_x = (sample->left + sample->width / 2) / (mux->pipeline_width / 2.0) - 1;
+  err_y = (sample->top + sample->height / 2) / (mux->pipeline_height / 2.0) - 1;
+
+  if (nvds_pantilt_update (s_pantilt, err_x, err_y, dt, &pan, &tilt))
+    nvds_servo_pan_tilt (s_servo, pan, tilt);
+}
+
+/* Where the target is across the frame; the two middle segments both
+ * mean straight ahead. */
+typedef enum {
+  FOLLOW_BAND_NONE = -1,
+  FOLLOW_BAND_LEFT,
+  FOLLOW_BAND_FORWARD,
+  FOLLOW_BAND_RIGHT
+} FollowBand;
+
 void *thread_a ( void* p_arg ) {
   int human_x = 0;
   int human_y = 0;
   int move_count = 0;
+  FollowBand band;
+  FollowBand posted_band = FOLLOW_BAND_NONE;
 
   g_printf ( "thread_a: started\n");
 
   g_printf ( "thread_a: going into while\n");
 
   while ( s_b_terminate_thread == FALSE ) {
-    call_python3_command_sleep();
-    if ( human_x == s_human_x && human_y == s_human_y ) {
+    NvDsDetectionSample frame_samples[64];
+    NvDsDetectionSample sample;
+    NvDsStreammuxConfig *mux = &appCtx[0]->config.streammux_config;
+    guint num_samples = 0;
+    guint i;
+
+    /* Runs once per committed frame; the timeout only bounds how long
+     * shutdown waits. */
+    if ( !nvds_detection_channel_wait( s_detections, 100000 ) ) {
       continue;
     }
-    human_x = s_human_x;
-    human_y = s_human_y;
+    /* Act on the newest frame only; anything older is already stale. */
+    while ( nvds_detection_channel_pop( s_detections, &sample ) ) {
+      if ( num_samples > 0 &&
+          ( sample.frame_num != frame_samples[0].frame_num ||
+            sample.source_id != frame_samples[0].source_id ) ) {
+        num_samples = 0;
+      }
+      if ( num_samples < G_N_ELEMENTS( frame_samples ) ) {
+        frame_samples[num_samples++] = sample;
+      }
+    }
+    for ( i = 0; s_predictor && i < num_samples; i++ ) {
+      nvds_predictor_update( s_predictor, &frame_samples[i] );
+    }
+    if ( !nvds_target_selector_update( &s_target, frame_samples, num_samples,
+            mux->pipeline_width, mux->pipeline_height, &sample ) ) {
+      continue;
+    }
+    /* Steer towards where the target will be when the motors react, not
+     * where it was when the frame was captured. */
+    nvds_predictor_apply( s_predictor, &sample, g_get_monotonic_time() );
+    if ( s_pantilt ) {
+      pantilt_track( &sample );
+    }
+    human_x = (int) (sample.left + sample.width) / 2;
+    human_y = (int) (sample.top + sample.height) / 2;
   // invalidate values if wrong or broken value has come.  
     if ( human_x == -1 || human_x < 150 || 650 < human_x ) {
       human_x = -1;
@@ -1166,31 +2124,45 @@ void *thread_a ( void* p_arg ) {
       human_y = -1;
     }
   // devide x segments to 4, 100~299, 300~399, 400~499, 500~600
+    band = FOLLOW_BAND_NONE;
     if ( 0 < human_x && human_x <= 299 ) {
-        g_printf ( "thread_a: go left and forward\n");
-        // go left and forward
-        call_python3_command_move_left();
-        call_python3_command_move_forward();
-        move_count++;
-    }
-    if ( 300 < human_x && human_x <= 399 ) {
-        g_printf ( "thread_a: go forward\n");
-        call_python3_command_move_forward();
-        move_count++;
+      band = FOLLOW_BAND_LEFT;
     }
-    if ( 400 < human_x && human_x <= 499 ) {
-         g_printf ( "thread_a: go forward\n");
-        call_python3_command_move_forward();
-        move_count++;
+    if ( ( 300 < human_x && human_x <= 399 ) ||
+        ( 400 < human_x && human_x <= 499 ) ) {
+      band = FOLLOW_BAND_FORWARD;
     }
     if ( 500 < human_x && human_x <= 650 ) {
-         g_printf ( "thread_a: go righ and forward\n");
-        call_python3_command_move_right();
-        call_python3_command_move_forward();
-        move_count++;
-    }    
+      band = FOLLOW_BAND_RIGHT;
+    }
+    /* The same band while the last move is still running would only
+     * restart it; wait for it to finish or for the target to move. */
+    if ( band != FOLLOW_BAND_NONE &&
+        ( band != posted_band || nvds_actuator_is_idle( s_actuator ) ) ) {
+      switch ( band ) {
+        case FOLLOW_BAND_LEFT:
+          g_printf ( "thread_a: go left and forward\n");
+          actuator_post_drive( -0.7, 0.7 );
+          break;
+        case FOLLOW_BAND_RIGHT:
+          g_printf ( "thread_a: go righ and forward\n");
+          actuator_post_drive( 0.5, -0.5 );
+          break;
+        default:
+          g_printf ( "thread_a: go forward\n");
+          actuator_post_drive( 0, 0 );
+          break;
+      }
+      /* Every posted move counts towards the safety limit, also one that
+       * a newer move cancels before it has finished. */
+      move_count++;
+      posted_band = band;
+    }
     if ( 10 <= move_count ) {
-      call_python3_command_move_up();
+      {
+        NvDsActuatorCommand up = { NV_DS_ACTUATOR_CMD_VERTICAL, 1.0, 0, 1000 };
+        nvds_actuator_post (s_actuator, &up, 1);
+      }
       gpio_set(14, 0);
       g_printf( "thread_a: gpio 14 set to 1. read value: %d\n", gpio_get(14));
       g_printf( "thread_a: move count is over. exit loop for safety");
@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "deepstream_app_metawriter.h"
+#include "deepstream_app_detlog.h"
+
+#define DEFAULT_META_WRITER_QUEUE_SIZE 16
+#define DEFAULT_META_WRITER_BATCH_SIZE 1024
+
+typedef struct
+{
+  gchar *dir;
+  NvDsDetectionLog *log;
+  /** KITTI file of the last frame; a frame may continue in the next batch
+   * of the same output. */
+  FILE *file;
+} MetaOutput;
+
+struct _NvDsMetaWriter
+{
+  NvDsMetaWriterConfig config;
+  guint instance;
+  MetaOutput outputs[NV_DS_META_OUTPUT_NUM];
+
+  NvDsMetaBatch *batches;
+  NvDsMetaRecord *records;
+
+  GThread *thread;
+  GMutex lock;
+  GCond work_cond;
+  GCond free_cond;
+  gboolean stop;
+  /** Batches nobody holds, used as a stack. */
+  NvDsMetaBatch **free_batches;
+  guint num_free;
+  /** Submitted batches, oldest first. */
+  NvDsMetaBatch **queue;
+  guint head;
+  guint count;
+
+  gint64 last_warning;
+  gint64 rate_time;
+  guint64 rate_records;
+  NvDsMetaWriterStats stats;
+};
+
+static void
+meta_writer_write_kitti (NvDsMetaWriter * writer, MetaOutput * out,
+    const NvDsMetaRecord * rec, gboolean track, guint64 * num_files,
+    guint64 * num_errors)
+{
+  int left, top, right, bottom;
+
+  if (rec->is_frame) {
+    gchar path[1024];
+
+    if (out->file)
+      fclose (out->file);
+    g_snprintf (path, sizeof (path), "%s/%02u_%03u_%06lu.txt", out->dir,
+        writer->instance, rec->source_id, (gulong) rec->frame_num);
+    out->file = fopen (path, "w");
+    if (out->file)
+      (*num_files)++;
+    else
+      (*num_errors)++;
+    return;
+  }
+
+  if (!out->file)
+    return;
+
+  left = rec->left;
+  top = rec->top;
+  right = left + rec->width;
+  bottom = top + rec->height;
+  if (track) {
+    fprintf (out->file,
+        "%s %lu 0.0 0 0.0 %d.00 %d.00 %d.00 %d.00 0.0 0.0 0.0 0.0 0.0 0.0 0.0\n",
+        rec->label, (gulong) rec->object_id, left, top, right, bottom);
+  } else {
+    fprintf (out->file,
+        "%s 0.0 0 0.0 %d.00 %d.00 %d.00 %d.00 0.0 0.0 0.0 0.0 0.0 0.0 0.0\n",
+        rec->label, left, top, right, bottom);
+  }
+}
+
+static gboolean
+meta_writer_write_log (MetaOutput * out, const NvDsMetaRecord * rec)
+{
+  NvDsDetectionLogRecord record;
+
+  if (rec->is_frame)
+    return nvds_detection_log_begin_frame (out->log, rec->source_id,
+        rec->frame_num, rec->pts, rec->object_id);
+
+  memset (&record, 0, sizeof (record));
+  record.class_id = rec->class_id;
+  record.object_id = rec->object_id;
+  record.left = rec->left;
+  record.top = rec->top;
+  record.width = rec->width;
+  record.height = rec->height;
+  record.confidence = rec->confidence;
+  record.component_id = rec->component_id;
+  g_strlcpy (record.label, rec->label, sizeof (record.label));
+  return nvds_detection_log_add_object (out->log, rec->source_id, &record);
+}
+
+static void
+meta_writer_write_batch (NvDsMetaWriter * writer, NvDsMetaBatch * batch,
+    guint64 * num_files, guint64 * num_errors)
+{
+  MetaOutput *out = &writer->outputs[batch->output];
+  guint i;
+
+  for (i = 0; i < batch->num_records; i++) {
+    const NvDsMetaRecord *rec = &batch->records[i];
+
+    switch (batch->output) {
+      case NV_DS_META_OUTPUT_KITTI:
+      case NV_DS_META_OUTPUT_KITTI_TRACK:
+        meta_writer_write_kitti (writer, out, rec,
+            batch->output == NV_DS_META_OUTPUT_KITTI_TRACK, num_files,
+            num_errors);
+        break;
+      case NV_DS_META_OUTPUT_BBOX_LOG:
+      case NV_DS_META_OUTPUT_TRACK_LOG:
+      default:
+        if (out->log && !meta_writer_write_log (out, rec))
+          (*num_errors)++;
+        break;
+    }
+  }
+}
+
+static void
+meta_writer_flush (NvDsMetaWriter * writer)
+{
+  guint i;
+
+  for (i = 0; i < NV_DS_META_OUTPUT_NUM; i++) {
+    if (writer->outputs[i].file)
+      fflush (writer->outputs[i].file);
+    nvds_detection_log_flush (writer->outputs[i].log);
+  }
+}
+
+static gpointer
+meta_writer_thread (gpointer data)
+{
+  NvDsMetaWriter *writer = (NvDsMetaWriter *) data;
+  gboolean dirty = FALSE;
+  guint i;
+
+  g_mutex_lock (&writer->lock);
+  while (TRUE) {
+    NvDsMetaBatch *batch;
+    guint64 num_files = 0, num_errors = 0;
+    gint64 start;
+
+    if (writer->count == 0) {
+      if (writer->stop)
+        break;
+      /* Caught up: push out whatever stdio still buffers, then sleep. */
+      if (dirty) {
+        dirty = FALSE;
+        g_mutex_unlock (&writer->lock);
+        meta_writer_flush (writer);
+        g_mutex_lock (&writer->lock);
+        continue;
+      }
+      g_cond_wait (&writer->work_cond, &writer->lock);
+      continue;
+    }
+
+    batch = writer->queue[writer->head];
+    writer->head = (writer->head + 1) % writer->config.queue_size;
+    writer->count--;
+    g_mutex_unlock (&writer->lock);
+
+    start = g_get_monotonic_time ();
+    meta_writer_write_batch (writer, batch, &num_files, &num_errors);
+
+    g_mutex_lock (&writer->lock);
+    writer->stats.busy_us += g_get_monotonic_time () - start;
+    writer->stats.num_batches++;
+    writer->stats.num_records += batch->num_records;
+    writer->stats.num_files += num_files;
+    writer->stats.num_errors += num_errors;
+    writer->free_batches[writer->num_free++] = batch;
+    g_cond_signal (&writer->free_cond);
+    dirty = TRUE;
+  }
+  g_mutex_unlock (&writer->lock);
+
+  for (i = 0; i < NV_DS_META_OUTPUT_NUM; i++) {
+    if (writer->outputs[i].file)
+      fclose (writer->outputs[i].file);
+    writer->outputs[i].file = NULL;
+    nvds_detection_log_free (writer->outputs[i].log);
+    writer->outputs[i].log = NULL;
+  }
+  return NULL;
+}
+
+NvDsMetaWriter *
+nvds_meta_writer_new (NvDsMetaWriterConfig * config, guint instance,
+    gchar * const dirs[NV_DS_META_OUTPUT_NUM])
+{
+  NvDsMetaWriter *writer;
+  gboolean enabled = FALSE;
+  guint i;
+
+  for (i = 0; i < NV_DS_META_OUTPUT_NUM; i++)
+    enabled |= dirs[i] != NULL;
+  if (!enabled)
+    return NULL;
+
+  writer = g_malloc0 (sizeof (NvDsMetaWriter));
+  writer->config = *config;
+  if (!writer->config.queue_size)
+    writer->config.queue_size = DEFAULT_META_WRITER_QUEUE_SIZE;
+  if (!writer->config.batch_size)
+    writer->config.batch_size = DEFAULT_META_WRITER_BATCH_SIZE;
+  writer->instance = instance;
+
+  for (i = 0; i < NV_DS_META_OUTPUT_NUM; i++) {
+    writer->outputs[i].dir = g_strdup (dirs[i]);
+    if (dirs[i] && (i == NV_DS_META_OUTPUT_BBOX_LOG
+            || i == NV_DS_META_OUTPUT_TRACK_LOG))
+      writer->outputs[i].log = nvds_detection_log_new (dirs[i], instance,
+          NVDS_DETECTION_LOG_INDEX_INTERVAL);
+  }
+
+  /* Everything the streaming threads will ever fill, allocated once. */
+  writer->batches = g_new0 (NvDsMetaBatch, writer->config.queue_size);
+  writer->records = g_new0 (NvDsMetaRecord,
+      (gsize) writer->config.queue_size * writer->config.batch_size);
+  writer->free_batches = g_new (NvDsMetaBatch *, writer->config.queue_size);
+  writer->queue = g_new (NvDsMetaBatch *, writer->config.queue_size);
+  for (i = 0; i < writer->config.queue_size; i++) {
+    writer->batches[i].capacity = writer->config.batch_size;
+    writer->batches[i].records =
+        &writer->records[(gsize) i * writer->config.batch_size];
+    writer->free_batches[i] = &writer->batches[i];
+  }
+  writer->num_free = writer->config.queue_size;
+  writer->stats.queue_size = writer->config.queue_size;
+
+  g_mutex_init (&writer->lock);
+  g_cond_init (&writer->work_cond);
+  g_cond_init (&writer->free_cond);
+  writer->thread = g_thread_new ("nvds-metawriter", meta_writer_thread,
+      writer);
+  return writer;
+}
+
+void
+nvds_meta_writer_free (NvDsMetaWriter * writer)
+{
+  guint i;
+
+  if (!writer)
+    return;
+
+  g_mutex_lock (&writer->lock);
+  writer->stop = TRUE;
+  g_cond_signal (&writer->work_cond);
+  g_cond_broadcast (&writer->free_cond);
+  g_mutex_unlock (&writer->lock);
+  g_thread_join (writer->thread);
+
+  g_mutex_clear (&writer->lock);
+  g_cond_clear (&writer->work_cond);
+  g_cond_clear (&writer->free_cond);
+  for (i = 0; i < NV_DS_META_OUTPUT_NUM; i++)
+    g_free (writer->outputs[i].dir);
+  g_free (writer->queue);
+  g_free (writer->free_batches);
+  g_free (writer->records);
+  g_free (writer->batches);
+  g_free (writer);
+}
+
+gboolean
+nvds_meta_writer_has_output (NvDsMetaWriter * writer, NvDsMetaOutput output)
+{
+  return writer && writer->outputs[output].dir != NULL;
+}
+
+NvDsMetaBatch *
+nvds_meta_writer_acquire (NvDsMetaWriter * writer, NvDsMetaOutput output)
+{
+  NvDsMetaBatch *batch;
+  guint64 num_dropped = 0;
+
+  g_mutex_lock (&writer->lock);
+  while (writer->num_free == 0) {
+    gint64 start;
+
+    if (writer->config.overflow_policy != NV_DS_META_WRITER_BLOCK
+        || writer->stop) {
+      gint64 now = g_get_monotonic_time ();
+
+      writer->stats.num_dropped++;
+      if (writer->config.overflow_policy == NV_DS_META_WRITER_DROP
+          && now - writer->last_warning >= G_TIME_SPAN_SECOND) {
+        writer->last_warning = now;
+        num_dropped = writer->stats.num_dropped;
+      }
+      g_mutex_unlock (&writer->lock);
+      if (num_dropped)
+        g_printerr ("meta writer: queue full, dropping metadata "
+            "(%" G_GUINT64_FORMAT " batches so far)\n", num_dropped);
+      return NULL;
+    }
+
+    start = g_get_monotonic_time ();
+    g_cond_wait (&writer->free_cond, &writer->lock);
+    writer->stats.blocked_us += g_get_monotonic_time () - start;
+  }
+  batch = writer->free_batches[--writer->num_free];
+  g_mutex_unlock (&writer->lock);
+
+  batch->output = output;
+  batch->num_records = 0;
+  return batch;
+}
+
+NvDsMetaRecord *
+nvds_meta_writer_append (NvDsMetaWriter * writer, NvDsMetaBatch ** batch)
+{
+  if (!*batch)
+    return NULL;
+
+  if ((*batch)->num_records == (*batch)->capacity) {
+    NvDsMetaOutput output = (*batch)->output;
+    nvds_meta_writer_submit (writer, *batch);
+    *batch = nvds_meta_writer_acquire (writer, output);
+    if (!*batch)
+      return NULL;
+  }
+  return &(*batch)->records[(*batch)->num_records++];
+}
+
+void
+nvds_meta_writer_submit (NvDsMetaWriter * writer, NvDsMetaBatch * batch)
+{
+  if (!batch)
+    return;
+
+  g_mutex_lock (&writer->lock);
+  if (batch->num_records == 0) {
+    writer->free_batches[writer->num_free++] = batch;
+    g_cond_signal (&writer->free_cond);
+  } else {
+    writer->queue[(writer->head + writer->count) %
+        writer->config.queue_size] = batch;
+    writer->count++;
+    if (writer->count > writer->stats.max_queue_depth)
+      writer->stats.max_queue_depth = writer->count;
+    g_cond_signal (&writer->work_cond);
+  }
+  g_mutex_unlock (&writer->lock);
+}
+
+void
+nvds_meta_writer_drain (NvDsMetaWriter * writer)
+{
+  if (!writer)
+    return;
+
+  g_mutex_lock (&writer->lock);
+  while (writer->num_free < writer->config.queue_size)
+    g_cond_wait (&writer->free_cond, &writer->lock);
+  g_mutex_unlock (&writer->lock);
+}
+
+void
+nvds_meta_writer_get_stats (NvDsMetaWriter * writer,
+    NvDsMetaWriterStats * stats)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  memset (stats, 0, sizeof (NvDsMetaWriterStats));
+  if (!writer)
+    return;
+
+  g_mutex_lock (&writer->lock);
+  *stats = writer->stats;
+  stats->queue_depth = writer->count;
+  if (writer->rate_time && now > writer->rate_time)
+    stats->records_per_sec = (writer->stats.num_records -
+        writer->rate_records) * 1e6 / (now - writer->rate_time);
+  writer->rate_time = now;
+  writer->rate_records = writer->stats.num_records;
+  g_mutex_unlock (&writer->lock);
+}
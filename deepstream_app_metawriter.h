@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_METAWRITER_H__
+#define __NVGSTDS_APP_METAWRITER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+/** Same as MAX_LABEL_SIZE of the DeepStream metadata. */
+#define NVDS_META_WRITER_LABEL_SIZE 128
+
+typedef enum
+{
+  /** Per-frame KITTI files (gie-kitti-output-dir). */
+  NV_DS_META_OUTPUT_KITTI = 0,
+  /** Per-frame KITTI files with tracker ids (kitti-track-output-dir). */
+  NV_DS_META_OUTPUT_KITTI_TRACK,
+  /** Binary detection log (gie-detection-log-dir). */
+  NV_DS_META_OUTPUT_BBOX_LOG,
+  /** Binary detection log after the tracker (track-detection-log-dir). */
+  NV_DS_META_OUTPUT_TRACK_LOG,
+  NV_DS_META_OUTPUT_NUM
+} NvDsMetaOutput;
+
+typedef enum
+{
+  /** Wait for the writer; nothing is lost but the pipeline may stall. */
+  NV_DS_META_WRITER_BLOCK = 0,
+  /** Discard the new batch and warn (at most once per second). */
+  NV_DS_META_WRITER_DROP,
+  /** Discard the new batch silently; only the counters show it. */
+  NV_DS_META_WRITER_COUNT,
+} NvDsMetaWriterPolicy;
+
+typedef struct
+{
+  /** Batches that may wait for the writer, all preallocated. */
+  guint queue_size;
+  /** Records per batch. */
+  guint batch_size;
+  NvDsMetaWriterPolicy overflow_policy;
+} NvDsMetaWriterConfig;
+
+/** Copy of one frame or object, taken on the streaming thread. */
+typedef struct
+{
+  guint source_id;
+  /** A frame record opens a frame; its object fields are unused. */
+  gboolean is_frame;
+  guint64 frame_num;
+  guint64 pts;
+  /** Tracker id of an object; number of objects on a frame record. */
+  guint64 object_id;
+  gint class_id;
+  guint component_id;
+  gfloat left;
+  gfloat top;
+  gfloat width;
+  gfloat height;
+  gfloat confidence;
+  gchar label[NVDS_META_WRITER_LABEL_SIZE];
+} NvDsMetaRecord;
+
+typedef struct
+{
+  NvDsMetaOutput output;
+  guint num_records;
+  guint capacity;
+  NvDsMetaRecord *records;
+} NvDsMetaBatch;
+
+typedef struct
+{
+  guint queue_depth;
+  guint max_queue_depth;
+  guint queue_size;
+  guint64 num_batches;
+  guint64 num_records;
+  guint64 num_files;
+  guint64 num_dropped;
+  guint64 num_errors;
+  /** Time the streaming threads spent waiting for a free batch. */
+  guint64 blocked_us;
+  /** Time the writer spent on file I/O. */
+  guint64 busy_us;
+  /** Records written per second since the previous call. */
+  gdouble records_per_sec;
+} NvDsMetaWriterStats;
+
+typedef struct _NvDsMetaWriter NvDsMetaWriter;
+
+/**
+ * Start the writer thread for processing instance @instance. @dirs holds
+ * the output directory of every NvDsMetaOutput, NULL for the disabled
+ * ones; outputs are opened and written on the writer thread only.
+ *
+ * @return NULL if every output is disabled.
+ */
+NvDsMetaWriter *nvds_meta_writer_new (NvDsMetaWriterConfig * config,
+    guint instance, gchar * const dirs[NV_DS_META_OUTPUT_NUM]);
+
+/**
+ * Write everything still queued, stop the thread and close all files.
+ */
+void nvds_meta_writer_free (NvDsMetaWriter * writer);
+
+gboolean nvds_meta_writer_has_output (NvDsMetaWriter * writer,
+    NvDsMetaOutput output);
+
+/**
+ * Take an empty batch for @output. When all batches are queued the
+ * overflow policy decides between waiting and returning NULL.
+ */
+NvDsMetaBatch *nvds_meta_writer_acquire (NvDsMetaWriter * writer,
+    NvDsMetaOutput output);
+
+/**
+ * Reserve the next record of *@batch. A full batch is submitted and
+ * replaced by a fresh one for the same output.
+ *
+ * @return NULL (with *@batch set to NULL) if no batch could be had.
+ */
+NvDsMetaRecord *nvds_meta_writer_append (NvDsMetaWriter * writer,
+    NvDsMetaBatch ** batch);
+
+/**
+ * Queue @batch for writing; it must not be touched afterwards.
+ */
+void nvds_meta_writer_submit (NvDsMetaWriter * writer, NvDsMetaBatch * batch);
+
+/**
+ * Wait until every submitted batch is written. Only call this once no
+ * probe holds a batch any more, e.g. after the pipeline has stopped.
+ */
+void nvds_meta_writer_drain (NvDsMetaWriter * writer);
+
+void nvds_meta_writer_get_stats (NvDsMetaWriter * writer,
+    NvDsMetaWriterStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,736 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "deepstream_app_metrics.h"
+
+#define DEFAULT_METRICS_PORT 9464
+#define METRICS_REQUEST_SIZE 4096
+#define METRICS_CLIENT_TIMEOUT_SEC 1
+
+typedef union
+{
+  guint64 u;
+  gdouble d;
+} MetricSlot;
+
+typedef enum
+{
+  METRIC_SHARD_LIVE = 0,
+  /** The owning thread exited; the next scrape folds and frees it. */
+  METRIC_SHARD_RETIRED,
+  /** The registry is gone; the owning thread frees the shard. */
+  METRIC_SHARD_CLOSED,
+} MetricShardState;
+
+/** Counter and histogram slots of every family, written by one thread. */
+typedef struct
+{
+  gint generation;
+  gint state;
+  MetricSlot *slots;
+} MetricShard;
+
+struct _NvDsMetric
+{
+  NvDsMetrics *metrics;
+  gchar *name;
+  gchar *help;
+  NvDsMetricType type;
+  gchar *label_name;
+  guint num_cells;
+  /** NULL entries are labelled with their index. */
+  gchar **cell_labels;
+  gdouble *bounds;
+  guint num_bounds;
+  /** Shard slots of cell 0; counters use one per cell, histograms one per
+   * bucket plus sum and count. */
+  guint slot_offset;
+  guint slots_per_cell;
+  /** Gauge values, or sampled counter totals, by cell. */
+  gdouble *values;
+  gboolean *is_set;
+};
+
+struct _NvDsMetrics
+{
+  GPtrArray *families;
+  guint num_slots;
+  /** Per slot: TRUE for histogram sums, which add up as doubles. */
+  gboolean *double_slots;
+  gint generation;
+
+  GMutex lock;
+  GPtrArray *shards;
+  /** Slots of shards whose thread exited. */
+  MetricSlot *retired;
+
+  GMutex collect_lock;
+  NvDsMetricsCollectFunc collect_func;
+  gpointer collect_data;
+
+  gint listen_fd;
+  gint wake_fds[2];
+  gchar *unix_socket;
+  GThread *thread;
+  NvDsMetricsStats stats;
+};
+
+static void metric_shard_release (gpointer data);
+
+static GPrivate metric_shard_key = G_PRIVATE_INIT (metric_shard_release);
+static gint metrics_last_generation;
+
+static const gchar *metric_type_names[] = { "counter", "gauge", "histogram" };
+
+NvDsMetrics *
+nvds_metrics_new (void)
+{
+  NvDsMetrics *metrics = g_malloc0 (sizeof (NvDsMetrics));
+
+  metrics->families = g_ptr_array_new ();
+  metrics->shards = g_ptr_array_new ();
+  metrics->listen_fd = -1;
+  metrics->wake_fds[0] = metrics->wake_fds[1] = -1;
+  g_mutex_init (&metrics->lock);
+  g_mutex_init (&metrics->collect_lock);
+  return metrics;
+}
+
+static NvDsMetric *
+metrics_add_family (NvDsMetrics * metrics, const gchar * name,
+    const gchar * help, NvDsMetricType type, const gchar * label_name,
+    guint num_cells)
+{
+  NvDsMetric *metric;
+
+  if (metrics->generation) {
+    g_printerr ("metrics: %s added after start, ignored\n", name);
+    return NULL;
+  }
+
+  metric = g_malloc0 (sizeof (NvDsMetric));
+  metric->metrics = metrics;
+  metric->name = g_strdup (name);
+  metric->help = g_strdup (help);
+  metric->type = type;
+  metric->label_name = g_strdup (label_name);
+  metric->num_cells = MAX (num_cells, 1);
+  metric->cell_labels = g_malloc0 ((metric->num_cells + 1) * sizeof (gchar *));
+  metric->values = g_malloc0 (metric->num_cells * sizeof (gdouble));
+  metric->is_set = g_malloc0 (metric->num_cells * sizeof (gboolean));
+  g_ptr_array_add (metrics->families, metric);
+  return metric;
+}
+
+NvDsMetric *
+nvds_metrics_add (NvDsMetrics * metrics, const gchar * name,
+    const gchar * help, NvDsMetricType type, const gchar * label_name,
+    guint num_cells)
+{
+  NvDsMetric *metric;
+
+  if (type == NV_DS_METRIC_HISTOGRAM)
+    return NULL;
+
+  metric = metrics_add_family (metrics, name, help, type, label_name,
+      num_cells);
+  if (metric && type == NV_DS_METRIC_COUNTER) {
+    metric->slot_offset = metrics->num_slots;
+    metric->slots_per_cell = 1;
+    metrics->num_slots += metric->num_cells;
+  }
+  return metric;
+}
+
+NvDsMetric *
+nvds_metrics_add_histogram (NvDsMetrics * metrics, const gchar * name,
+    const gchar * help, const gchar * label_name, guint num_cells,
+    const gdouble * bounds, guint num_bounds)
+{
+  NvDsMetric *metric;
+
+  if (num_bounds > NVDS_METRICS_MAX_BOUNDS)
+    return NULL;
+
+  metric = metrics_add_family (metrics, name, help, NV_DS_METRIC_HISTOGRAM,
+      label_name, num_cells);
+  if (!metric)
+    return NULL;
+
+  metric->bounds = g_memdup (bounds, num_bounds * sizeof (gdouble));
+  metric->num_bounds = num_bounds;
+  metric->slot_offset = metrics->num_slots;
+  /* Buckets up to +Inf, then sum and count. */
+  metric->slots_per_cell = num_bounds + 3;
+  metrics->num_slots += metric->num_cells * metric->slots_per_cell;
+  return metric;
+}
+
+void
+nvds_metric_set_cell_label (NvDsMetric * metric, guint cell,
+    const gchar * label)
+{
+  if (!metric || cell >= metric->num_cells)
+    return;
+  g_free (metric->cell_labels[cell]);
+  metric->cell_labels[cell] = g_strdup (label);
+}
+
+void
+nvds_metrics_set_collect_func (NvDsMetrics * metrics,
+    NvDsMetricsCollectFunc func, gpointer user_data)
+{
+  /* Waits for a scrape in progress, so the old callback's data can go. */
+  g_mutex_lock (&metrics->collect_lock);
+  metrics->collect_func = func;
+  metrics->collect_data = user_data;
+  g_mutex_unlock (&metrics->collect_lock);
+}
+
+static void
+metric_shard_free (MetricShard * shard)
+{
+  g_free (shard->slots);
+  g_free (shard);
+}
+
+static void
+metric_shard_release (gpointer data)
+{
+  MetricShard *shard = (MetricShard *) data;
+
+  if (!g_atomic_int_compare_and_exchange (&shard->state, METRIC_SHARD_LIVE,
+          METRIC_SHARD_RETIRED))
+    metric_shard_free (shard);
+}
+
+static MetricShard *
+metrics_get_shard (NvDsMetrics * metrics)
+{
+  MetricShard *shard = g_private_get (&metric_shard_key);
+
+  if (G_LIKELY (shard && shard->generation == metrics->generation))
+    return shard;
+  if (!metrics->generation)
+    return NULL;
+
+  shard = g_malloc0 (sizeof (MetricShard));
+  shard->generation = metrics->generation;
+  shard->slots = g_malloc0 (MAX (metrics->num_slots, 1) * sizeof (MetricSlot));
+
+  g_mutex_lock (&metrics->lock);
+  g_ptr_array_add (metrics->shards, shard);
+  g_mutex_unlock (&metrics->lock);
+
+  /* Releases the shard of an earlier registry, if any. */
+  g_private_replace (&metric_shard_key, shard);
+  return shard;
+}
+
+void
+nvds_metric_add (NvDsMetric * metric, guint cell, guint64 value)
+{
+  MetricShard *shard;
+
+  if (!metric || cell >= metric->num_cells ||
+      metric->type != NV_DS_METRIC_COUNTER)
+    return;
+
+  shard = metrics_get_shard (metric->metrics);
+  if (shard)
+    shard->slots[metric->slot_offset + cell].u += value;
+}
+
+void
+nvds_metric_observe (NvDsMetric * metric, guint cell, gdouble value)
+{
+  MetricShard *shard;
+  MetricSlot *slots;
+  guint bucket = 0;
+
+  if (!metric || cell >= metric->num_cells ||
+      metric->type != NV_DS_METRIC_HISTOGRAM)
+    return;
+
+  shard = metrics_get_shard (metric->metrics);
+  if (!shard)
+    return;
+
+  while (bucket < metric->num_bounds && value > metric->bounds[bucket])
+    bucket++;
+
+  slots = shard->slots + metric->slot_offset + cell * metric->slots_per_cell;
+  slots[bucket].u++;
+  slots[metric->num_bounds + 1].d += value;
+  slots[metric->num_bounds + 2].u++;
+}
+
+void
+nvds_metric_set (NvDsMetric * metric, guint cell, gdouble value)
+{
+  if (!metric || cell >= metric->num_cells ||
+      metric->type == NV_DS_METRIC_HISTOGRAM)
+    return;
+
+  metric->values[cell] = value;
+  metric->is_set[cell] = TRUE;
+}
+
+/**
+ * Sum the retired slots and every shard into @sum. Shards are read while
+ * their threads write them; a scrape may miss the latest updates but
+ * never sees a torn 64-bit slot.
+ */
+static void
+metrics_sum_shards (NvDsMetrics * metrics, MetricSlot * sum)
+{
+  guint i, j;
+
+  g_mutex_lock (&metrics->lock);
+  memcpy (sum, metrics->retired, metrics->num_slots * sizeof (MetricSlot));
+  for (i = 0; i < metrics->shards->len;) {
+    MetricShard *shard = g_ptr_array_index (metrics->shards, i);
+    gboolean retired =
+        g_atomic_int_get (&shard->state) == METRIC_SHARD_RETIRED;
+
+    for (j = 0; j < metrics->num_slots; j++) {
+      if (metrics->double_slots[j]) {
+        sum[j].d += shard->slots[j].d;
+        if (retired)
+          metrics->retired[j].d += shard->slots[j].d;
+      } else {
+        sum[j].u += shard->slots[j].u;
+        if (retired)
+          metrics->retired[j].u += shard->slots[j].u;
+      }
+    }
+    if (retired) {
+      g_ptr_array_remove_index_fast (metrics->shards, i);
+      metric_shard_free (shard);
+      continue;
+    }
+    i++;
+  }
+  g_mutex_unlock (&metrics->lock);
+}
+
+static void
+metrics_append_double (GString * out, gdouble value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  if (isinf (value))
+    g_string_append (out, value > 0 ? "+Inf" : "-Inf");
+  else if (isnan (value))
+    g_string_append (out, "NaN");
+  else
+    g_string_append (out, g_ascii_dtostr (buf, sizeof (buf), value));
+}
+
+/** Label set of @cell, with an extra "le" bucket label if @le is set. */
+static void
+metrics_append_labels (GString * out, NvDsMetric * metric, guint cell,
+    const gchar * le)
+{
+  if (!metric->label_name && !le)
+    return;
+
+  g_string_append_c (out, '{');
+  if (metric->label_name) {
+    if (metric->cell_labels[cell])
+      g_string_append_printf (out, "%s=\"%s\"", metric->label_name,
+          metric->cell_labels[cell]);
+    else
+      g_string_append_printf (out, "%s=\"%u\"", metric->label_name, cell);
+    if (le)
+      g_string_append_c (out, ',');
+  }
+  if (le)
+    g_string_append_printf (out, "le=\"%s\"", le);
+  g_string_append_c (out, '}');
+}
+
+static void
+metrics_render_histogram (GString * out, NvDsMetric * metric, guint cell,
+    const MetricSlot * slots)
+{
+  gchar le[G_ASCII_DTOSTR_BUF_SIZE];
+  guint64 cumulative = 0;
+  guint i;
+
+  for (i = 0; i <= metric->num_bounds; i++) {
+    cumulative += slots[i].u;
+    if (i < metric->num_bounds)
+      g_ascii_dtostr (le, sizeof (le), metric->bounds[i]);
+    else
+      g_strlcpy (le, "+Inf", sizeof (le));
+    g_string_append_printf (out, "%s_bucket", metric->name);
+    metrics_append_labels (out, metric, cell, le);
+    g_string_append_printf (out, " %" G_GUINT64_FORMAT "\n", cumulative);
+  }
+  g_string_append_printf (out, "%s_sum", metric->name);
+  metrics_append_labels (out, metric, cell, NULL);
+  g_string_append_c (out, ' ');
+  metrics_append_double (out, slots[metric->num_bounds + 1].d);
+  g_string_append_printf (out, "\n%s_count", metric->name);
+  metrics_append_labels (out, metric, cell, NULL);
+  g_string_append_printf (out, " %" G_GUINT64_FORMAT "\n",
+      slots[metric->num_bounds + 2].u);
+}
+
+void
+nvds_metrics_render (NvDsMetrics * metrics, GString * out)
+{
+  MetricSlot *sum = g_malloc0 (MAX (metrics->num_slots, 1) *
+      sizeof (MetricSlot));
+  guint i, cell;
+
+  if (metrics->retired)
+    metrics_sum_shards (metrics, sum);
+
+  for (i = 0; i < metrics->families->len; i++) {
+    NvDsMetric *metric = g_ptr_array_index (metrics->families, i);
+
+    g_string_append_printf (out, "# HELP %s %s\n# TYPE %s %s\n",
+        metric->name, metric->help, metric->name,
+        metric_type_names[metric->type]);
+
+    for (cell = 0; cell < metric->num_cells; cell++) {
+      const MetricSlot *slots =
+          sum + metric->slot_offset + cell * metric->slots_per_cell;
+
+      /* Unnamed cells show up once they have been used; histograms only
+       * once they hold a sample, whatever their label. */
+      switch (metric->type) {
+        case NV_DS_METRIC_COUNTER:
+          if (!slots[0].u && !metric->is_set[cell] &&
+              !metric->cell_labels[cell])
+            continue;
+          g_string_append (out, metric->name);
+          metrics_append_labels (out, metric, cell, NULL);
+          g_string_append_c (out, ' ');
+          metrics_append_double (out, slots[0].u + metric->values[cell]);
+          g_string_append_c (out, '\n');
+          break;
+        case NV_DS_METRIC_GAUGE:
+          if (!metric->is_set[cell])
+            continue;
+          g_string_append (out, metric->name);
+          metrics_append_labels (out, metric, cell, NULL);
+          g_string_append_c (out, ' ');
+          metrics_append_double (out, metric->values[cell]);
+          g_string_append_c (out, '\n');
+          break;
+        case NV_DS_METRIC_HISTOGRAM:
+          if (!slots[metric->num_bounds + 2].u)
+            continue;
+          metrics_render_histogram (out, metric, cell, slots);
+          break;
+      }
+    }
+  }
+  g_free (sum);
+}
+
+static gboolean
+metrics_write_all (gint fd, const gchar * data, gsize len)
+{
+  while (len) {
+    gssize ret = send (fd, data, len, MSG_NOSIGNAL);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0)
+      return FALSE;
+    data += ret;
+    len -= ret;
+  }
+  return TRUE;
+}
+
+static void
+metrics_serve_client (NvDsMetrics * metrics, gint fd)
+{
+  struct timeval timeout = { METRICS_CLIENT_TIMEOUT_SEC, 0 };
+  gchar request[METRICS_REQUEST_SIZE];
+  gsize len = 0;
+  GString *body, *response;
+  gboolean found, written;
+  gint64 start;
+
+  setsockopt (fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+  setsockopt (fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout));
+
+  /* Only the request line matters; read until the headers end. */
+  while (len < sizeof (request) - 1) {
+    gssize ret = recv (fd, request + len, sizeof (request) - 1 - len, 0);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0)
+      break;
+    len += ret;
+    request[len] = '\0';
+    if (strstr (request, "\r\n\r\n") || strstr (request, "\n\n"))
+      break;
+  }
+  request[len] = '\0';
+
+  start = g_get_monotonic_time ();
+  found = g_str_has_prefix (request, "GET /metrics ") ||
+      g_str_has_prefix (request, "GET / ");
+  body = g_string_new (NULL);
+  if (found) {
+    g_mutex_lock (&metrics->collect_lock);
+    if (metrics->collect_func)
+      metrics->collect_func (metrics, metrics->collect_data);
+    nvds_metrics_render (metrics, body);
+    g_mutex_unlock (&metrics->collect_lock);
+  } else {
+    g_string_append (body, "not found\n");
+  }
+
+  response = g_string_new (NULL);
+  g_string_append_printf (response, "HTTP/1.0 %s\r\n"
+      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+      "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+      "Connection: close\r\n\r\n",
+      found ? "200 OK" : "404 Not Found", body->len);
+  g_string_append_len (response, body->str, body->len);
+
+  written = metrics_write_all (fd, response->str, response->len);
+
+  /* Read by nvds_metrics_get_stats() under the same lock. */
+  g_mutex_lock (&metrics->collect_lock);
+  if (!written || !found)
+    metrics->stats.num_errors++;
+  else
+    metrics->stats.num_scrapes++;
+  metrics->stats.last_scrape_us = g_get_monotonic_time () - start;
+  g_mutex_unlock (&metrics->collect_lock);
+
+  g_string_free (response, TRUE);
+  g_string_free (body, TRUE);
+}
+
+static gpointer
+metrics_thread (gpointer data)
+{
+  NvDsMetrics *metrics = (NvDsMetrics *) data;
+  struct pollfd fds[2];
+
+  fds[0].fd = metrics->listen_fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = metrics->wake_fds[0];
+  fds[1].events = POLLIN;
+
+  while (TRUE) {
+    gint fd;
+
+    if (poll (fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (fds[1].revents)
+      break;
+    if (!(fds[0].revents & POLLIN))
+      continue;
+
+    fd = accept (metrics->listen_fd, NULL, NULL);
+    if (fd < 0)
+      continue;
+    metrics_serve_client (metrics, fd);
+    close (fd);
+  }
+  return NULL;
+}
+
+static gint
+metrics_listen (NvDsMetricsConfig * config)
+{
+  gint fd, one = 1;
+
+  if (config->unix_socket) {
+    struct sockaddr_un addr;
+
+    if (strlen (config->unix_socket) >= sizeof (addr.sun_path)) {
+      g_printerr ("metrics: socket path %s too long\n", config->unix_socket);
+      return -1;
+    }
+    memset (&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    g_strlcpy (addr.sun_path, config->unix_socket, sizeof (addr.sun_path));
+    fd = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+      goto error;
+    unlink (config->unix_socket);
+    if (bind (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0)
+      goto error;
+  } else {
+    struct sockaddr_in addr;
+
+    memset (&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+    addr.sin_port = htons (config->port ? config->port : DEFAULT_METRICS_PORT);
+    fd = socket (AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+      goto error;
+    setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+    if (bind (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0)
+      goto error;
+  }
+  if (listen (fd, 4) < 0)
+    goto error;
+  return fd;
+
+error:
+  g_printerr ("metrics: cannot listen on %s: %s\n",
+      config->unix_socket ? config->unix_socket : "127.0.0.1",
+      strerror (errno));
+  if (fd >= 0)
+    close (fd);
+  return -1;
+}
+
+gboolean
+nvds_metrics_start (NvDsMetrics * metrics, NvDsMetricsConfig * config)
+{
+  guint i, cell;
+
+  if (metrics->generation)
+    return TRUE;
+
+  metrics->retired = g_malloc0 (MAX (metrics->num_slots, 1) *
+      sizeof (MetricSlot));
+  metrics->double_slots = g_malloc0 (MAX (metrics->num_slots, 1) *
+      sizeof (gboolean));
+  for (i = 0; i < metrics->families->len; i++) {
+    NvDsMetric *metric = g_ptr_array_index (metrics->families, i);
+    if (metric->type != NV_DS_METRIC_HISTOGRAM)
+      continue;
+    for (cell = 0; cell < metric->num_cells; cell++)
+      metrics->double_slots[metric->slot_offset +
+          cell * metric->slots_per_cell + metric->num_bounds + 1] = TRUE;
+  }
+  metrics->generation = g_atomic_int_add (&metrics_last_generation, 1) + 1;
+
+  metrics->listen_fd = metrics_listen (config);
+  if (metrics->listen_fd < 0)
+    return FALSE;
+  if (pipe (metrics->wake_fds) < 0) {
+    g_printerr ("metrics: pipe failed: %s\n", strerror (errno));
+    return FALSE;
+  }
+  metrics->unix_socket = g_strdup (config->unix_socket);
+  metrics->thread = g_thread_new ("nvds-metrics", metrics_thread, metrics);
+
+  if (config->unix_socket)
+    g_print ("metrics: serving on %s\n", config->unix_socket);
+  else
+    g_print ("metrics: serving on http://127.0.0.1:%u/metrics\n",
+        config->port ? config->port : DEFAULT_METRICS_PORT);
+  return TRUE;
+}
+
+static void
+metric_free (NvDsMetric * metric)
+{
+  guint cell;
+
+  for (cell = 0; cell < metric->num_cells; cell++)
+    g_free (metric->cell_labels[cell]);
+  g_free (metric->cell_labels);
+  g_free (metric->name);
+  g_free (metric->help);
+  g_free (metric->label_name);
+  g_free (metric->bounds);
+  g_free (metric->values);
+  g_free (metric->is_set);
+  g_free (metric);
+}
+
+void
+nvds_metrics_free (NvDsMetrics * metrics)
+{
+  guint i;
+
+  if (!metrics)
+    return;
+
+  if (metrics->thread) {
+    if (write (metrics->wake_fds[1], "q", 1) != 1)
+      g_printerr ("metrics: cannot wake server: %s\n", strerror (errno));
+    g_thread_join (metrics->thread);
+  }
+  if (metrics->listen_fd >= 0)
+    close (metrics->listen_fd);
+  if (metrics->wake_fds[0] >= 0) {
+    close (metrics->wake_fds[0]);
+    close (metrics->wake_fds[1]);
+  }
+  if (metrics->unix_socket)
+    unlink (metrics->unix_socket);
+  g_free (metrics->unix_socket);
+
+  /* Threads that are still alive own their shard from now on. */
+  for (i = 0; i < metrics->shards->len; i++) {
+    MetricShard *shard = g_ptr_array_index (metrics->shards, i);
+    if (!g_atomic_int_compare_and_exchange (&shard->state, METRIC_SHARD_LIVE,
+            METRIC_SHARD_CLOSED))
+      metric_shard_free (shard);
+  }
+  g_ptr_array_free (metrics->shards, TRUE);
+
+  for (i = 0; i < metrics->families->len; i++)
+    metric_free (g_ptr_array_index (metrics->families, i));
+  g_ptr_array_free (metrics->families, TRUE);
+
+  g_mutex_clear (&metrics->lock);
+  g_mutex_clear (&metrics->collect_lock);
+  g_free (metrics->retired);
+  g_free (metrics->double_slots);
+  g_free (metrics);
+}
+
+void
+nvds_metrics_get_stats (NvDsMetrics * metrics, NvDsMetricsStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsMetricsStats));
+  if (!metrics)
+    return;
+
+  g_mutex_lock (&metrics->collect_lock);
+  *stats = metrics->stats;
+  g_mutex_unlock (&metrics->collect_lock);
+  g_mutex_lock (&metrics->lock);
+  stats->num_shards = metrics->shards->len;
+  g_mutex_unlock (&metrics->lock);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_METRICS_H__
+#define __NVGSTDS_APP_METRICS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+/** Most bucket bounds a histogram may have, +Inf not included. */
+#define NVDS_METRICS_MAX_BOUNDS 32
+
+typedef enum
+{
+  NV_DS_METRIC_COUNTER = 0,
+  NV_DS_METRIC_GAUGE,
+  NV_DS_METRIC_HISTOGRAM,
+} NvDsMetricType;
+
+typedef struct
+{
+  gboolean enable;
+  /** TCP port on 127.0.0.1, used when unix_socket is not set. */
+  guint port;
+  /** Serve on this Unix socket path instead of TCP. */
+  gchar *unix_socket;
+} NvDsMetricsConfig;
+
+typedef struct
+{
+  guint64 num_scrapes;
+  guint64 num_errors;
+  guint num_shards;
+  /** Time the last scrape spent collecting and rendering. */
+  guint64 last_scrape_us;
+} NvDsMetricsStats;
+
+typedef struct _NvDsMetrics NvDsMetrics;
+typedef struct _NvDsMetric NvDsMetric;
+
+/**
+ * Called on the server thread before every scrape, to set gauges and
+ * counters that are sampled from other modules' stats.
+ */
+typedef void (*NvDsMetricsCollectFunc) (NvDsMetrics * metrics,
+    gpointer user_data);
+
+NvDsMetrics *nvds_metrics_new (void);
+
+/**
+ * Register a family of @num_cells counters or gauges, told apart by
+ * label @label_name (NULL for a single unlabelled value). Cells are
+ * labelled with their index unless named with nvds_metric_set_cell_label().
+ * Families can only be added before nvds_metrics_start().
+ */
+NvDsMetric *nvds_metrics_add (NvDsMetrics * metrics, const gchar * name,
+    const gchar * help, NvDsMetricType type, const gchar * label_name,
+    guint num_cells);
+
+/**
+ * Register a family of histograms with @num_bounds ascending bucket upper
+ * bounds; values above the last one land in the +Inf bucket.
+ */
+NvDsMetric *nvds_metrics_add_histogram (NvDsMetrics * metrics,
+    const gchar * name, const gchar * help, const gchar * label_name,
+    guint num_cells, const gdouble * bounds, guint num_bounds);
+
+void nvds_metric_set_cell_label (NvDsMetric * metric, guint cell,
+    const gchar * label);
+
+void nvds_metrics_set_collect_func (NvDsMetrics * metrics,
+    NvDsMetricsCollectFunc func, gpointer user_data);
+
+/**
+ * Freeze the families and start serving GET /metrics in the Prometheus
+ * text format.
+ *
+ * @return FALSE if the listener could not be set up.
+ */
+gboolean nvds_metrics_start (NvDsMetrics * metrics,
+    NvDsMetricsConfig * config);
+
+/**
+ * Stop the server and free everything. No thread may update a metric
+ * any more.
+ */
+void nvds_metrics_free (NvDsMetrics * metrics);
+
+/**
+ * Add @value to counter @cell. Every thread writes its own shard without
+ * locks or atomics; a scrape sums the shards. NULL @metric is a no-op.
+ */
+void nvds_metric_add (NvDsMetric * metric, guint cell, guint64 value);
+
+/**
+ * Record @value in histogram @cell, on the calling thread's shard.
+ */
+void nvds_metric_observe (NvDsMetric * metric, guint cell, gdouble value);
+
+/**
+ * Set gauge @cell, or the sampled total of counter @cell. Each cell must
+ * have a single writer.
+ */
+void nvds_metric_set (NvDsMetric * metric, guint cell, gdouble value);
+
+/**
+ * Append the current values of every family to @out.
+ */
+void nvds_metrics_render (NvDsMetrics * metrics, GString * out);
+
+void nvds_metrics_get_stats (NvDsMetrics * metrics, NvDsMetricsStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
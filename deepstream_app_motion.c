@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#define MOTION_GATE_SSE2 1
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+#include <arm_neon.h>
+#define MOTION_GATE_NEON 1
+#endif
+
+#include "deepstream_app_motion.h"
+#include "deepstream_app_log.h"
+
+/* Pixels summed per step; cell sides are multiples of it. */
+#define MOTION_GROUP 8
+
+typedef struct
+{
+  /** Mean luma per cell of the current frame and of the frame the primary
+   * GIE last ran on. */
+  guint8 *cells;
+  guint8 *ref;
+  guint cells_x;
+  guint cells_y;
+  gboolean has_ref;
+  /** The current frame was downscaled into cells. */
+  gboolean valid;
+  gboolean want;
+  /** Frames skipped since the primary GIE last ran. */
+  guint skipped;
+  guint64 frame_num;
+  /** Low bits of the last frame the gate let through, -1 for none, and
+   * whether the primary GIE skipped it anyway; atomic. */
+  gint requested;
+  gint stale;
+} MotionSource;
+
+struct _NvDsMotionGate
+{
+  NvDsMotionGateConfig config;
+  guint num_sources;
+  MotionSource *sources;
+  /** Sources given since the last end_batch, in batch order. */
+  guint *pending;
+  guint num_pending;
+  /** Column sums of one row of cells. */
+  guint32 *groups;
+  guint max_groups;
+  NvDsMotionGateStats stats;
+  /** Written by nvds_motion_gate_result(); atomic. */
+  gint num_missed;
+  /** Config handed over by nvds_motion_gate_set_config(). */
+  GMutex lock;
+  gint config_pending;
+  NvDsMotionGateConfig next;
+};
+
+static guint64
+motion_now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (guint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+motion_load_config (NvDsMotionGate * gate, NvDsMotionGateConfig * config)
+{
+  gate->config = *config;
+  gate->config.cell_size = CLAMP (config->cell_size / MOTION_GROUP *
+      MOTION_GROUP, MOTION_GROUP, NVDS_MOTION_GATE_MAX_CELL);
+  gate->config.pixel_threshold = MIN (config->pixel_threshold, 255);
+}
+
+NvDsMotionGate *
+nvds_motion_gate_new (NvDsMotionGateConfig * config, guint num_sources)
+{
+  NvDsMotionGate *gate;
+  guint i;
+
+  if (!config->enable)
+    return NULL;
+
+  gate = g_new0 (NvDsMotionGate, 1);
+  motion_load_config (gate, config);
+  g_mutex_init (&gate->lock);
+  gate->num_sources = MAX (num_sources, 1);
+  gate->sources = g_new0 (MotionSource, gate->num_sources);
+  gate->pending = g_new0 (guint, gate->num_sources);
+  for (i = 0; i < gate->num_sources; i++)
+    gate->sources[i].requested = -1;
+
+  NVDS_LOG_INFO ("motion gate: %ux%u cells, change > %u on %.1f%% of them, "
+      "forced every %u frames, %s", gate->config.cell_size,
+      gate->config.cell_size, gate->config.pixel_threshold,
+      gate->config.threshold, gate->config.force_interval,
+#if defined (MOTION_GATE_SSE2)
+      gate->config.simd ? "SSE2" : "scalar");
+#elif defined (MOTION_GATE_NEON)
+      gate->config.simd ? "NEON" : "scalar");
+#else
+      "scalar");
+#endif
+  return gate;
+}
+
+void
+nvds_motion_gate_free (NvDsMotionGate * gate)
+{
+  guint i;
+
+  if (!gate)
+    return;
+
+  for (i = 0; i < gate->num_sources; i++) {
+    g_free (gate->sources[i].cells);
+    g_free (gate->sources[i].ref);
+  }
+  g_free (gate->sources);
+  g_free (gate->pending);
+  g_free (gate->groups);
+  g_mutex_clear (&gate->lock);
+  g_free (gate);
+}
+
+void
+nvds_motion_gate_set_config (NvDsMotionGate * gate,
+    NvDsMotionGateConfig * config)
+{
+  if (!gate)
+    return;
+
+  g_mutex_lock (&gate->lock);
+  gate->next = *config;
+  g_atomic_int_set (&gate->config_pending, TRUE);
+  g_mutex_unlock (&gate->lock);
+}
+
+static void
+motion_apply_pending (NvDsMotionGate * gate)
+{
+  guint cell_size = gate->config.cell_size;
+  guint i;
+
+  g_mutex_lock (&gate->lock);
+  motion_load_config (gate, &gate->next);
+  g_atomic_int_set (&gate->config_pending, FALSE);
+  g_mutex_unlock (&gate->lock);
+
+  /* Cells of the old size cannot be compared with the new ones. */
+  if (gate->config.cell_size != cell_size) {
+    for (i = 0; i < gate->num_sources; i++)
+      gate->sources[i].has_ref = FALSE;
+  }
+}
+
+/**
+ * Add the sums of each run of MOTION_GROUP pixels of @rows rows to
+ * @groups.
+ */
+static void
+sum_groups_scalar (const guint8 * src, guint pitch, guint rows,
+    guint num_groups, guint32 * groups)
+{
+  guint r, g, k;
+
+  for (r = 0; r < rows; r++) {
+    const guint8 *p = src + (gsize) r *pitch;
+
+    for (g = 0; g < num_groups; g++, p += MOTION_GROUP) {
+      guint32 sum = 0;
+
+      for (k = 0; k < MOTION_GROUP; k++)
+        sum += p[k];
+      groups[g] += sum;
+    }
+  }
+}
+
+#if defined (MOTION_GATE_SSE2)
+static void
+sum_groups_simd (const guint8 * src, guint pitch, guint rows,
+    guint num_groups, guint32 * groups)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  guint r, g;
+
+  /* PSADBW against zero sums each half of a 16 byte load. */
+  for (g = 0; g + 2 <= num_groups; g += 2) {
+    const guint8 *p = src + g * MOTION_GROUP;
+    __m128i acc = zero;
+
+    for (r = 0; r < rows; r++, p += pitch)
+      acc = _mm_add_epi64 (acc,
+          _mm_sad_epu8 (_mm_loadu_si128 ((const __m128i *) p), zero));
+    groups[g] += _mm_cvtsi128_si32 (acc);
+    groups[g + 1] += _mm_cvtsi128_si32 (_mm_srli_si128 (acc, 8));
+  }
+  if (g < num_groups) {
+    const guint8 *p = src + g * MOTION_GROUP;
+    __m128i acc = zero;
+
+    for (r = 0; r < rows; r++, p += pitch)
+      acc = _mm_add_epi64 (acc,
+          _mm_sad_epu8 (_mm_loadl_epi64 ((const __m128i *) p), zero));
+    groups[g] += _mm_cvtsi128_si32 (acc);
+  }
+}
+
+static guint
+count_changed_simd (const guint8 * a, const guint8 * b, guint n,
+    guint threshold)
+{
+  const __m128i thr = _mm_set1_epi8 ((gchar) threshold);
+  const __m128i zero = _mm_setzero_si128 ();
+  guint changed = 0;
+  guint i;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    __m128i va = _mm_loadu_si128 ((const __m128i *) (a + i));
+    __m128i vb = _mm_loadu_si128 ((const __m128i *) (b + i));
+    __m128i diff = _mm_or_si128 (_mm_subs_epu8 (va, vb),
+        _mm_subs_epu8 (vb, va));
+    /* Saturates to zero unless diff > threshold. */
+    gint same = _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_subs_epu8 (diff, thr),
+            zero));
+
+    changed += 16 - __builtin_popcount (same);
+  }
+  for (; i < n; i++)
+    changed += (guint) ABS ((gint) a[i] - (gint) b[i]) > threshold;
+  return changed;
+}
+#elif defined (MOTION_GATE_NEON)
+static void
+sum_groups_simd (const guint8 * src, guint pitch, guint rows,
+    guint num_groups, guint32 * groups)
+{
+  guint r, g;
+
+  /* Pairwise widening adds; lanes 0-1 and 2-3 end up as the two groups. */
+  for (g = 0; g + 2 <= num_groups; g += 2) {
+    const guint8 *p = src + g * MOTION_GROUP;
+    uint32x4_t acc = vdupq_n_u32 (0);
+
+    for (r = 0; r < rows; r++, p += pitch)
+      acc = vpadalq_u16 (acc, vpaddlq_u8 (vld1q_u8 (p)));
+    groups[g] += vgetq_lane_u32 (acc, 0) + vgetq_lane_u32 (acc, 1);
+    groups[g + 1] += vgetq_lane_u32 (acc, 2) + vgetq_lane_u32 (acc, 3);
+  }
+  if (g < num_groups) {
+    const guint8 *p = src + g * MOTION_GROUP;
+    uint32x2_t acc = vdup_n_u32 (0);
+
+    for (r = 0; r < rows; r++, p += pitch)
+      acc = vpadal_u16 (acc, vpaddl_u8 (vld1_u8 (p)));
+    groups[g] += vget_lane_u32 (acc, 0) + vget_lane_u32 (acc, 1);
+  }
+}
+
+static guint
+count_changed_simd (const guint8 * a, const guint8 * b, guint n,
+    guint threshold)
+{
+  const uint8x16_t thr = vdupq_n_u8 (threshold);
+  guint changed = 0;
+  guint i;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    uint8x16_t diff = vabdq_u8 (vld1q_u8 (a + i), vld1q_u8 (b + i));
+
+    changed += vaddvq_u8 (vshrq_n_u8 (vcgtq_u8 (diff, thr), 7));
+  }
+  for (; i < n; i++)
+    changed += (guint) ABS ((gint) a[i] - (gint) b[i]) > threshold;
+  return changed;
+}
+#endif
+
+static guint
+count_changed_scalar (const guint8 * a, const guint8 * b, guint n,
+    guint threshold)
+{
+  guint changed = 0;
+  guint i;
+
+  for (i = 0; i < n; i++)
+    changed += (guint) ABS ((gint) a[i] - (gint) b[i]) > threshold;
+  return changed;
+}
+
+/**
+ * Mean of every cell x cell square of @luma; the right and bottom
+ * remainders are left out.
+ */
+static void
+downscale (NvDsMotionGate * gate, MotionSource * src, const guint8 * luma,
+    guint pitch)
+{
+  guint cell = gate->config.cell_size;
+  guint per_cell = cell / MOTION_GROUP;
+  guint num_groups = src->cells_x * per_cell;
+  guint area = cell * cell;
+  guint x, y, k;
+
+  if (num_groups > gate->max_groups) {
+    gate->groups = g_renew (guint32, gate->groups, num_groups);
+    gate->max_groups = num_groups;
+  }
+
+  for (y = 0; y < src->cells_y; y++) {
+    const guint8 *row = luma + (gsize) y *cell * pitch;
+    guint8 *out = src->cells + y * src->cells_x;
+    guint32 *groups = gate->groups;
+
+    memset (groups, 0, num_groups * sizeof (guint32));
+#if defined (MOTION_GATE_SSE2) || defined (MOTION_GATE_NEON)
+    if (gate->config.simd)
+      sum_groups_simd (row, pitch, cell, num_groups, groups);
+    else
+#endif
+      sum_groups_scalar (row, pitch, cell, num_groups, groups);
+
+    for (x = 0; x < src->cells_x; x++, groups += per_cell) {
+      guint32 sum = 0;
+
+      for (k = 0; k < per_cell; k++)
+        sum += groups[k];
+      out[x] = (sum + area / 2) / area;
+    }
+  }
+}
+
+static guint
+count_changed (NvDsMotionGate * gate, MotionSource * src)
+{
+  guint n = src->cells_x * src->cells_y;
+
+#if defined (MOTION_GATE_SSE2) || defined (MOTION_GATE_NEON)
+  if (gate->config.simd)
+    return count_changed_simd (src->cells, src->ref, n,
+        gate->config.pixel_threshold);
+#endif
+  return count_changed_scalar (src->cells, src->ref, n,
+      gate->config.pixel_threshold);
+}
+
+gboolean
+nvds_motion_gate_frame (NvDsMotionGate * gate, guint source_id,
+    guint64 frame_num, const guint8 * luma, guint width, guint height,
+    guint pitch, gdouble * change)
+{
+  NvDsMotionGateConfig *config = &gate->config;
+  MotionSource *src;
+  gdouble changed = 100;
+  guint64 start;
+  guint cells_x, cells_y;
+  gboolean stale;
+
+  if (change)
+    *change = changed;
+  if (source_id >= gate->num_sources)
+    return TRUE;
+
+  /* Between batches only, so a batch is judged with one config. */
+  if (gate->num_pending == 0 && g_atomic_int_get (&gate->config_pending))
+    motion_apply_pending (gate);
+
+  src = &gate->sources[source_id];
+  src->frame_num = frame_num;
+  src->want = TRUE;
+  src->valid = FALSE;
+  gate->pending[gate->num_pending++ % gate->num_sources] = source_id;
+  gate->stats.num_frames++;
+
+  cells_x = width / config->cell_size;
+  cells_y = height / config->cell_size;
+  if (!luma || cells_x == 0 || cells_y == 0) {
+    if (!gate->stats.num_unreadable)
+      NVDS_LOG_WARN ("motion gate: no luma plane to read on source %u, "
+          "its frames always run the primary GIE", source_id);
+    gate->stats.num_unreadable++;
+    return TRUE;
+  }
+
+  /* New source, or the streammux output size changed. */
+  if (cells_x != src->cells_x || cells_y != src->cells_y) {
+    src->cells = g_renew (guint8, src->cells, cells_x * cells_y);
+    src->ref = g_renew (guint8, src->ref, cells_x * cells_y);
+    src->cells_x = cells_x;
+    src->cells_y = cells_y;
+    src->has_ref = FALSE;
+  }
+
+  start = motion_now_ns ();
+  downscale (gate, src, luma, pitch);
+  if (src->has_ref) {
+    changed = 100.0 * count_changed (gate, src) / (cells_x * cells_y);
+    gate->stats.max_change = MAX (gate->stats.max_change, changed);
+  }
+  gate->stats.busy_ns += motion_now_ns () - start;
+  src->valid = TRUE;
+  if (change)
+    *change = changed;
+
+  stale = g_atomic_int_compare_and_exchange (&src->stale, 1, 0);
+  if (!src->has_ref || changed > config->threshold) {
+    gate->stats.num_moving++;
+  } else if (stale || (config->force_interval &&
+          src->skipped + 1 >= config->force_interval)) {
+    gate->stats.num_forced++;
+  } else {
+    src->want = FALSE;
+  }
+  return src->want;
+}
+
+gboolean
+nvds_motion_gate_end_batch (NvDsMotionGate * gate)
+{
+  gboolean run = FALSE;
+  guint num_pending = MIN (gate->num_pending, gate->num_sources);
+  guint i;
+
+  for (i = 0; i < num_pending; i++)
+    run |= gate->sources[gate->pending[i]].want;
+
+  for (i = 0; i < num_pending; i++) {
+    MotionSource *src = &gate->sources[gate->pending[i]];
+
+    if (!run) {
+      src->skipped++;
+      continue;
+    }
+    if (src->valid) {
+      guint8 *tmp = src->ref;
+
+      src->ref = src->cells;
+      src->cells = tmp;
+    }
+    src->has_ref = src->valid;
+    src->skipped = 0;
+    g_atomic_int_set (&src->requested, (gint) (src->frame_num & G_MAXINT));
+  }
+  gate->num_pending = 0;
+
+  if (run)
+    gate->stats.num_batches_run++;
+  else
+    gate->stats.num_batches_gated++;
+  return run;
+}
+
+void
+nvds_motion_gate_result (NvDsMotionGate * gate, guint source_id,
+    guint64 frame_num, gboolean inferred)
+{
+  MotionSource *src;
+
+  if (inferred || source_id >= gate->num_sources)
+    return;
+
+  src = &gate->sources[source_id];
+  if (g_atomic_int_get (&src->requested) == (gint) (frame_num & G_MAXINT)) {
+    g_atomic_int_set (&src->stale, 1);
+    g_atomic_int_inc (&gate->num_missed);
+  }
+}
+
+void
+nvds_motion_gate_get_stats (NvDsMotionGate * gate,
+    NvDsMotionGateStats * stats)
+{
+  *stats = gate->stats;
+  stats->num_missed = g_atomic_int_get (&gate->num_missed);
+}
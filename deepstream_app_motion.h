@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_MOTION_H__
+#define __NVGSTDS_APP_MOTION_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+/** Largest cell side. */
+#define NVDS_MOTION_GATE_MAX_CELL 64
+
+typedef struct
+{
+  gboolean enable;
+  /** Side of the square of luma pixels averaged into one cell; a multiple
+   * of 8 up to NVDS_MOTION_GATE_MAX_CELL. */
+  guint cell_size;
+  /** Change of a cell's mean luma, 0-255, that counts it as changed. */
+  guint pixel_threshold;
+  /** Percentage of changed cells that makes a frame moving. */
+  gdouble threshold;
+  /** Let the primary GIE run on a source at least every this many frames
+   * even without motion; 0 never forces it. */
+  guint force_interval;
+  /** Use the SSE2 / NEON kernels where the build has them. */
+  gboolean simd;
+} NvDsMotionGateConfig;
+
+typedef struct
+{
+  guint64 num_frames;
+  /** Frames above the threshold. */
+  guint64 num_moving;
+  /** Frames that wanted inference only because of force_interval. */
+  guint64 num_forced;
+  /** Frames without a readable luma plane; they count as moving. */
+  guint64 num_unreadable;
+  /** Batches let through to, and held back from, the primary GIE. */
+  guint64 num_batches_run;
+  guint64 num_batches_gated;
+  /** Frames the primary GIE skipped though the gate asked for them. */
+  guint64 num_missed;
+  /** Time spent downscaling and comparing. */
+  guint64 busy_ns;
+  /** Largest percentage of changed cells seen. */
+  gdouble max_change;
+} NvDsMotionGateStats;
+
+typedef struct _NvDsMotionGate NvDsMotionGate;
+
+/**
+ * @return NULL if the config is disabled.
+ */
+NvDsMotionGate *nvds_motion_gate_new (NvDsMotionGateConfig * config,
+    guint num_sources);
+
+void nvds_motion_gate_free (NvDsMotionGate * gate);
+
+/**
+ * Downscale the luma plane of a frame of @source_id to cells and compare
+ * it with the frame the primary GIE last ran on. @luma may be NULL if the
+ * frame could not be read; the frame then counts as moving.
+ *
+ * Call for every frame of a batch, then nvds_motion_gate_end_batch(), from
+ * one streaming thread.
+ *
+ * @return TRUE if the frame wants inference; *@change, if not NULL, gets
+ * the percentage of changed cells.
+ */
+gboolean nvds_motion_gate_frame (NvDsMotionGate * gate, guint source_id,
+    guint64 frame_num, const guint8 * luma, guint width, guint height,
+    guint pitch, gdouble * change);
+
+/**
+ * Decide for the frames given since the last call: the batch runs if any
+ * of them wants inference, and then becomes the new reference of each
+ * of its sources.
+ *
+ * @return TRUE if the primary GIE should run on the batch.
+ */
+gboolean nvds_motion_gate_end_batch (NvDsMotionGate * gate);
+
+/**
+ * Report whether the primary GIE ran on a frame. A frame the gate asked
+ * for but that was skipped, because another controller raised the
+ * interval, leaves the reference stale; the next frame of the source is
+ * then forced. May be called from another thread than the two above.
+ */
+void nvds_motion_gate_result (NvDsMotionGate * gate, guint source_id,
+    guint64 frame_num, gboolean inferred);
+
+/**
+ * Take new settings from @config. Callable from any thread; the next
+ * frame applies them, and a new cell size starts every source afresh.
+ */
+void nvds_motion_gate_set_config (NvDsMotionGate * gate,
+    NvDsMotionGateConfig * config);
+
+void nvds_motion_gate_get_stats (NvDsMotionGate * gate,
+    NvDsMotionGateStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+
+#ifndef NVDS_MOTOR_NO_PYTHON
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#endif
+
+#include "deepstream_app_motor.h"
+
+#define DEFAULT_I2C_DEVICE "/dev/i2c-1"
+#define DEFAULT_I2C_ADDRESS 0x60
+#define DEFAULT_LEFT_CHANNEL 1
+#define DEFAULT_RIGHT_CHANNEL 2
+#define DEFAULT_VERTICAL_CHANNEL 3
+
+/* PCA9685 registers, as used by the Adafruit motor HAT on the jetbot. */
+#define PCA9685_MODE1 0x00
+#define PCA9685_MODE2 0x01
+#define PCA9685_PRESCALE 0xFE
+#define PCA9685_LED0_ON_L 0x06
+#define PCA9685_ALL_LED_ON_L 0xFA
+#define PCA9685_MODE1_ALLCALL 0x01
+#define PCA9685_MODE1_AI 0x20
+#define PCA9685_MODE1_SLEEP 0x10
+#define PCA9685_MODE2_OUTDRV 0x04
+#define PCA9685_OSC_HZ 25000000.0
+#define MOTOR_HAT_PWM_HZ 1600.0
+#define PCA9685_FULL 4096
+
+#define MAX_COMMAND_LEN 128
+
+struct _NvDsMotor
+{
+  NvDsMotorBackendType backend;
+  gint fd;
+  guint i2c_address;
+  guint channels[3];
+  GMutex lock;
+  NvDsMotorStats stats;
+};
+
+enum
+{
+  MOTOR_LEFT = 0,
+  MOTOR_RIGHT,
+  MOTOR_VERTICAL,
+};
+
+const gchar *
+nvds_motor_backend_name (NvDsMotorBackendType backend)
+{
+  switch (backend) {
+    case NV_DS_MOTOR_BACKEND_PYTHON:
+      return "python";
+    case NV_DS_MOTOR_BACKEND_I2C:
+      return "i2c";
+    case NV_DS_MOTOR_BACKEND_FILE:
+      return "file";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * Each DC motor on the HAT uses three consecutive PCA9685 channels:
+ * speed PWM plus the two H-bridge inputs. Returns the first of the three and
+ * the position of each role within the block.
+ */
+static guint
+motor_hat_channel_block (guint motor, guint * pwm, guint * in1, guint * in2)
+{
+  switch (motor) {
+    case 1:
+      *pwm = 0; *in2 = 1; *in1 = 2;
+      return 8;
+    case 2:
+      *pwm = 2; *in2 = 1; *in1 = 0;
+      return 11;
+    case 3:
+      *pwm = 0; *in2 = 1; *in1 = 2;
+      return 2;
+    case 4:
+    default:
+      *pwm = 2; *in2 = 1; *in1 = 0;
+      return 5;
+  }
+}
+
+static void
+pca9685_fill_channel (guint8 * regs, guint on, guint off)
+{
+  regs[0] = on & 0xFF;
+  regs[1] = (on >> 8) & 0xFF;
+  regs[2] = off & 0xFF;
+  regs[3] = (off >> 8) & 0xFF;
+}
+
+static gboolean
+pca9685_write (NvDsMotor * motor, const guint8 * data, gsize len)
+{
+  return write (motor->fd, data, len) == (gssize) len;
+}
+
+static gboolean
+pca9685_write_reg (NvDsMotor * motor, guint8 reg, guint8 value)
+{
+  guint8 data[2] = { reg, value };
+  return pca9685_write (motor, data, sizeof (data));
+}
+
+static gboolean
+pca9685_init (NvDsMotor * motor)
+{
+  guint8 all_off[5] = { PCA9685_ALL_LED_ON_L, 0, 0, 0, 0 };
+  guint8 prescale;
+  guint8 mode1;
+
+  prescale = (guint8) floor (PCA9685_OSC_HZ / 4096.0 / MOTOR_HAT_PWM_HZ - 1.0
+      + 0.5);
+  mode1 = PCA9685_MODE1_ALLCALL | PCA9685_MODE1_AI;
+
+  if (!pca9685_write (motor, all_off, sizeof (all_off)) ||
+      !pca9685_write_reg (motor, PCA9685_MODE2, PCA9685_MODE2_OUTDRV) ||
+      !pca9685_write_reg (motor, PCA9685_MODE1, mode1 | PCA9685_MODE1_SLEEP) ||
+      !pca9685_write_reg (motor, PCA9685_PRESCALE, prescale) ||
+      !pca9685_write_reg (motor, PCA9685_MODE1, mode1)) {
+    return FALSE;
+  }
+  /* Oscillator needs up to 500us to come out of sleep; wait 5 ms as the
+   * jetbot (Adafruit) driver does. */
+  g_usleep (5000);
+  return TRUE;
+}
+
+/**
+ * Program speed and direction of one motor with a single auto-increment
+ * transfer covering its three channels.
+ */
+static gboolean
+i2c_set_motor (NvDsMotor * motor, guint role, gdouble value)
+{
+  guint8 data[1 + 3 * 4];
+  guint pwm, in1, in2, first;
+  guint duty;
+
+  first = motor_hat_channel_block (motor->channels[role], &pwm, &in1, &in2);
+  duty = (guint) (CLAMP (fabs (value), 0.0, 1.0) * 255) * 16;
+
+  data[0] = PCA9685_LED0_ON_L + 4 * first;
+  pca9685_fill_channel (&data[1 + 4 * pwm], 0, duty);
+  if (value > 0) {
+    pca9685_fill_channel (&data[1 + 4 * in1], PCA9685_FULL, 0);
+    pca9685_fill_channel (&data[1 + 4 * in2], 0, PCA9685_FULL);
+  } else if (value < 0) {
+    pca9685_fill_channel (&data[1 + 4 * in1], 0, PCA9685_FULL);
+    pca9685_fill_channel (&data[1 + 4 * in2], PCA9685_FULL, 0);
+  } else {
+    pca9685_fill_channel (&data[1 + 4 * in1], 0, PCA9685_FULL);
+    pca9685_fill_channel (&data[1 + 4 * in2], 0, PCA9685_FULL);
+  }
+  return pca9685_write (motor, data, sizeof (data));
+}
+
+static gboolean
+file_write_command (NvDsMotor * motor, const gchar * command)
+{
+  gsize len = strlen (command);
+  return write (motor->fd, command, len) == (gssize) len;
+}
+
+#ifndef NVDS_MOTOR_NO_PYTHON
+/* Called from the actuator thread as well as the main one. */
+static gboolean
+python_run (const gchar * command)
+{
+  PyGILState_STATE state = PyGILState_Ensure ();
+  gboolean ret = PyRun_SimpleString (command) == 0;
+
+  PyGILState_Release (state);
+  return ret;
+}
+#endif
+
+static gboolean
+motor_issue (NvDsMotor * motor, guint role_mask, gdouble left, gdouble right,
+    gdouble vertical)
+{
+  gchar command[MAX_COMMAND_LEN];
+  gboolean ret = FALSE;
+  gint64 start, latency;
+
+  if (!motor)
+    return FALSE;
+
+  g_mutex_lock (&motor->lock);
+  start = g_get_monotonic_time ();
+
+  switch (motor->backend) {
+    case NV_DS_MOTOR_BACKEND_I2C:
+      ret = TRUE;
+      if (role_mask & (1 << MOTOR_LEFT))
+        ret &= i2c_set_motor (motor, MOTOR_LEFT, left);
+      if (role_mask & (1 << MOTOR_RIGHT))
+        ret &= i2c_set_motor (motor, MOTOR_RIGHT, right);
+      if (role_mask & (1 << MOTOR_VERTICAL))
+        ret &= i2c_set_motor (motor, MOTOR_VERTICAL, vertical);
+      break;
+    case NV_DS_MOTOR_BACKEND_FILE:
+      if (role_mask & (1 << MOTOR_VERTICAL)) {
+        g_snprintf (command, sizeof (command), "%" G_GINT64_FORMAT
+            " vertical %.3f\n", start, vertical);
+      } else {
+        g_snprintf (command, sizeof (command), "%" G_GINT64_FORMAT
+            " drive %.3f %.3f\n", start, left, right);
+      }
+      ret = file_write_command (motor, command);
+      break;
+#ifndef NVDS_MOTOR_NO_PYTHON
+    case NV_DS_MOTOR_BACKEND_PYTHON:
+      if (role_mask & (1 << MOTOR_VERTICAL)) {
+        if (vertical > 0)
+          g_snprintf (command, sizeof (command), "_nvds_robot.up(%f)\n",
+              vertical);
+        else if (vertical < 0)
+          g_snprintf (command, sizeof (command), "_nvds_robot.down(%f)\n",
+              -vertical);
+        else
+          g_snprintf (command, sizeof (command),
+              "_nvds_robot.vertical_motors_stop()\n");
+      } else {
+        g_snprintf (command, sizeof (command),
+            "_nvds_robot.set_motors(%f, %f)\n", left, right);
+      }
+      ret = python_run (command);
+      break;
+#endif
+    default:
+      break;
+  }
+
+  latency = g_get_monotonic_time () - start;
+  motor->stats.num_commands++;
+  if (!ret)
+    motor->stats.num_failed++;
+  motor->stats.total_latency_us += latency;
+  if ((guint64) latency > motor->stats.max_latency_us)
+    motor->stats.max_latency_us = latency;
+  g_mutex_unlock (&motor->lock);
+
+  return ret;
+}
+
+NvDsMotor *
+nvds_motor_open (NvDsMotorConfig * config)
+{
+  NvDsMotor *motor = NULL;
+  const gchar *device = config->device;
+
+  if (!config->enable)
+    return NULL;
+
+  motor = g_malloc0 (sizeof (NvDsMotor));
+  motor->backend = config->backend;
+  motor->fd = -1;
+  motor->i2c_address =
+      config->i2c_address ? config->i2c_address : DEFAULT_I2C_ADDRESS;
+  motor->channels[MOTOR_LEFT] =
+      config->left_channel ? config->left_channel : DEFAULT_LEFT_CHANNEL;
+  motor->channels[MOTOR_RIGHT] =
+      config->right_channel ? config->right_channel : DEFAULT_RIGHT_CHANNEL;
+  motor->channels[MOTOR_VERTICAL] =
+      config->vertical_channel ? config->vertical_channel :
+      DEFAULT_VERTICAL_CHANNEL;
+  g_mutex_init (&motor->lock);
+
+  switch (motor->backend) {
+    case NV_DS_MOTOR_BACKEND_I2C:
+      if (!device)
+        device = DEFAULT_I2C_DEVICE;
+      motor->fd = open (device, O_RDWR);
+      if (motor->fd < 0) {
+        g_printerr ("motor: cannot open %s: %s\n", device, strerror (errno));
+        goto error;
+      }
+      if (ioctl (motor->fd, I2C_SLAVE, motor->i2c_address) < 0) {
+        g_printerr ("motor: cannot select i2c address 0x%02x: %s\n",
+            motor->i2c_address, strerror (errno));
+        goto error;
+      }
+      if (!pca9685_init (motor)) {
+        g_printerr ("motor: PCA9685 init failed on %s\n", device);
+        goto error;
+      }
+      break;
+    case NV_DS_MOTOR_BACKEND_FILE:
+      if (!device) {
+        g_printerr ("motor: file backend needs a device path\n");
+        goto error;
+      }
+      motor->fd = open (device, O_WRONLY | O_CREAT | O_APPEND | O_NOCTTY,
+          0644);
+      if (motor->fd < 0) {
+        g_printerr ("motor: cannot open %s: %s\n", device, strerror (errno));
+        goto error;
+      }
+      break;
+    case NV_DS_MOTOR_BACKEND_PYTHON:
+#ifndef NVDS_MOTOR_NO_PYTHON
+      /* Import jetbot and build the Robot once; every later command only
+       * calls a method on the cached instance. */
+      if (!python_run ("from jetbot import Robot\n"
+              "_nvds_robot = Robot()\n")) {
+        g_printerr ("motor: cannot create jetbot Robot\n");
+        goto error;
+      }
+      break;
+#else
+      g_printerr ("motor: python backend not built in\n");
+      goto error;
+#endif
+    default:
+      goto error;
+  }
+
+  g_print ("motor: %s backend ready\n",
+      nvds_motor_backend_name (motor->backend));
+  return motor;
+
+error:
+  nvds_motor_close (motor);
+  return NULL;
+}
+
+void
+nvds_motor_close (NvDsMotor * motor)
+{
+  if (!motor)
+    return;
+
+  if (motor->fd >= 0) {
+    if (motor->backend == NV_DS_MOTOR_BACKEND_I2C) {
+      i2c_set_motor (motor, MOTOR_LEFT, 0);
+      i2c_set_motor (motor, MOTOR_RIGHT, 0);
+      i2c_set_motor (motor, MOTOR_VERTICAL, 0);
+    }
+    close (motor->fd);
+  }
+  g_mutex_clear (&motor->lock);
+  g_free (motor);
+}
+
+gboolean
+nvds_motor_drive (NvDsMotor * motor, gdouble left, gdouble right)
+{
+  return motor_issue (motor, (1 << MOTOR_LEFT) | (1 << MOTOR_RIGHT),
+      CLAMP (left, -1.0, 1.0), CLAMP (right, -1.0, 1.0), 0);
+}
+
+gboolean
+nvds_motor_turn (NvDsMotor * motor, gdouble speed)
+{
+  return nvds_motor_drive (motor, speed, -speed);
+}
+
+gboolean
+nvds_motor_stop (NvDsMotor * motor)
+{
+  return nvds_motor_drive (motor, 0, 0);
+}
+
+gboolean
+nvds_motor_vertical (NvDsMotor * motor, gdouble speed)
+{
+  return motor_issue (motor, 1 << MOTOR_VERTICAL, 0, 0,
+      CLAMP (speed, -1.0, 1.0));
+}
+
+void
+nvds_motor_get_stats (NvDsMotor * motor, NvDsMotorStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsMotorStats));
+  if (!motor)
+    return;
+
+  g_mutex_lock (&motor->lock);
+  *stats = motor->stats;
+  g_mutex_unlock (&motor->lock);
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_MOTOR_H__
+#define __NVGSTDS_APP_MOTOR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+typedef enum
+{
+  /** Legacy path: jetbot.Robot through the embedded Python interpreter. */
+  NV_DS_MOTOR_BACKEND_PYTHON = 0,
+  /** PCA9685 motor HAT driven directly over /dev/i2c-N. */
+  NV_DS_MOTOR_BACKEND_I2C,
+  /** Text commands written to a file, FIFO or pty. No hardware required. */
+  NV_DS_MOTOR_BACKEND_FILE,
+} NvDsMotorBackendType;
+
+typedef struct
+{
+  gboolean enable;
+  NvDsMotorBackendType backend;
+  /** i2c device node for NV_DS_MOTOR_BACKEND_I2C, output path for
+   * NV_DS_MOTOR_BACKEND_FILE. */
+  gchar *device;
+  guint i2c_address;
+  guint left_channel;
+  guint right_channel;
+  guint vertical_channel;
+} NvDsMotorConfig;
+
+typedef struct
+{
+  guint64 num_commands;
+  guint64 num_failed;
+  guint64 total_latency_us;
+  guint64 max_latency_us;
+} NvDsMotorStats;
+
+typedef struct _NvDsMotor NvDsMotor;
+
+/**
+ * Open the motor driver selected by @config. The returned handle keeps the
+ * device open until nvds_motor_close() and may be shared between threads.
+ *
+ * @return NULL if the backend could not be initialized.
+ */
+NvDsMotor *nvds_motor_open (NvDsMotorConfig * config);
+
+void nvds_motor_close (NvDsMotor * motor);
+
+/**
+ * Set wheel speeds in [-1.0, 1.0]. The call returns as soon as the command
+ * has been handed to the driver; motors keep running until the next command.
+ */
+gboolean nvds_motor_drive (NvDsMotor * motor, gdouble left, gdouble right);
+
+/**
+ * Spin in place. Positive @speed turns right, negative turns left.
+ */
+gboolean nvds_motor_turn (NvDsMotor * motor, gdouble speed);
+
+gboolean nvds_motor_stop (NvDsMotor * motor);
+
+/**
+ * Drive the camera lift motor. Positive @speed moves up, 0 stops it.
+ */
+gboolean nvds_motor_vertical (NvDsMotor * motor, gdouble speed);
+
+void nvds_motor_get_stats (NvDsMotor * motor, NvDsMotorStats * stats);
+
+const gchar *nvds_motor_backend_name (NvDsMotorBackendType backend);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+
+#include "deepstream_app_pantilt.h"
+#include "deepstream_app_servo.h"
+
+typedef struct
+{
+  gdouble kp;
+  gdouble ki;
+  gdouble home;
+  gdouble min;
+  gdouble max;
+  gdouble integral;
+  gdouble position;
+  gint output;
+} PanTiltAxis;
+
+struct _NvDsPanTilt
+{
+  PanTiltAxis pan;
+  PanTiltAxis tilt;
+  gdouble deadband;
+  gdouble max_slew;
+  NvDsPanTiltStats stats;
+  /** Config handed over by nvds_pantilt_set_config(). */
+  GMutex lock;
+  gint pending;
+  NvDsPanTiltConfig next;
+};
+
+static void
+pantilt_axis_init (PanTiltAxis * axis, gdouble kp, gdouble ki, gint home,
+    guint id)
+{
+  axis->kp = kp;
+  axis->ki = ki;
+  axis->home = nvds_servo_clamp (id, home);
+  axis->min = nvds_servo_clamp (id, 0);
+  axis->max = nvds_servo_clamp (id, 4095);
+  axis->integral = 0;
+  axis->position = axis->home;
+  axis->output = (gint) axis->home;
+}
+
+NvDsPanTilt *
+nvds_pantilt_new (NvDsPanTiltConfig * config)
+{
+  NvDsPanTilt *ctrl;
+
+  if (!config->enable)
+    return NULL;
+
+  ctrl = g_malloc0 (sizeof (NvDsPanTilt));
+  pantilt_axis_init (&ctrl->pan, config->pan_kp, config->pan_ki,
+      config->pan_home, NVDS_SERVO_PAN_ID);
+  pantilt_axis_init (&ctrl->tilt, config->tilt_kp, config->tilt_ki,
+      config->tilt_home, NVDS_SERVO_TILT_ID);
+  ctrl->deadband = config->deadband;
+  ctrl->max_slew = config->max_slew;
+  g_mutex_init (&ctrl->lock);
+  return ctrl;
+}
+
+void
+nvds_pantilt_free (NvDsPanTilt * ctrl)
+{
+  if (!ctrl)
+    return;
+
+  g_mutex_clear (&ctrl->lock);
+  g_free (ctrl);
+}
+
+void
+nvds_pantilt_set_config (NvDsPanTilt * ctrl, NvDsPanTiltConfig * config)
+{
+  if (!ctrl)
+    return;
+
+  g_mutex_lock (&ctrl->lock);
+  ctrl->next = *config;
+  g_atomic_int_set (&ctrl->pending, TRUE);
+  g_mutex_unlock (&ctrl->lock);
+}
+
+/**
+ * The integral term is kept: it holds the pulse offset of the current
+ * target, which new gains do not change.
+ */
+static void
+pantilt_apply_pending (NvDsPanTilt * ctrl)
+{
+  g_mutex_lock (&ctrl->lock);
+  ctrl->pan.kp = ctrl->next.pan_kp;
+  ctrl->pan.ki = ctrl->next.pan_ki;
+  ctrl->tilt.kp = ctrl->next.tilt_kp;
+  ctrl->tilt.ki = ctrl->next.tilt_ki;
+  ctrl->deadband = ctrl->next.deadband;
+  ctrl->max_slew = ctrl->next.max_slew;
+  g_atomic_int_set (&ctrl->pending, FALSE);
+  g_mutex_unlock (&ctrl->lock);
+}
+
+void
+nvds_pantilt_reset (NvDsPanTilt * ctrl)
+{
+  if (!ctrl)
+    return;
+
+  ctrl->pan.integral = ctrl->tilt.integral = 0;
+  ctrl->pan.position = ctrl->pan.home;
+  ctrl->tilt.position = ctrl->tilt.home;
+}
+
+/**
+ * Positional PI around the home pulse: the integral term carries the
+ * steady-state offset needed to keep a stationary target centred. The
+ * integral only grows while the output is inside the servo range
+ * (conditional integration), so a target beyond the mechanical limit does
+ * not wind it up.
+ */
+static gboolean
+pantilt_axis_update (NvDsPanTilt * ctrl, PanTiltAxis * axis, gdouble err,
+    gdouble dt)
+{
+  gdouble integral, desired, step, limit;
+  gint output;
+
+  integral = axis->integral + axis->ki * err * dt;
+  desired = axis->home + axis->kp * err + integral;
+  if (desired < axis->min || desired > axis->max) {
+    desired = CLAMP (desired, axis->min, axis->max);
+    ctrl->stats.num_saturated++;
+  } else {
+    axis->integral = integral;
+  }
+
+  step = desired - axis->position;
+  limit = ctrl->max_slew * dt;
+  if (ctrl->max_slew > 0 && fabs (step) > limit) {
+    step = step > 0 ? limit : -limit;
+    ctrl->stats.num_slew_limited++;
+  }
+  axis->position += step;
+
+  output = (gint) lround (axis->position);
+  if (output == axis->output)
+    return FALSE;
+  axis->output = output;
+  return TRUE;
+}
+
+gboolean
+nvds_pantilt_update (NvDsPanTilt * ctrl, gdouble err_x, gdouble err_y,
+    gdouble dt_sec, gint * pan, gint * tilt)
+{
+  gboolean moved;
+
+  if (!ctrl)
+    return FALSE;
+
+  if (g_atomic_int_get (&ctrl->pending))
+    pantilt_apply_pending (ctrl);
+  ctrl->stats.num_updates++;
+  if (fabs (err_x) < ctrl->deadband)
+    err_x = 0;
+  if (fabs (err_y) < ctrl->deadband)
+    err_y = 0;
+  if (err_x == 0 && err_y == 0)
+    ctrl->stats.num_deadband++;
+
+  moved = pantilt_axis_update (ctrl, &ctrl->pan, err_x, dt_sec);
+  moved |= pantilt_axis_update (ctrl, &ctrl->tilt, err_y, dt_sec);
+  if (moved)
+    ctrl->stats.num_moves++;
+
+  *pan = ctrl->pan.output;
+  *tilt = ctrl->tilt.output;
+  return moved;
+}
+
+void
+nvds_pantilt_get_stats (NvDsPanTilt * ctrl, NvDsPanTiltStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsPanTiltStats));
+  if (ctrl)
+    *stats = ctrl->stats;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_PANTILT_H__
+#define __NVGSTDS_APP_PANTILT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+/**
+ * Gains act on the target offset from the image centre, normalized to
+ * [-1, 1] over half the frame, and produce servo pulses. Flip the sign of a
+ * gain if that axis moves away from the target.
+ */
+typedef struct
+{
+  gboolean enable;
+  gdouble pan_kp;
+  /** Pulses per second per unit of offset. */
+  gdouble pan_ki;
+  gdouble tilt_kp;
+  gdouble tilt_ki;
+  /** Offsets smaller than this (normalized) are treated as centred. */
+  gdouble deadband;
+  /** Largest change of either pulse target, in pulses per second. */
+  gdouble max_slew;
+  gint pan_home;
+  gint tilt_home;
+} NvDsPanTiltConfig;
+
+typedef struct
+{
+  guint64 num_updates;
+  /** Updates where both axes were inside the deadband. */
+  guint64 num_deadband;
+  guint64 num_slew_limited;
+  guint64 num_saturated;
+  /** Updates that changed a pulse target. */
+  guint64 num_moves;
+} NvDsPanTiltStats;
+
+typedef struct _NvDsPanTilt NvDsPanTilt;
+
+NvDsPanTilt *nvds_pantilt_new (NvDsPanTiltConfig * config);
+
+void nvds_pantilt_free (NvDsPanTilt * ctrl);
+
+/**
+ * Drop the integral state and start again from the home position.
+ */
+void nvds_pantilt_reset (NvDsPanTilt * ctrl);
+
+/**
+ * Take new gains, deadband and slew limit from @config; the home position
+ * stays. Callable from any thread; the next update applies them.
+ */
+void nvds_pantilt_set_config (NvDsPanTilt * ctrl,
+    NvDsPanTiltConfig * config);
+
+/**
+ * Run one control step. @err_x / @err_y are the normalized offsets of the
+ * target from the image centre (positive right / down), @dt_sec the time
+ * since the previous step. The new targets are clamped to the servo safe
+ * ranges.
+ *
+ * @return TRUE if @pan or @tilt differ from the previous targets.
+ */
+gboolean nvds_pantilt_update (NvDsPanTilt * ctrl, gdouble err_x,
+    gdouble err_y, gdouble dt_sec, gint * pan, gint * tilt);
+
+void nvds_pantilt_get_stats (NvDsPanTilt * ctrl, NvDsPanTiltStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
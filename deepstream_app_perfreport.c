@@ -0,0 +1,629 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "deepstream_app_latency.h"
+#include "deepstream_app_log.h"
+#include "deepstream_app_perfreport.h"
+
+/** Print the column header every this many console lines. */
+#define PERF_HEADER_INTERVAL 20
+/** A stream whose rates are older than this many intervals is stale. */
+#define PERF_STALE_INTERVALS 2
+
+typedef struct
+{
+  /**
+   * Sequence lock over fps, fps_avg and fps_time_us: odd while the
+   * instance is writing them, so the aggregator retries instead of
+   * blocking either side.
+   */
+  gint seq;
+  gdouble fps;
+  gdouble fps_avg;
+  gint64 fps_time_us;
+
+  /* Written by the thread that counts the stream's frames. */
+  gint64 last_frame_us;
+  guint frames;
+  guint32 buckets[NVDS_LATENCY_NUM_BUCKETS];
+
+  /* Aggregator only. */
+  guint last_frames;
+  guint64 total_frames;
+  guint32 snapshot[NVDS_LATENCY_NUM_BUCKETS];
+} PerfStream;
+
+typedef struct
+{
+  guint num_sources;
+  PerfStream *streams;
+  gint dropped;
+  /* Aggregator only. */
+  guint last_dropped;
+  guint interval_dropped;
+  guint64 total_dropped;
+} PerfInstance;
+
+typedef struct
+{
+  guint64 cpu_ticks;
+  guint64 seen;
+} PerfThread;
+
+/** Values of one stream for one report. */
+typedef struct
+{
+  guint instance;
+  guint source_id;
+  gdouble fps;
+  gdouble fps_avg;
+  guint frames;
+  guint64 total_frames;
+  guint64 num_gaps;
+  gdouble frame_ms[4];
+  gboolean stale;
+} PerfStreamReport;
+
+typedef struct
+{
+  gint tid;
+  gchar name[32];
+  gdouble cpu_ms;
+} PerfThreadReport;
+
+struct _NvDsPerfReport
+{
+  NvDsPerfReportConfig config;
+  guint interval_sec;
+  guint num_instances;
+  PerfInstance *instances;
+  guint num_streams;
+
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gboolean stop;
+
+  /* Aggregator only. */
+  FILE *file;
+  gsize file_size;
+  GHashTable *threads;
+  guint64 generation;
+  gint64 last_report_us;
+  guint num_lines;
+  glong clock_ticks;
+  guint32 counts[NVDS_LATENCY_NUM_BUCKETS];
+  GArray *thread_reports;
+  GString *out;
+
+  NvDsPerfReportStats stats;
+};
+
+static const gdouble perf_quantiles[] = { 0.50, 0.90, 0.99 };
+
+static inline PerfStream *
+perf_stream (NvDsPerfReport * report, guint instance, guint source_id)
+{
+  if (!report || instance >= report->num_instances ||
+      source_id >= report->instances[instance].num_sources)
+    return NULL;
+  return &report->instances[instance].streams[source_id];
+}
+
+void
+nvds_perf_report_set_fps (NvDsPerfReport * report, guint instance,
+    guint source_id, gdouble fps, gdouble fps_avg)
+{
+  PerfStream *stream = perf_stream (report, instance, source_id);
+
+  if (!stream)
+    return;
+
+  g_atomic_int_inc (&stream->seq);
+  stream->fps = fps;
+  stream->fps_avg = fps_avg;
+  stream->fps_time_us = g_get_monotonic_time ();
+  g_atomic_int_inc (&stream->seq);
+}
+
+void
+nvds_perf_report_frame (NvDsPerfReport * report, guint instance,
+    guint source_id, gint64 now_us)
+{
+  PerfStream *stream = perf_stream (report, instance, source_id);
+
+  if (!stream)
+    return;
+
+  /* Aligned 32-bit counters are read without tearing; the aggregator
+   * may see them a frame late, never half written. */
+  if (stream->last_frame_us && now_us > stream->last_frame_us)
+    stream->buckets[nvds_latency_bucket_index (now_us -
+            stream->last_frame_us)]++;
+  stream->last_frame_us = now_us;
+  stream->frames++;
+}
+
+void
+nvds_perf_report_dropped (NvDsPerfReport * report, guint instance,
+    guint num_dropped)
+{
+  if (!report || instance >= report->num_instances)
+    return;
+  g_atomic_int_add (&report->instances[instance].dropped, num_dropped);
+}
+
+static void
+perf_read_fps (PerfStream * stream, gdouble * fps, gdouble * fps_avg,
+    gint64 * time_us)
+{
+  gint seq;
+
+  do {
+    while ((seq = g_atomic_int_get (&stream->seq)) & 1)
+      g_thread_yield ();
+    *fps = stream->fps;
+    *fps_avg = stream->fps_avg;
+    *time_us = stream->fps_time_us;
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  } while (g_atomic_int_get (&stream->seq) != seq);
+}
+
+static void
+perf_collect_stream (NvDsPerfReport * report, PerfStream * stream,
+    gint64 now_us, PerfStreamReport * out)
+{
+  gint64 fps_time_us;
+  guint frames;
+  guint max = 0;
+  guint i;
+
+  perf_read_fps (stream, &out->fps, &out->fps_avg, &fps_time_us);
+  out->stale = !fps_time_us || now_us - fps_time_us >
+      (gint64) report->interval_sec * PERF_STALE_INTERVALS * G_USEC_PER_SEC;
+
+  frames = stream->frames;
+  out->frames = frames - stream->last_frames;
+  stream->last_frames = frames;
+  stream->total_frames += out->frames;
+  out->total_frames = stream->total_frames;
+
+  out->num_gaps = 0;
+  for (i = 0; i < NVDS_LATENCY_NUM_BUCKETS; i++) {
+    guint32 now = stream->buckets[i];
+
+    report->counts[i] = now - stream->snapshot[i];
+    stream->snapshot[i] = now;
+    if (report->counts[i]) {
+      out->num_gaps += report->counts[i];
+      max = i;
+    }
+  }
+
+  memset (out->frame_ms, 0, sizeof (out->frame_ms));
+  if (!out->num_gaps)
+    return;
+  for (i = 0; i < G_N_ELEMENTS (perf_quantiles); i++)
+    out->frame_ms[i] = nvds_latency_percentile (report->counts,
+        out->num_gaps, perf_quantiles[i]);
+  out->frame_ms[3] = nvds_latency_bucket_value (max) / 1000.0;
+}
+
+/**
+ * CPU time of every thread of the process since the previous report,
+ * from /proc/self/task/<tid>/stat. Threads that were idle are left out.
+ */
+static void
+perf_collect_threads (NvDsPerfReport * report)
+{
+  GDir *dir = g_dir_open ("/proc/self/task", 0, NULL);
+  const gchar *entry;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_array_set_size (report->thread_reports, 0);
+  if (!dir)
+    return;
+
+  report->generation++;
+  while ((entry = g_dir_read_name (dir))) {
+    gchar path[64];
+    gchar *contents = NULL;
+    gchar *comm, *fields;
+    gchar **tokens;
+    gint tid = atoi (entry);
+    guint64 ticks;
+    PerfThread *thread;
+
+    g_snprintf (path, sizeof (path), "/proc/self/task/%s/stat", entry);
+    if (!g_file_get_contents (path, &contents, NULL, NULL))
+      continue;
+
+    /* "tid (comm) state ppid ..."; comm may hold spaces and ')'. */
+    comm = strchr (contents, '(');
+    fields = strrchr (contents, ')');
+    if (!comm || !fields || fields < comm) {
+      g_free (contents);
+      continue;
+    }
+    *fields = '\0';
+    tokens = g_strsplit (fields + 2, " ", 14);
+    /* utime and stime are fields 14 and 15, i.e. 11 and 12 after comm. */
+    if (g_strv_length (tokens) < 14) {
+      g_strfreev (tokens);
+      g_free (contents);
+      continue;
+    }
+    ticks = g_ascii_strtoull (tokens[11], NULL, 10) +
+        g_ascii_strtoull (tokens[12], NULL, 10);
+    g_strfreev (tokens);
+
+    thread = g_hash_table_lookup (report->threads, GINT_TO_POINTER (tid));
+    if (!thread) {
+      thread = g_new0 (PerfThread, 1);
+      g_hash_table_insert (report->threads, GINT_TO_POINTER (tid), thread);
+    } else if (ticks > thread->cpu_ticks) {
+      PerfThreadReport out;
+
+      out.tid = tid;
+      g_strlcpy (out.name, comm + 1, sizeof (out.name));
+      out.cpu_ms = (ticks - thread->cpu_ticks) * 1000.0 /
+          report->clock_ticks;
+      g_array_append_val (report->thread_reports, out);
+    }
+    thread->cpu_ticks = ticks;
+    thread->seen = report->generation;
+    g_free (contents);
+  }
+  g_dir_close (dir);
+
+  /* Forget the threads that have exited. */
+  g_hash_table_iter_init (&iter, report->threads);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    if (((PerfThread *) value)->seen != report->generation)
+      g_hash_table_iter_remove (&iter);
+  }
+}
+
+static void
+perf_append_double (GString * out, const gchar * format, gdouble value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append (out, g_ascii_formatd (buf, sizeof (buf), format, value));
+}
+
+static void
+perf_print_console (NvDsPerfReport * report, const PerfStreamReport * streams)
+{
+  GString *line = g_string_new (NULL);
+  guint i;
+
+  if (report->num_lines++ % PERF_HEADER_INTERVAL == 0) {
+    g_string_append (line, "\n**PERF: ");
+    for (i = 0; i < report->num_streams; i++)
+      g_string_append_printf (line, "FPS %u (Avg)\t", i);
+    NVDS_LOG_INFO ("%s", line->str);
+    g_string_truncate (line, 0);
+  }
+  g_string_append (line, "**PERF: ");
+  for (i = 0; i < report->num_streams; i++)
+    g_string_append_printf (line, "%.2f (%.2f)%s\t", streams[i].fps,
+        streams[i].fps_avg, streams[i].stale ? "*" : "");
+  NVDS_LOG_INFO ("%s", line->str);
+  g_string_free (line, TRUE);
+}
+
+static void
+perf_format_csv (NvDsPerfReport * report, gdouble time_sec,
+    const PerfStreamReport * streams)
+{
+  GString *out = report->out;
+  guint i, j;
+
+  if (!report->file_size)
+    g_string_append (out, "time,kind,instance,source,fps,fps_avg,frames,"
+        "frame_ms_p50,frame_ms_p90,frame_ms_p99,frame_ms_max,stale,dropped,"
+        "tid,thread,cpu_ms,cpu_pct\n");
+
+  for (i = 0; i < report->num_streams; i++) {
+    const PerfStreamReport *s = &streams[i];
+
+    perf_append_double (out, "%.3f", time_sec);
+    g_string_append_printf (out, ",stream,%u,%u,", s->instance, s->source_id);
+    perf_append_double (out, "%.2f", s->fps);
+    g_string_append_c (out, ',');
+    perf_append_double (out, "%.2f", s->fps_avg);
+    g_string_append_printf (out, ",%u", s->frames);
+    for (j = 0; j < G_N_ELEMENTS (s->frame_ms); j++) {
+      g_string_append_c (out, ',');
+      if (s->num_gaps)
+        perf_append_double (out, "%.2f", s->frame_ms[j]);
+    }
+    g_string_append_printf (out, ",%d,,,,,\n", s->stale);
+  }
+  for (i = 0; i < report->num_instances; i++) {
+    perf_append_double (out, "%.3f", time_sec);
+    g_string_append_printf (out, ",instance,%u,,,,,,,,,,%u,,,,\n", i,
+        report->instances[i].interval_dropped);
+  }
+  for (i = 0; i < report->thread_reports->len; i++) {
+    PerfThreadReport *t =
+        &g_array_index (report->thread_reports, PerfThreadReport, i);
+    gchar *name = g_strdelimit (g_strdup (t->name), "\",", '_');
+
+    perf_append_double (out, "%.3f", time_sec);
+    g_string_append_printf (out, ",thread,,,,,,,,,,,,%d,\"%s\",", t->tid,
+        name);
+    perf_append_double (out, "%.0f", t->cpu_ms);
+    g_string_append_c (out, ',');
+    perf_append_double (out, "%.1f",
+        t->cpu_ms / 10.0 / report->interval_sec);
+    g_string_append_c (out, '\n');
+    g_free (name);
+  }
+}
+
+static void
+perf_format_json (NvDsPerfReport * report, gdouble time_sec,
+    const PerfStreamReport * streams)
+{
+  static const gchar *quantile_names[] = { "p50", "p90", "p99", "max" };
+  GString *out = report->out;
+  guint i, j;
+
+  g_string_append (out, "{\"time\":");
+  perf_append_double (out, "%.3f", time_sec);
+  g_string_append_printf (out, ",\"interval_sec\":%u,\"streams\":[",
+      report->interval_sec);
+  for (i = 0; i < report->num_streams; i++) {
+    const PerfStreamReport *s = &streams[i];
+
+    g_string_append_printf (out, "%s{\"instance\":%u,\"source\":%u,\"fps\":",
+        i ? "," : "", s->instance, s->source_id);
+    perf_append_double (out, "%.2f", s->fps);
+    g_string_append (out, ",\"fps_avg\":");
+    perf_append_double (out, "%.2f", s->fps_avg);
+    g_string_append_printf (out, ",\"frames\":%u,\"frames_total\":%"
+        G_GUINT64_FORMAT, s->frames, s->total_frames);
+    if (s->num_gaps) {
+      g_string_append (out, ",\"frame_ms\":{");
+      for (j = 0; j < G_N_ELEMENTS (s->frame_ms); j++) {
+        g_string_append_printf (out, "%s\"%s\":", j ? "," : "",
+            quantile_names[j]);
+        perf_append_double (out, "%.2f", s->frame_ms[j]);
+      }
+      g_string_append_c (out, '}');
+    }
+    g_string_append_printf (out, ",\"stale\":%s}",
+        s->stale ? "true" : "false");
+  }
+  g_string_append (out, "],\"instances\":[");
+  for (i = 0; i < report->num_instances; i++) {
+    g_string_append_printf (out, "%s{\"instance\":%u,\"dropped\":%u,"
+        "\"dropped_total\":%" G_GUINT64_FORMAT "}", i ? "," : "", i,
+        report->instances[i].interval_dropped,
+        report->instances[i].total_dropped);
+  }
+  g_string_append (out, "],\"threads\":[");
+  for (i = 0; i < report->thread_reports->len; i++) {
+    PerfThreadReport *t =
+        &g_array_index (report->thread_reports, PerfThreadReport, i);
+    gchar *name = g_strescape (t->name, NULL);
+
+    g_string_append_printf (out, "%s{\"tid\":%d,\"name\":\"%s\",\"cpu_ms\":",
+        i ? "," : "", t->tid, name);
+    perf_append_double (out, "%.0f", t->cpu_ms);
+    g_string_append (out, ",\"cpu_pct\":");
+    perf_append_double (out, "%.1f",
+        t->cpu_ms / 10.0 / report->interval_sec);
+    g_string_append_c (out, '}');
+    g_free (name);
+  }
+  g_string_append (out, "]}\n");
+}
+
+/**
+ * Roll the file once it is past max_size_mb and open it if needed.
+ */
+static gboolean
+perf_open_file (NvDsPerfReport * report)
+{
+  if (report->config.max_size_mb && report->file &&
+      report->file_size >= (gsize) report->config.max_size_mb * 1024 * 1024) {
+    gchar *rolled = g_strdup_printf ("%s.1", report->config.path);
+
+    fclose (report->file);
+    report->file = NULL;
+    if (rename (report->config.path, rolled) < 0) {
+      g_printerr ("perfreport: cannot roll %s: %s\n", report->config.path,
+          g_strerror (errno));
+      report->stats.num_errors++;
+    } else {
+      report->stats.num_rolls++;
+    }
+    g_free (rolled);
+  }
+
+  if (!report->file) {
+    report->file = fopen (report->config.path, "a");
+    if (!report->file) {
+      report->stats.num_errors++;
+      return FALSE;
+    }
+    fseek (report->file, 0, SEEK_END);
+    report->file_size = ftell (report->file);
+  }
+  return TRUE;
+}
+
+static void
+perf_write_file (NvDsPerfReport * report)
+{
+  if (fwrite (report->out->str, 1, report->out->len, report->file) !=
+      report->out->len || fflush (report->file) != 0)
+    report->stats.num_errors++;
+  report->file_size += report->out->len;
+}
+
+static void
+perf_report (NvDsPerfReport * report)
+{
+  PerfStreamReport *streams = g_new0 (PerfStreamReport, report->num_streams);
+  gint64 start_us = g_get_monotonic_time ();
+  gdouble time_sec = g_get_real_time () / (gdouble) G_USEC_PER_SEC;
+  guint i, src, n = 0;
+
+  for (i = 0; i < report->num_instances; i++) {
+    PerfInstance *inst = &report->instances[i];
+    guint dropped = (guint) g_atomic_int_get (&inst->dropped);
+
+    for (src = 0; src < inst->num_sources; src++, n++) {
+      streams[n].instance = i;
+      streams[n].source_id = src;
+      perf_collect_stream (report, &inst->streams[src], start_us,
+          &streams[n]);
+    }
+    inst->interval_dropped = dropped - inst->last_dropped;
+    inst->last_dropped = dropped;
+    inst->total_dropped += inst->interval_dropped;
+  }
+
+  perf_print_console (report, streams);
+
+  if (report->config.enable && perf_open_file (report)) {
+    perf_collect_threads (report);
+    g_string_truncate (report->out, 0);
+    if (report->config.format == NV_DS_PERF_REPORT_JSON)
+      perf_format_json (report, time_sec, streams);
+    else
+      perf_format_csv (report, time_sec, streams);
+    perf_write_file (report);
+  }
+
+  g_free (streams);
+  report->stats.num_reports++;
+  report->stats.last_report_us = g_get_monotonic_time () - start_us;
+}
+
+static gpointer
+perf_report_thread (gpointer data)
+{
+  NvDsPerfReport *report = (NvDsPerfReport *) data;
+  gint64 deadline = g_get_monotonic_time ();
+
+  g_mutex_lock (&report->lock);
+  while (!report->stop) {
+    deadline += (gint64) report->interval_sec * G_USEC_PER_SEC;
+    while (!report->stop &&
+        g_cond_wait_until (&report->cond, &report->lock, deadline));
+    if (report->stop)
+      break;
+
+    /* The lock only guards stop and the stats; the streams never take it. */
+    perf_report (report);
+  }
+  g_mutex_unlock (&report->lock);
+
+  return NULL;
+}
+
+NvDsPerfReport *
+nvds_perf_report_new (NvDsPerfReportConfig * config, guint interval_sec,
+    guint num_instances, const guint * num_sources)
+{
+  NvDsPerfReport *report = g_new0 (NvDsPerfReport, 1);
+  guint i;
+
+  report->config = *config;
+  report->config.path = g_strdup (config->path);
+  if (report->config.enable && !report->config.path) {
+    g_printerr ("perfreport: no path, writing console lines only\n");
+    report->config.enable = FALSE;
+  }
+  report->interval_sec = MAX (interval_sec, 1);
+  report->num_instances = num_instances;
+  report->instances = g_new0 (PerfInstance, num_instances);
+  for (i = 0; i < num_instances; i++) {
+    report->instances[i].num_sources = num_sources[i];
+    report->instances[i].streams = g_new0 (PerfStream, num_sources[i]);
+    report->num_streams += num_sources[i];
+  }
+  report->threads = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, g_free);
+  report->thread_reports = g_array_new (FALSE, FALSE,
+      sizeof (PerfThreadReport));
+  report->out = g_string_new (NULL);
+  report->clock_ticks = MAX (sysconf (_SC_CLK_TCK), 1);
+
+  g_mutex_init (&report->lock);
+  g_cond_init (&report->cond);
+  report->thread = g_thread_new ("nvds-perfreport", perf_report_thread,
+      report);
+  return report;
+}
+
+void
+nvds_perf_report_free (NvDsPerfReport * report)
+{
+  guint i;
+
+  if (!report)
+    return;
+
+  g_mutex_lock (&report->lock);
+  report->stop = TRUE;
+  g_cond_signal (&report->cond);
+  g_mutex_unlock (&report->lock);
+  g_thread_join (report->thread);
+
+  /* The frames since the last report. */
+  perf_report (report);
+
+  if (report->file)
+    fclose (report->file);
+  for (i = 0; i < report->num_instances; i++)
+    g_free (report->instances[i].streams);
+  g_free (report->instances);
+  g_hash_table_destroy (report->threads);
+  g_array_free (report->thread_reports, TRUE);
+  g_string_free (report->out, TRUE);
+  g_free (report->config.path);
+  g_mutex_clear (&report->lock);
+  g_cond_clear (&report->cond);
+  g_free (report);
+}
+
+void
+nvds_perf_report_get_stats (NvDsPerfReport * report,
+    NvDsPerfReportStats * stats)
+{
+  g_mutex_lock (&report->lock);
+  *stats = report->stats;
+  g_mutex_unlock (&report->lock);
+}
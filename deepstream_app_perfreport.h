@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_PERFREPORT_H__
+#define __NVGSTDS_APP_PERFREPORT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+typedef enum
+{
+  /** One row per stream, instance and busy thread per report. */
+  NV_DS_PERF_REPORT_CSV = 0,
+  /** One JSON object per report and line. */
+  NV_DS_PERF_REPORT_JSON,
+} NvDsPerfReportFormat;
+
+typedef struct
+{
+  /** Write reports to path; the console **PERF lines are always on. */
+  gboolean enable;
+  gchar *path;
+  NvDsPerfReportFormat format;
+  /** Move path to path.1 once it grows past this size; 0 never rolls. */
+  guint max_size_mb;
+} NvDsPerfReportConfig;
+
+typedef struct
+{
+  guint64 num_reports;
+  guint64 num_rolls;
+  guint64 num_errors;
+  /** Time the last report took to collect and write. */
+  guint64 last_report_us;
+} NvDsPerfReportStats;
+
+typedef struct _NvDsPerfReport NvDsPerfReport;
+
+/**
+ * Start the aggregator thread, which reports every @interval_sec on its
+ * own clock. @num_sources holds the source count of each of the
+ * @num_instances processing instances.
+ */
+NvDsPerfReport *nvds_perf_report_new (NvDsPerfReportConfig * config,
+    guint interval_sec, guint num_instances, const guint * num_sources);
+
+/**
+ * Stop the thread after a last report and close the file.
+ */
+void nvds_perf_report_free (NvDsPerfReport * report);
+
+/**
+ * Publish the frame rates of a stream. Each instance calls this from one
+ * thread; nothing is locked and the aggregator never waits for it.
+ */
+void nvds_perf_report_set_fps (NvDsPerfReport * report, guint instance,
+    guint source_id, gdouble fps, gdouble fps_avg);
+
+/**
+ * Count a frame of a stream at @now_us (monotonic); the gaps between
+ * frames make up the frame time percentiles. A stream must always be
+ * counted from the same thread.
+ */
+void nvds_perf_report_frame (NvDsPerfReport * report, guint instance,
+    guint source_id, gint64 now_us);
+
+/**
+ * Count buffers an instance's sinks dropped.
+ */
+void nvds_perf_report_dropped (NvDsPerfReport * report, guint instance,
+    guint num_dropped);
+
+void nvds_perf_report_get_stats (NvDsPerfReport * report,
+    NvDsPerfReportStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "deepstream_app_predictor.h"
+
+#define PREDICTOR_UNTRACKED_ID G_MAXUINT64
+/* Longest gap a track may coast over before it is restarted. */
+#define PREDICTOR_MAX_GAP_SEC 1.0
+
+/** Position / velocity filter along one image axis. */
+typedef struct
+{
+  gdouble pos;
+  gdouble vel;
+  gdouble p00, p01, p11;
+} PredictorAxis;
+
+typedef struct
+{
+  guint64 object_id;
+  gboolean in_use;
+  gdouble last_time;
+  /** Previous measured centre, the position a naive controller acts on. */
+  gdouble last_x;
+  gdouble last_y;
+  PredictorAxis x;
+  PredictorAxis y;
+} PredictorTrack;
+
+struct _NvDsPredictor
+{
+  NvDsPredictorConfig config;
+  gdouble q;
+  gdouble r;
+  PredictorTrack tracks[NVDS_PREDICTOR_MAX_TRACKS];
+  GMutex lock;
+  NvDsPredictorStats stats;
+};
+
+NvDsPredictor *
+nvds_predictor_new (NvDsPredictorConfig * config)
+{
+  NvDsPredictor *pred;
+
+  if (!config->enable)
+    return NULL;
+
+  pred = g_malloc0 (sizeof (NvDsPredictor));
+  pred->config = *config;
+  pred->q = config->process_noise * config->process_noise;
+  pred->r = config->measurement_noise * config->measurement_noise;
+  g_mutex_init (&pred->lock);
+  return pred;
+}
+
+void
+nvds_predictor_free (NvDsPredictor * pred)
+{
+  if (!pred)
+    return;
+
+  g_mutex_clear (&pred->lock);
+  g_free (pred);
+}
+
+static gdouble
+predictor_sample_time (const NvDsDetectionSample * sample)
+{
+  if (sample->pts)
+    return (gdouble) sample->pts / 1e9;
+  return (gdouble) sample->capture_time / G_USEC_PER_SEC;
+}
+
+static void
+predictor_axis_reset (PredictorAxis * axis, gdouble pos, gdouble r)
+{
+  axis->pos = pos;
+  axis->vel = 0;
+  axis->p00 = r;
+  axis->p01 = 0;
+  /* Walking speed is a few hundred pixels per second at typical range. */
+  axis->p11 = 500.0 * 500.0;
+}
+
+/** Time update with white-noise acceleration of variance @q. */
+static void
+predictor_axis_predict (PredictorAxis * axis, gdouble dt, gdouble q)
+{
+  gdouble dt2 = dt * dt;
+
+  axis->pos += axis->vel * dt;
+  axis->p00 += dt * (2 * axis->p01 + dt * axis->p11) + q * dt2 * dt2 / 4;
+  axis->p01 += dt * axis->p11 + q * dt2 * dt / 2;
+  axis->p11 += q * dt2;
+}
+
+static void
+predictor_axis_correct (PredictorAxis * axis, gdouble z, gdouble r)
+{
+  gdouble s = axis->p00 + r;
+  gdouble k0 = axis->p00 / s;
+  gdouble k1 = axis->p01 / s;
+  gdouble y = z - axis->pos;
+
+  axis->pos += k0 * y;
+  axis->vel += k1 * y;
+  axis->p11 -= k1 * axis->p01;
+  axis->p01 -= k0 * axis->p01;
+  axis->p00 -= k0 * axis->p00;
+}
+
+static PredictorTrack *
+predictor_find (NvDsPredictor * pred, guint64 object_id)
+{
+  guint i;
+
+  for (i = 0; i < NVDS_PREDICTOR_MAX_TRACKS; i++) {
+    if (pred->tracks[i].in_use && pred->tracks[i].object_id == object_id)
+      return &pred->tracks[i];
+  }
+  return NULL;
+}
+
+static PredictorTrack *
+predictor_claim (NvDsPredictor * pred, guint64 object_id)
+{
+  PredictorTrack *oldest = &pred->tracks[0];
+  guint i;
+
+  for (i = 0; i < NVDS_PREDICTOR_MAX_TRACKS; i++) {
+    PredictorTrack *track = &pred->tracks[i];
+    if (!track->in_use) {
+      oldest = track;
+      break;
+    }
+    if (track->last_time < oldest->last_time)
+      oldest = track;
+  }
+
+  memset (oldest, 0, sizeof (PredictorTrack));
+  oldest->object_id = object_id;
+  oldest->in_use = TRUE;
+  return oldest;
+}
+
+static guint64
+predictor_now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (guint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+predictor_account (NvDsPredictor * pred, guint64 start)
+{
+  guint64 cost = predictor_now_ns () - start;
+
+  pred->stats.total_cost_ns += cost;
+  if (cost > pred->stats.max_cost_ns)
+    pred->stats.max_cost_ns = cost;
+}
+
+void
+nvds_predictor_update (NvDsPredictor * pred,
+    const NvDsDetectionSample * sample)
+{
+  PredictorTrack *track;
+  guint64 start;
+  gdouble t, cx, cy, dt;
+
+  if (!pred || sample->object_id == PREDICTOR_UNTRACKED_ID)
+    return;
+
+  start = predictor_now_ns ();
+  t = predictor_sample_time (sample);
+  cx = sample->left + sample->width / 2;
+  cy = sample->top + sample->height / 2;
+
+  g_mutex_lock (&pred->lock);
+  pred->stats.num_updates++;
+  track = predictor_find (pred, sample->object_id);
+  dt = track ? t - track->last_time : 0;
+  if (!track || dt <= 0 || dt > PREDICTOR_MAX_GAP_SEC) {
+    if (!track)
+      track = predictor_claim (pred, sample->object_id);
+    predictor_axis_reset (&track->x, cx, pred->r);
+    predictor_axis_reset (&track->y, cy, pred->r);
+  } else {
+    predictor_axis_predict (&track->x, dt, pred->q);
+    predictor_axis_predict (&track->y, dt, pred->q);
+    pred->stats.total_error_px += hypot (cx - track->x.pos, cy - track->y.pos);
+    pred->stats.total_naive_error_px += hypot (cx - track->last_x,
+        cy - track->last_y);
+    pred->stats.num_errors++;
+    predictor_axis_correct (&track->x, cx, pred->r);
+    predictor_axis_correct (&track->y, cy, pred->r);
+  }
+  track->last_time = t;
+  track->last_x = cx;
+  track->last_y = cy;
+  predictor_account (pred, start);
+  g_mutex_unlock (&pred->lock);
+}
+
+gboolean
+nvds_predictor_apply (NvDsPredictor * pred, NvDsDetectionSample * sample,
+    gint64 now_us)
+{
+  PredictorTrack *track;
+  guint64 start;
+  gint64 latency;
+  gdouble lead;
+
+  if (!pred || sample->object_id == PREDICTOR_UNTRACKED_ID)
+    return FALSE;
+
+  start = predictor_now_ns ();
+  latency = MAX (now_us - sample->capture_time, 0);
+
+  g_mutex_lock (&pred->lock);
+  track = predictor_find (pred, sample->object_id);
+  if (!track) {
+    g_mutex_unlock (&pred->lock);
+    return FALSE;
+  }
+
+  lead = (gdouble) latency / G_USEC_PER_SEC +
+      pred->config.actuator_delay_ms / 1000.0;
+  sample->left = track->x.pos + track->x.vel * lead - sample->width / 2;
+  sample->top = track->y.pos + track->y.vel * lead - sample->height / 2;
+
+  pred->stats.num_predictions++;
+  pred->stats.total_latency_us += latency;
+  if ((guint64) latency > pred->stats.max_latency_us)
+    pred->stats.max_latency_us = latency;
+  predictor_account (pred, start);
+  g_mutex_unlock (&pred->lock);
+  return TRUE;
+}
+
+void
+nvds_predictor_get_stats (NvDsPredictor * pred, NvDsPredictorStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsPredictorStats));
+  if (!pred)
+    return;
+
+  g_mutex_lock (&pred->lock);
+  *stats = pred->stats;
+  g_mutex_unlock (&pred->lock);
+}
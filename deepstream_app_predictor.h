@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_PREDICTOR_H__
+#define __NVGSTDS_APP_PREDICTOR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_detection.h"
+
+/** Tracks filtered at once; the least recently seen one is recycled. */
+#define NVDS_PREDICTOR_MAX_TRACKS 32
+
+typedef struct
+{
+  gboolean enable;
+  /** Expected delay from a control decision to the actuator moving. */
+  guint actuator_delay_ms;
+  /** Std-dev of the unmodelled target acceleration, pixels / s^2. */
+  gdouble process_noise;
+  /** Std-dev of the detector's bbox centre, pixels. */
+  gdouble measurement_noise;
+} NvDsPredictorConfig;
+
+typedef struct
+{
+  guint64 num_updates;
+  guint64 num_predictions;
+  /** Time spent in update + predict. */
+  guint64 total_cost_ns;
+  guint64 max_cost_ns;
+  /**
+   * Distance between each new measurement and where the filter expected
+   * it (predicted) or where the previous measurement was (naive); the
+   * ratio shows what prediction buys over acting on stale positions.
+   */
+  gdouble total_error_px;
+  gdouble total_naive_error_px;
+  guint64 num_errors;
+  /** Capture-to-decision latency of predicted samples. */
+  guint64 total_latency_us;
+  guint64 max_latency_us;
+} NvDsPredictorStats;
+
+typedef struct _NvDsPredictor NvDsPredictor;
+
+NvDsPredictor *nvds_predictor_new (NvDsPredictorConfig * config);
+
+void nvds_predictor_free (NvDsPredictor * pred);
+
+/**
+ * Fold one detection into the constant-velocity filter of its track.
+ * Samples without a tracker id are ignored.
+ */
+void nvds_predictor_update (NvDsPredictor * pred,
+    const NvDsDetectionSample * sample);
+
+/**
+ * Move @sample's bbox to where its track is expected to be once the
+ * actuator reacts: the time already spent since capture (measured against
+ * @now_us, monotonic) plus the configured actuator delay.
+ *
+ * @return FALSE if the track is unknown; @sample is left untouched.
+ */
+gboolean nvds_predictor_apply (NvDsPredictor * pred,
+    NvDsDetectionSample * sample, gint64 now_us);
+
+void nvds_predictor_get_stats (NvDsPredictor * pred,
+    NvDsPredictorStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,544 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+
+#include "deepstream_app_recorder.h"
+
+#define DEFAULT_RECORDER_ENCODER "nvv4l2h264enc"
+#define DEFAULT_RECORDER_OUTPUT_DIR "."
+#define DEFAULT_RECORDER_IFRAME_INTERVAL 30
+#define DEFAULT_RECORDER_MAX_RING_KB (32 * 1024)
+
+/* Raw frames the branch may hold while the encoder catches up. */
+#define RECORDER_QUEUE_BUFFERS 8
+/* Longest a clip may take to finalize before it is abandoned. */
+#define RECORDER_EOS_TIMEOUT (10 * GST_SECOND)
+
+/* Ends the frame queue of a clip, and the clip queue of the writer. */
+static gint recorder_end_marker;
+#define RECORDER_END ((gpointer) &recorder_end_marker)
+
+typedef struct
+{
+  GstBuffer *buf;
+  GstClockTime pts;
+  gsize size;
+  gboolean keyframe;
+} RecorderFrame;
+
+typedef struct
+{
+  gchar *path;
+  GstCaps *caps;
+  /** Encoded buffers in decode order, closed by RECORDER_END. */
+  GAsyncQueue *frames;
+  /** Leading buffers that came from the ring. */
+  guint num_pre_event;
+  GstClockTime end_pts;
+  gint64 trigger_time;
+} RecorderClip;
+
+struct _NvDsRecorder
+{
+  NvDsRecorderConfig config;
+  guint index;
+  GstElement *bin;
+
+  GThread *writer;
+  GAsyncQueue *clips;
+
+  GMutex lock;
+  /** RecorderFrame, oldest first; always starts on a keyframe. */
+  GQueue ring;
+  /** The keyframes of ring, i.e. the GOP boundaries. */
+  GQueue gops;
+  guint64 ring_bytes;
+  GstClockTime last_pts;
+  GstCaps *caps;
+  /** Clip still taking post-event frames. */
+  RecorderClip *active;
+  NvDsRecorderStats stats;
+};
+
+static void
+recorder_frame_free (RecorderFrame * frame)
+{
+  gst_buffer_unref (frame->buf);
+  g_slice_free (RecorderFrame, frame);
+}
+
+static void
+recorder_clip_free (RecorderClip * clip)
+{
+  g_async_queue_unref (clip->frames);
+  gst_caps_unref (clip->caps);
+  g_free (clip->path);
+  g_free (clip);
+}
+
+static void
+recorder_ring_push_locked (NvDsRecorder * rec, RecorderFrame * frame)
+{
+  GstClockTime window = rec->config.pre_event_sec * GST_SECOND;
+  guint64 max_bytes = (guint64) rec->config.max_ring_kb * 1024;
+
+  /* A clip must open on a keyframe, so nothing before the first one is
+   * worth keeping. */
+  if (!frame->keyframe && g_queue_is_empty (&rec->ring)) {
+    recorder_frame_free (frame);
+    return;
+  }
+
+  g_queue_push_tail (&rec->ring, frame);
+  rec->ring_bytes += frame->size;
+  if (frame->keyframe)
+    g_queue_push_tail (&rec->gops, frame);
+
+  /* Drop whole GOPs from the front as long as the next GOP alone still
+   * covers the pre-event window (or the byte limit is exceeded). */
+  while (g_queue_get_length (&rec->gops) > 1) {
+    RecorderFrame *next = g_queue_peek_nth (&rec->gops, 1);
+    gboolean expired = GST_CLOCK_TIME_IS_VALID (frame->pts) &&
+        GST_CLOCK_TIME_IS_VALID (next->pts) && frame->pts >= next->pts &&
+        frame->pts - next->pts >= window;
+
+    if (!expired && rec->ring_bytes <= max_bytes)
+      break;
+
+    while (g_queue_peek_head (&rec->ring) != next) {
+      RecorderFrame *old = g_queue_pop_head (&rec->ring);
+      rec->ring_bytes -= old->size;
+      recorder_frame_free (old);
+    }
+    g_queue_pop_head (&rec->gops);
+  }
+
+  if (rec->ring_bytes > rec->stats.max_ring_bytes)
+    rec->stats.max_ring_bytes = rec->ring_bytes;
+}
+
+static GstFlowReturn
+recorder_new_sample (GstAppSink * sink, gpointer data)
+{
+  NvDsRecorder *rec = (NvDsRecorder *) data;
+  GstSample *sample = gst_app_sink_pull_sample (sink);
+  GstBuffer *buf;
+  GstCaps *caps;
+  RecorderFrame *frame;
+
+  if (!sample)
+    return GST_FLOW_EOS;
+
+  buf = gst_sample_get_buffer (sample);
+  caps = gst_sample_get_caps (sample);
+
+  /* Encoders hand out buffers from small pools; the ring must not pin
+   * them for the length of the pre-event window. */
+  frame = g_slice_new (RecorderFrame);
+  frame->buf = gst_buffer_copy_deep (buf);
+  frame->pts = GST_BUFFER_PTS (buf);
+  frame->size = gst_buffer_get_size (buf);
+  frame->keyframe = !GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+
+  g_mutex_lock (&rec->lock);
+  if (caps && caps != rec->caps) {
+    if (rec->caps)
+      gst_caps_unref (rec->caps);
+    rec->caps = gst_caps_ref (caps);
+  }
+  if (GST_CLOCK_TIME_IS_VALID (frame->pts))
+    rec->last_pts = frame->pts;
+  rec->stats.num_frames++;
+
+  if (rec->active) {
+    g_async_queue_push (rec->active->frames, gst_buffer_ref (frame->buf));
+    if (GST_CLOCK_TIME_IS_VALID (frame->pts)
+        && frame->pts >= rec->active->end_pts) {
+      g_async_queue_push (rec->active->frames, RECORDER_END);
+      rec->active = NULL;
+    }
+  }
+  recorder_ring_push_locked (rec, frame);
+  g_mutex_unlock (&rec->lock);
+
+  gst_sample_unref (sample);
+  return GST_FLOW_OK;
+}
+
+static gboolean
+recorder_write_clip (NvDsRecorder * rec, RecorderClip * clip)
+{
+  GstElement *pipeline = gst_pipeline_new (NULL);
+  GstElement *src = gst_element_factory_make ("appsrc", NULL);
+  GstElement *parse = gst_element_factory_make ("h264parse", NULL);
+  GstElement *mux = gst_element_factory_make (rec->config.container ==
+      NV_DS_RECORDER_CONTAINER_MKV ? "matroskamux" : "mp4mux", NULL);
+  GstElement *sink = gst_element_factory_make ("filesink", NULL);
+  GstClockTime base = GST_CLOCK_TIME_NONE;
+  GstMessage *msg = NULL;
+  GstBus *bus;
+  GstBuffer *buf;
+  gboolean ok = FALSE;
+  guint num_frames = 0;
+  gint64 end_time;
+
+  if (!src || !parse || !mux || !sink) {
+    g_printerr ("recorder: missing appsrc, h264parse, muxer or filesink\n");
+    if (src)
+      gst_object_unref (src);
+    if (parse)
+      gst_object_unref (parse);
+    if (mux)
+      gst_object_unref (mux);
+    if (sink)
+      gst_object_unref (sink);
+  } else {
+    g_object_set (G_OBJECT (src), "caps", clip->caps, "format",
+        GST_FORMAT_TIME, "block", TRUE, NULL);
+    g_object_set (G_OBJECT (sink), "location", clip->path, "sync", FALSE,
+        "async", FALSE, NULL);
+    gst_bin_add_many (GST_BIN (pipeline), src, parse, mux, sink, NULL);
+    ok = gst_element_link_many (src, parse, mux, sink, NULL) &&
+        gst_element_set_state (pipeline,
+        GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE;
+    if (!ok)
+      g_printerr ("recorder: cannot start writer for %s\n", clip->path);
+  }
+
+  /* Keep draining after a failure: the appsink side only stops pushing
+   * once the post-event window is over. */
+  while ((buf = g_async_queue_pop (clip->frames)) != RECORDER_END) {
+    if (!ok) {
+      gst_buffer_unref (buf);
+      continue;
+    }
+
+    /* Clips start at zero; the ring shares its memory, not its metadata. */
+    buf = gst_buffer_make_writable (buf);
+    if (!GST_CLOCK_TIME_IS_VALID (base))
+      base = GST_BUFFER_DTS_OR_PTS (buf);
+    if (GST_CLOCK_TIME_IS_VALID (base)) {
+      if (GST_BUFFER_PTS_IS_VALID (buf))
+        GST_BUFFER_PTS (buf) -= MIN (base, GST_BUFFER_PTS (buf));
+      if (GST_BUFFER_DTS_IS_VALID (buf))
+        GST_BUFFER_DTS (buf) -= MIN (base, GST_BUFFER_DTS (buf));
+    }
+
+    if (gst_app_src_push_buffer (GST_APP_SRC (src), buf) != GST_FLOW_OK) {
+      g_printerr ("recorder: writer for %s stopped\n", clip->path);
+      ok = FALSE;
+      continue;
+    }
+
+    if (++num_frames == clip->num_pre_event) {
+      guint64 latency = g_get_monotonic_time () - clip->trigger_time;
+      g_mutex_lock (&rec->lock);
+      rec->stats.last_flush_latency_us = latency;
+      if (latency > rec->stats.max_flush_latency_us)
+        rec->stats.max_flush_latency_us = latency;
+      g_mutex_unlock (&rec->lock);
+    }
+  }
+
+  end_time = g_get_monotonic_time ();
+  if (ok) {
+    gst_app_src_end_of_stream (GST_APP_SRC (src));
+    bus = gst_element_get_bus (pipeline);
+    msg = gst_bus_timed_pop_filtered (bus, RECORDER_EOS_TIMEOUT,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    ok = msg && GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+    if (msg)
+      gst_message_unref (msg);
+    gst_object_unref (bus);
+  }
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  g_mutex_lock (&rec->lock);
+  if (ok) {
+    rec->stats.num_clips++;
+    rec->stats.last_finalize_us = g_get_monotonic_time () - end_time;
+  } else {
+    rec->stats.num_failed++;
+  }
+  g_mutex_unlock (&rec->lock);
+
+  if (ok)
+    g_print ("recorder: wrote %s (%u frames)\n", clip->path, num_frames);
+  else
+    g_printerr ("recorder: failed to write %s\n", clip->path);
+  return ok;
+}
+
+static gpointer
+recorder_writer_thread (gpointer data)
+{
+  NvDsRecorder *rec = (NvDsRecorder *) data;
+  RecorderClip *clip;
+
+  while ((clip = g_async_queue_pop (rec->clips)) != RECORDER_END) {
+    recorder_write_clip (rec, clip);
+    recorder_clip_free (clip);
+  }
+  return NULL;
+}
+
+static GstElement *
+recorder_add (GstElement * bin, const gchar * factory)
+{
+  GstElement *elem = gst_element_factory_make (factory, NULL);
+
+  if (!elem) {
+    g_printerr ("recorder: cannot create element '%s'\n", factory);
+    return NULL;
+  }
+  gst_bin_add (GST_BIN (bin), elem);
+  return elem;
+}
+
+static gboolean
+recorder_create_bin (NvDsRecorder * rec)
+{
+  NvDsRecorderConfig *config = &rec->config;
+  gboolean nvmm = g_str_has_prefix (config->encoder, "nvv4l2");
+  GstElement *queue, *conv, *filter, *enc, *parse, *sink;
+  GstAppSinkCallbacks callbacks = { NULL, NULL, recorder_new_sample };
+  GstCaps *caps;
+  GstPad *pad;
+  gchar name[32];
+
+  g_snprintf (name, sizeof (name), "recorder_bin_%u", rec->index);
+  rec->bin = gst_bin_new (name);
+
+  queue = recorder_add (rec->bin, "queue");
+  conv = recorder_add (rec->bin, nvmm ? "nvvideoconvert" : "videoconvert");
+  filter = recorder_add (rec->bin, "capsfilter");
+  enc = recorder_add (rec->bin, config->encoder);
+  parse = recorder_add (rec->bin, "h264parse");
+  sink = recorder_add (rec->bin, "appsink");
+  if (!queue || !conv || !filter || !enc || !parse || !sink)
+    return FALSE;
+
+  /* Leak the oldest raw frames rather than back-pressure the tee. */
+  g_object_set (G_OBJECT (queue), "leaky", 2, "max-size-buffers",
+      RECORDER_QUEUE_BUFFERS, "max-size-bytes", 0, "max-size-time",
+      (guint64) 0, NULL);
+
+  caps = gst_caps_from_string (nvmm ? "video/x-raw(memory:NVMM), format=I420"
+      : "video/x-raw, format=I420");
+  g_object_set (G_OBJECT (filter), "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  if (nvmm) {
+    g_object_set (G_OBJECT (enc), "iframeinterval", config->iframe_interval,
+        NULL);
+    if (config->bitrate)
+      g_object_set (G_OBJECT (enc), "bitrate", config->bitrate, NULL);
+  } else if (!g_strcmp0 (config->encoder, "x264enc")) {
+    g_object_set (G_OBJECT (enc), "key-int-max", config->iframe_interval,
+        "bframes", 0, NULL);
+    gst_util_set_object_arg (G_OBJECT (enc), "tune", "zerolatency");
+    gst_util_set_object_arg (G_OBJECT (enc), "speed-preset", "ultrafast");
+    if (config->bitrate)
+      g_object_set (G_OBJECT (enc), "bitrate", config->bitrate / 1000, NULL);
+  }
+
+  /* Repeat SPS/PPS on every keyframe so each GOP in the ring can open a
+   * clip on its own. */
+  g_object_set (G_OBJECT (parse), "config-interval", -1, NULL);
+
+  caps = gst_caps_from_string ("video/x-h264, stream-format=byte-stream, "
+      "alignment=au");
+  g_object_set (G_OBJECT (sink), "caps", caps, "sync", FALSE, "async", FALSE,
+      "max-buffers", 4, NULL);
+  gst_caps_unref (caps);
+  gst_app_sink_set_callbacks (GST_APP_SINK (sink), &callbacks, rec, NULL);
+
+  if (!gst_element_link_many (queue, conv, filter, enc, parse, sink, NULL)) {
+    g_printerr ("recorder: cannot link the recording branch\n");
+    return FALSE;
+  }
+
+  pad = gst_element_get_static_pad (queue, "sink");
+  gst_element_add_pad (rec->bin, gst_ghost_pad_new ("sink", pad));
+  gst_object_unref (pad);
+  return TRUE;
+}
+
+NvDsRecorder *
+nvds_recorder_new (NvDsRecorderConfig * config, guint index)
+{
+  NvDsRecorder *rec;
+
+  if (!config->enable)
+    return NULL;
+
+  rec = g_malloc0 (sizeof (NvDsRecorder));
+  rec->config = *config;
+  rec->config.output_dir = g_strdup (config->output_dir ?
+      config->output_dir : DEFAULT_RECORDER_OUTPUT_DIR);
+  rec->config.encoder = g_strdup (config->encoder ?
+      config->encoder : DEFAULT_RECORDER_ENCODER);
+  if (!rec->config.iframe_interval)
+    rec->config.iframe_interval = DEFAULT_RECORDER_IFRAME_INTERVAL;
+  if (!rec->config.max_ring_kb)
+    rec->config.max_ring_kb = DEFAULT_RECORDER_MAX_RING_KB;
+  rec->index = index;
+  rec->last_pts = GST_CLOCK_TIME_NONE;
+  g_mutex_init (&rec->lock);
+  g_queue_init (&rec->ring);
+  g_queue_init (&rec->gops);
+  rec->clips = g_async_queue_new ();
+
+  if (!recorder_create_bin (rec)) {
+    if (rec->bin)
+      gst_object_unref (rec->bin);
+    rec->bin = NULL;
+    nvds_recorder_free (rec);
+    return NULL;
+  }
+
+  rec->writer = g_thread_new ("nvds-recorder", recorder_writer_thread, rec);
+  return rec;
+}
+
+void
+nvds_recorder_free (NvDsRecorder * rec)
+{
+  if (!rec)
+    return;
+
+  g_mutex_lock (&rec->lock);
+  if (rec->active) {
+    g_async_queue_push (rec->active->frames, RECORDER_END);
+    rec->active = NULL;
+  }
+  g_mutex_unlock (&rec->lock);
+
+  if (rec->writer) {
+    g_async_queue_push (rec->clips, RECORDER_END);
+    g_thread_join (rec->writer);
+  }
+  g_async_queue_unref (rec->clips);
+
+  g_queue_foreach (&rec->ring, (GFunc) recorder_frame_free, NULL);
+  g_queue_clear (&rec->ring);
+  g_queue_clear (&rec->gops);
+  if (rec->caps)
+    gst_caps_unref (rec->caps);
+  g_mutex_clear (&rec->lock);
+  g_free (rec->config.output_dir);
+  g_free (rec->config.encoder);
+  g_free (rec);
+}
+
+GstElement *
+nvds_recorder_get_bin (NvDsRecorder * rec)
+{
+  return rec ? rec->bin : NULL;
+}
+
+static gchar *
+recorder_clip_path (NvDsRecorder * rec, const gchar * reason)
+{
+  GDateTime *now = g_date_time_new_now_local ();
+  gchar *stamp = g_date_time_format (now, "%Y%m%d-%H%M%S");
+  gchar *name = g_strdup_printf ("event-%u-%s-%s.%s", rec->index, stamp,
+      reason ? reason : "trigger", rec->config.container ==
+      NV_DS_RECORDER_CONTAINER_MKV ? "mkv" : "mp4");
+  gchar *path = g_build_filename (rec->config.output_dir, name, NULL);
+
+  g_free (name);
+  g_free (stamp);
+  g_date_time_unref (now);
+  return path;
+}
+
+void
+nvds_recorder_trigger (NvDsRecorder * rec, const gchar * reason)
+{
+  RecorderClip *clip;
+  GList *l;
+
+  if (!rec)
+    return;
+
+  g_mutex_lock (&rec->lock);
+  rec->stats.num_triggers++;
+
+  if (rec->active) {
+    rec->active->end_pts = rec->last_pts +
+        rec->config.post_event_sec * GST_SECOND;
+    rec->stats.num_extended++;
+    g_mutex_unlock (&rec->lock);
+    return;
+  }
+
+  if (g_queue_is_empty (&rec->ring) || !rec->caps) {
+    /* Nothing has been encoded yet. */
+    rec->stats.num_failed++;
+    g_mutex_unlock (&rec->lock);
+    return;
+  }
+
+  clip = g_new0 (RecorderClip, 1);
+  clip->path = recorder_clip_path (rec, reason);
+  clip->caps = gst_caps_ref (rec->caps);
+  clip->frames = g_async_queue_new ();
+  clip->trigger_time = g_get_monotonic_time ();
+  clip->end_pts = rec->last_pts + rec->config.post_event_sec * GST_SECOND;
+
+  /* Only references move; the writer thread does the muxing. */
+  for (l = rec->ring.head; l; l = l->next) {
+    RecorderFrame *frame = l->data;
+    g_async_queue_push (clip->frames, gst_buffer_ref (frame->buf));
+  }
+  clip->num_pre_event = g_queue_get_length (&rec->ring);
+
+  rec->active = clip;
+  g_async_queue_push (rec->clips, clip);
+  g_mutex_unlock (&rec->lock);
+}
+
+void
+nvds_recorder_get_stats (NvDsRecorder * rec, NvDsRecorderStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsRecorderStats));
+  if (!rec)
+    return;
+
+  g_mutex_lock (&rec->lock);
+  *stats = rec->stats;
+  stats->ring_frames = g_queue_get_length (&rec->ring);
+  stats->ring_bytes = rec->ring_bytes;
+  if (!g_queue_is_empty (&rec->ring)) {
+    RecorderFrame *first = g_queue_peek_head (&rec->ring);
+    if (GST_CLOCK_TIME_IS_VALID (first->pts)
+        && GST_CLOCK_TIME_IS_VALID (rec->last_pts)
+        && rec->last_pts >= first->pts)
+      stats->ring_duration = rec->last_pts - first->pts;
+  }
+  g_mutex_unlock (&rec->lock);
+}
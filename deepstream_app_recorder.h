@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_RECORDER_H__
+#define __NVGSTDS_APP_RECORDER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+
+typedef enum
+{
+  NV_DS_RECORDER_CONTAINER_MP4 = 0,
+  NV_DS_RECORDER_CONTAINER_MKV,
+} NvDsRecorderContainer;
+
+typedef struct
+{
+  gboolean enable;
+  /** Video kept in the ring ahead of a trigger. */
+  guint pre_event_sec;
+  /** Video recorded after the last trigger of a clip. */
+  guint post_event_sec;
+  NvDsRecorderContainer container;
+  gchar *output_dir;
+  /** Encoder element; nvv4l2* encoders are fed NVMM buffers, anything else
+   * goes through videoconvert. */
+  gchar *encoder;
+  /** Encoder bitrate in bits/s, 0 keeps the element default. */
+  guint bitrate;
+  /** Keyframe interval in frames; bounds how far the ring start may lie
+   * before the requested pre-event window. */
+  guint iframe_interval;
+  /** Hard limit on the encoded bytes held by the ring. */
+  guint max_ring_kb;
+} NvDsRecorderConfig;
+
+typedef struct
+{
+  /** Encoded frames and bytes currently held by the ring. */
+  guint ring_frames;
+  guint64 ring_bytes;
+  guint64 max_ring_bytes;
+  GstClockTime ring_duration;
+  guint64 num_frames;
+  guint64 num_triggers;
+  /** Triggers that landed on a clip in progress and extended it. */
+  guint64 num_extended;
+  guint64 num_clips;
+  guint64 num_failed;
+  /** Trigger to pre-event video handed to the muxer. */
+  guint64 last_flush_latency_us;
+  guint64 max_flush_latency_us;
+  /** Post-event end to file closed. */
+  guint64 last_finalize_us;
+} NvDsRecorderStats;
+
+typedef struct _NvDsRecorder NvDsRecorder;
+
+/**
+ * Create the recording branch. The returned recorder owns a bin with a
+ * "sink" ghost pad that takes raw video, typically from a tee next to the
+ * normal sinks; its first queue leaks so a slow encoder never stalls the
+ * main branch. Clips are written by a background thread with its own
+ * muxing pipeline.
+ *
+ * @return NULL if @config is disabled or an element is missing.
+ */
+NvDsRecorder *nvds_recorder_new (NvDsRecorderConfig * config, guint index);
+
+/**
+ * Finish the clip in progress, stop the writer and free the recorder. The
+ * bin must already be in the NULL state or removed from its pipeline.
+ */
+void nvds_recorder_free (NvDsRecorder * rec);
+
+GstElement *nvds_recorder_get_bin (NvDsRecorder * rec);
+
+/**
+ * Start a clip with the buffered pre-event video, or extend the one in
+ * progress. Cheap enough to call from a pad probe; @reason ends up in the
+ * file name.
+ */
+void nvds_recorder_trigger (NvDsRecorder * rec, const gchar * reason);
+
+void nvds_recorder_get_stats (NvDsRecorder * rec, NvDsRecorderStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <glib-unix.h>
+
+#include "deepstream_app_reload.h"
+#include "deepstream_app_log.h"
+
+/* Editors write a file in several steps; act once they have stopped. */
+#define CONFIG_WATCH_SETTLE_MS 300
+
+struct _NvDsConfigWatch
+{
+  gchar *path;
+  gchar *name;
+  gint fd;
+  guint fd_source;
+  guint settle_source;
+  /** The config that is running. */
+  GKeyFile *key_file;
+  NvDsConfigWatchFunc func;
+  gpointer user_data;
+  NvDsConfigWatchStats stats;
+};
+
+const gchar *
+nvds_config_change_kind_name (NvDsConfigChangeKind kind)
+{
+  switch (kind) {
+    case NV_DS_CONFIG_KEY_ADDED:
+      return "added";
+    case NV_DS_CONFIG_KEY_REMOVED:
+      return "removed";
+    default:
+      return "changed";
+  }
+}
+
+static GKeyFile *
+config_watch_load (const gchar * path)
+{
+  GKeyFile *key_file = g_key_file_new ();
+  GError *error = NULL;
+
+  if (!g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, &error)) {
+    NVDS_LOG_WARN ("reload: cannot load %s: %s", path, error->message);
+    g_error_free (error);
+    g_key_file_free (key_file);
+    return NULL;
+  }
+  return key_file;
+}
+
+static void
+config_watch_add_change (GArray * changes, const gchar * group,
+    const gchar * key, NvDsConfigChangeKind kind)
+{
+  NvDsConfigChange change;
+
+  change.group = g_strdup (group);
+  change.key = g_strdup (key);
+  change.kind = kind;
+  g_array_append_val (changes, change);
+}
+
+/**
+ * Keys whose value text differs, in file order: those of @to, then those
+ * only @from has.
+ */
+static GArray *
+config_watch_diff (GKeyFile * from, GKeyFile * to)
+{
+  GArray *changes = g_array_new (FALSE, FALSE, sizeof (NvDsConfigChange));
+  gchar **groups, **group, **keys, **key;
+
+  groups = g_key_file_get_groups (to, NULL);
+  for (group = groups; *group; group++) {
+    keys = g_key_file_get_keys (to, *group, NULL, NULL);
+    for (key = keys; key && *key; key++) {
+      gchar *old_value = g_key_file_get_value (from, *group, *key, NULL);
+      gchar *new_value = g_key_file_get_value (to, *group, *key, NULL);
+
+      if (!old_value)
+        config_watch_add_change (changes, *group, *key,
+            NV_DS_CONFIG_KEY_ADDED);
+      else if (g_strcmp0 (old_value, new_value))
+        config_watch_add_change (changes, *group, *key,
+            NV_DS_CONFIG_KEY_CHANGED);
+      g_free (old_value);
+      g_free (new_value);
+    }
+    g_strfreev (keys);
+  }
+  g_strfreev (groups);
+
+  groups = g_key_file_get_groups (from, NULL);
+  for (group = groups; *group; group++) {
+    keys = g_key_file_get_keys (from, *group, NULL, NULL);
+    for (key = keys; key && *key; key++) {
+      if (!g_key_file_has_key (to, *group, *key, NULL))
+        config_watch_add_change (changes, *group, *key,
+            NV_DS_CONFIG_KEY_REMOVED);
+    }
+    g_strfreev (keys);
+  }
+  g_strfreev (groups);
+  return changes;
+}
+
+static void
+config_watch_free_changes (GArray * changes)
+{
+  guint i;
+
+  for (i = 0; i < changes->len; i++) {
+    NvDsConfigChange *change = &g_array_index (changes, NvDsConfigChange, i);
+    g_free (change->group);
+    g_free (change->key);
+  }
+  g_array_free (changes, TRUE);
+}
+
+static gboolean
+config_watch_settled (gpointer data)
+{
+  NvDsConfigWatch *watch = (NvDsConfigWatch *) data;
+  GKeyFile *key_file;
+  GArray *changes;
+
+  watch->settle_source = 0;
+  key_file = config_watch_load (watch->path);
+  if (!key_file) {
+    watch->stats.num_failed++;
+    return FALSE;
+  }
+
+  changes = config_watch_diff (watch->key_file, key_file);
+  if (changes->len == 0) {
+    NVDS_LOG_DEBUG ("reload: %s saved without changes", watch->path);
+  } else if (watch->func (watch->path,
+          (const NvDsConfigChange *) changes->data, changes->len,
+          watch->user_data)) {
+    g_key_file_free (watch->key_file);
+    watch->key_file = key_file;
+    key_file = NULL;
+    watch->stats.num_reloads++;
+    watch->stats.num_changes += changes->len;
+  } else {
+    watch->stats.num_failed++;
+  }
+
+  config_watch_free_changes (changes);
+  if (key_file)
+    g_key_file_free (key_file);
+  return FALSE;
+}
+
+static gboolean
+config_watch_readable (gint fd, GIOCondition condition, gpointer data)
+{
+  NvDsConfigWatch *watch = (NvDsConfigWatch *) data;
+  gchar buf[4096]
+      __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+  gboolean touched = FALSE;
+  gssize len;
+
+  /* The watch is on the directory; only events naming the file count. */
+  while ((len = read (fd, buf, sizeof (buf))) > 0) {
+    const gchar *p = buf;
+
+    while (p < buf + len) {
+      const struct inotify_event *event = (const struct inotify_event *) p;
+
+      if (event->len && !strcmp (event->name, watch->name))
+        touched = TRUE;
+      p += sizeof (struct inotify_event) + event->len;
+    }
+  }
+
+  if (touched) {
+    watch->stats.num_events++;
+    if (watch->settle_source)
+      g_source_remove (watch->settle_source);
+    watch->settle_source = g_timeout_add (CONFIG_WATCH_SETTLE_MS,
+        config_watch_settled, watch);
+  }
+  return TRUE;
+}
+
+NvDsConfigWatch *
+nvds_config_watch_new (const gchar * path, NvDsConfigWatchFunc func,
+    gpointer user_data)
+{
+  NvDsConfigWatch *watch;
+  gchar *dir;
+  gint wd;
+
+  watch = g_new0 (NvDsConfigWatch, 1);
+  watch->path = g_strdup (path);
+  watch->name = g_path_get_basename (path);
+  watch->func = func;
+  watch->user_data = user_data;
+  watch->fd = -1;
+
+  watch->key_file = config_watch_load (path);
+  if (!watch->key_file)
+    goto fail;
+
+  watch->fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+  if (watch->fd < 0) {
+    NVDS_LOG_WARN ("reload: inotify_init1 failed: %s", g_strerror (errno));
+    goto fail;
+  }
+  dir = g_path_get_dirname (path);
+  wd = inotify_add_watch (watch->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+  if (wd < 0)
+    NVDS_LOG_WARN ("reload: cannot watch %s: %s", dir, g_strerror (errno));
+  g_free (dir);
+  if (wd < 0)
+    goto fail;
+
+  watch->fd_source = g_unix_fd_add (watch->fd, G_IO_IN,
+      config_watch_readable, watch);
+  NVDS_LOG_INFO ("reload: watching %s", path);
+  return watch;
+
+fail:
+  nvds_config_watch_free (watch);
+  return NULL;
+}
+
+void
+nvds_config_watch_free (NvDsConfigWatch * watch)
+{
+  if (!watch)
+    return;
+
+  if (watch->settle_source)
+    g_source_remove (watch->settle_source);
+  if (watch->fd_source)
+    g_source_remove (watch->fd_source);
+  if (watch->fd >= 0)
+    close (watch->fd);
+  if (watch->key_file)
+    g_key_file_free (watch->key_file);
+  g_free (watch->path);
+  g_free (watch->name);
+  g_free (watch);
+}
+
+void
+nvds_config_watch_get_stats (NvDsConfigWatch * watch,
+    NvDsConfigWatchStats * stats)
+{
+  *stats = watch->stats;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_RELOAD_H__
+#define __NVGSTDS_APP_RELOAD_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+typedef enum
+{
+  NV_DS_CONFIG_KEY_CHANGED,
+  NV_DS_CONFIG_KEY_ADDED,
+  NV_DS_CONFIG_KEY_REMOVED
+} NvDsConfigChangeKind;
+
+typedef struct
+{
+  gchar *group;
+  gchar *key;
+  NvDsConfigChangeKind kind;
+} NvDsConfigChange;
+
+typedef struct
+{
+  /** inotify events on the file. */
+  guint64 num_events;
+  /** Edits handed to the callback and taken, and edits that did not load
+   * or were refused. */
+  guint64 num_reloads;
+  guint64 num_failed;
+  guint64 num_changes;
+} NvDsConfigWatchStats;
+
+typedef struct _NvDsConfigWatch NvDsConfigWatch;
+
+/**
+ * Called on the main loop once an edit of the file has settled, with the
+ * keys that differ from the running config.
+ *
+ * @return TRUE if the edit is now the running config; the next one is
+ * diffed against it. Otherwise against the previous one still.
+ */
+typedef gboolean (*NvDsConfigWatchFunc) (const gchar * path,
+    const NvDsConfigChange * changes, guint num_changes, gpointer user_data);
+
+const gchar *nvds_config_change_kind_name (NvDsConfigChangeKind kind);
+
+/**
+ * Watch @path, the file the running config was parsed from, with inotify
+ * on its directory so that editors replacing the file are seen too.
+ *
+ * @return NULL if the file cannot be loaded or watched.
+ */
+NvDsConfigWatch *nvds_config_watch_new (const gchar * path,
+    NvDsConfigWatchFunc func, gpointer user_data);
+
+void nvds_config_watch_free (NvDsConfigWatch * watch);
+
+void nvds_config_watch_get_stats (NvDsConfigWatch * watch,
+    NvDsConfigWatchStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "deepstream_app_render.h"
+
+/* Same lookups process_meta used to do for every object. */
+static gboolean
+render_lookup (GHashTable * table, gint class_id, NvOSD_ColorParams * color)
+{
+  gpointer value;
+
+  if (!table)
+    return FALSE;
+  value = g_hash_table_lookup (table, class_id + (gchar *) NULL);
+  if (!value)
+    return FALSE;
+  *color = *(NvOSD_ColorParams *) value;
+  return TRUE;
+}
+
+void
+nvds_render_table_apply_slow (const NvDsGieRenderTable * table,
+    gint class_id, NvOSD_RectParams * rect_params)
+{
+  NvDsGieConfig *gie_config = table->gie_config;
+
+  if (!render_lookup (gie_config->bbox_border_color_table, class_id,
+          &rect_params->border_color))
+    rect_params->border_color = gie_config->bbox_border_color;
+  rect_params->has_bg_color = render_lookup (gie_config->bbox_bg_color_table,
+      class_id, &rect_params->bg_color);
+}
+
+static void
+render_compile_gie (NvDsRenderTables * tables, NvDsGieConfig * gie_config)
+{
+  NvDsGieRenderTable *table;
+  guint i;
+
+  for (i = 0; i < tables->num_gies; i++) {
+    if (tables->gies[i].gie_config->unique_id == gie_config->unique_id)
+      return;
+  }
+
+  table = &tables->gies[tables->num_gies++];
+  table->gie_config = gie_config;
+  for (i = 0; i < NVDS_RENDER_MAX_CLASSES; i++) {
+    if (!render_lookup (gie_config->bbox_border_color_table, i,
+            &table->border_color[i]))
+      table->border_color[i] = gie_config->bbox_border_color;
+    table->has_bg_color[i] = render_lookup (gie_config->bbox_bg_color_table,
+        i, &table->bg_color[i]);
+  }
+
+  if (gie_config->unique_id < NVDS_RENDER_MAX_UNIQUE_ID)
+    tables->gie_index[gie_config->unique_id] = tables->num_gies;
+}
+
+NvDsRenderTables *
+nvds_render_tables_new (NvDsGieConfig * primary, NvDsGieConfig * secondaries,
+    guint num_secondaries)
+{
+  NvDsRenderTables *tables = g_malloc0 (sizeof (NvDsRenderTables));
+  guint i;
+
+  tables->gies = g_new0 (NvDsGieRenderTable, num_secondaries + 1);
+  render_compile_gie (tables, primary);
+  for (i = 0; i < num_secondaries; i++)
+    render_compile_gie (tables, &secondaries[i]);
+  return tables;
+}
+
+void
+nvds_render_tables_free (NvDsRenderTables * tables)
+{
+  if (!tables)
+    return;
+
+  g_free (tables->gies);
+  g_free (tables);
+}
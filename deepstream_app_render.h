@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_RENDER_H__
+#define __NVGSTDS_APP_RENDER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_primary_gie.h"
+
+/** Classes and GIE unique ids covered by the flat tables; anything
+ * outside falls back to the lookups on the GIE config. */
+#define NVDS_RENDER_MAX_CLASSES 128
+#define NVDS_RENDER_MAX_UNIQUE_ID 256
+
+typedef struct
+{
+  NvDsGieConfig *gie_config;
+  NvOSD_ColorParams border_color[NVDS_RENDER_MAX_CLASSES];
+  NvOSD_ColorParams bg_color[NVDS_RENDER_MAX_CLASSES];
+  gboolean has_bg_color[NVDS_RENDER_MAX_CLASSES];
+} NvDsGieRenderTable;
+
+/**
+ * bbox colours of every GIE, resolved once from the per-class hash tables
+ * of its config so that drawing an object costs two array loads.
+ */
+typedef struct
+{
+  /** unique_id -> index into gies + 1; 0 if no GIE has that id. */
+  guint8 gie_index[NVDS_RENDER_MAX_UNIQUE_ID];
+  NvDsGieRenderTable *gies;
+  guint num_gies;
+} NvDsRenderTables;
+
+/**
+ * Compile the tables. The primary GIE wins over a secondary with the same
+ * unique id, and an earlier secondary over a later one.
+ */
+NvDsRenderTables *nvds_render_tables_new (NvDsGieConfig * primary,
+    NvDsGieConfig * secondaries, guint num_secondaries);
+
+void nvds_render_tables_free (NvDsRenderTables * tables);
+
+/**
+ * @return the table of the GIE with @unique_id, NULL if there is none.
+ */
+static inline const NvDsGieRenderTable *
+nvds_render_tables_lookup (const NvDsRenderTables * tables, gint unique_id)
+{
+  guint i;
+
+  if (unique_id >= 0 && unique_id < NVDS_RENDER_MAX_UNIQUE_ID) {
+    i = tables->gie_index[unique_id];
+    return i ? &tables->gies[i - 1] : NULL;
+  }
+  for (i = 0; i < tables->num_gies; i++) {
+    if ((gint) tables->gies[i].gie_config->unique_id == unique_id)
+      return &tables->gies[i];
+  }
+  return NULL;
+}
+
+/**
+ * Set the border and background colour of a @class_id box.
+ */
+void nvds_render_table_apply_slow (const NvDsGieRenderTable * table,
+    gint class_id, NvOSD_RectParams * rect_params);
+
+static inline void
+nvds_render_table_apply (const NvDsGieRenderTable * table, gint class_id,
+    NvOSD_RectParams * rect_params)
+{
+  if (class_id < 0 || class_id >= NVDS_RENDER_MAX_CLASSES) {
+    nvds_render_table_apply_slow (table, class_id, rect_params);
+    return;
+  }
+  rect_params->border_color = table->border_color[class_id];
+  rect_params->has_bg_color = table->has_bg_color[class_id];
+  if (table->has_bg_color[class_id])
+    rect_params->bg_color = table->bg_color[class_id];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
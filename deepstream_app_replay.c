@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "deepstream_app_replay.h"
+
+/* Recorded timestamps are in nanoseconds. A jump backwards or a gap longer
+ * than this is a restart of the recording and is not waited out. */
+#define REPLAY_MAX_GAP_NS (2 * G_GUINT64_CONSTANT (1000000000))
+/* Matches UNTRACKED_OBJECT_ID of nvdsmeta.h. */
+#define REPLAY_UNTRACKED_OBJECT_ID G_MAXUINT64
+
+typedef struct
+{
+  guint64 frame_num;
+  gchar *path;
+} ReplayKittiFile;
+
+typedef struct
+{
+  guint source_id;
+  /** Detection log of the stream; NULL for KITTI streams. */
+  NvDsDetectionLogReader *reader;
+  /** Frame record read while collecting the objects of the frame before. */
+  NvDsDetectionLogRecord pending;
+  gboolean has_pending;
+  /** ReplayKittiFile, sorted by frame number. */
+  GArray *files;
+  guint next_file;
+
+  /** Next frame of the stream and whether the last batch handed it out. */
+  gboolean has_frame;
+  gboolean consumed;
+  NvDsReplayFrame frame;
+  GArray *objects;
+} ReplayStream;
+
+struct _NvDsReplay
+{
+  gdouble speed;
+  gdouble kitti_fps;
+  guint component_id;
+  /** Label -> class id + 1. */
+  GHashTable *labels;
+  /** ReplayStream, sorted by source id. */
+  GPtrArray *streams;
+  GArray *batch;
+
+  gboolean started;
+  gint64 start_wall;
+  gint64 end_wall;
+  /** Pacing clock: base_pts is due at base_wall. */
+  gint64 base_wall;
+  guint64 base_pts;
+  guint64 last_pts;
+  NvDsReplayStats stats;
+};
+
+static void
+replay_stream_free (ReplayStream * stream)
+{
+  guint i;
+
+  nvds_detection_log_reader_close (stream->reader);
+  for (i = 0; i < stream->files->len; i++)
+    g_free (g_array_index (stream->files, ReplayKittiFile, i).path);
+  g_array_free (stream->files, TRUE);
+  g_array_free (stream->objects, TRUE);
+  g_free (stream);
+}
+
+static ReplayStream *
+replay_get_stream (NvDsReplay * replay, guint source_id)
+{
+  ReplayStream *stream;
+  guint i;
+
+  for (i = 0; i < replay->streams->len; i++) {
+    stream = g_ptr_array_index (replay->streams, i);
+    if (stream->source_id == source_id)
+      return stream;
+  }
+
+  stream = g_malloc0 (sizeof (ReplayStream));
+  stream->source_id = source_id;
+  stream->files = g_array_new (FALSE, FALSE, sizeof (ReplayKittiFile));
+  stream->objects =
+      g_array_new (FALSE, FALSE, sizeof (NvDsDetectionLogRecord));
+  g_ptr_array_add (replay->streams, stream);
+  return stream;
+}
+
+static gint
+replay_stream_compare (gconstpointer a, gconstpointer b)
+{
+  const ReplayStream *sa = *(ReplayStream * const *) a;
+  const ReplayStream *sb = *(ReplayStream * const *) b;
+
+  return sa->source_id < sb->source_id ? -1 : sa->source_id > sb->source_id;
+}
+
+static gint
+replay_kitti_file_compare (gconstpointer a, gconstpointer b)
+{
+  const ReplayKittiFile *fa = a;
+  const ReplayKittiFile *fb = b;
+
+  return fa->frame_num < fb->frame_num ? -1 : fa->frame_num > fb->frame_num;
+}
+
+static GHashTable *
+replay_load_labels (const gchar * path)
+{
+  GHashTable *labels;
+  GError *error = NULL;
+  gchar *contents;
+  gchar **lines;
+  gint class_id = 0;
+  guint i;
+
+  if (!g_file_get_contents (path, &contents, NULL, &error)) {
+    g_printerr ("replay: cannot read labels: %s\n", error->message);
+    g_error_free (error);
+    return NULL;
+  }
+
+  labels = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  lines = g_strsplit_set (contents, ";\n", -1);
+  for (i = 0; lines[i]; i++) {
+    gchar *label = g_strstrip (lines[i]);
+
+    if (label[0] == '\0')
+      continue;
+    if (!g_hash_table_contains (labels, label))
+      g_hash_table_insert (labels, g_strdup (label),
+          GINT_TO_POINTER (class_id + 1));
+    class_id++;
+  }
+  g_strfreev (lines);
+  g_free (contents);
+  return labels;
+}
+
+static gboolean
+replay_add_log (NvDsReplay * replay, const gchar * path)
+{
+  NvDsDetectionLogReader *reader = nvds_detection_log_reader_open (path);
+  ReplayStream *stream;
+
+  if (!reader)
+    return FALSE;
+
+  stream = replay_get_stream (replay,
+      nvds_detection_log_reader_get_header (reader)->source_id);
+  if (stream->reader) {
+    g_printerr ("replay: %s repeats source %u, skipped\n", path,
+        stream->source_id);
+    nvds_detection_log_reader_close (reader);
+    return FALSE;
+  }
+  stream->reader = reader;
+  return TRUE;
+}
+
+static gboolean
+replay_add_dir (NvDsReplay * replay, const gchar * path, guint instance)
+{
+  GError *error = NULL;
+  GDir *dir = g_dir_open (path, 0, &error);
+  GPtrArray *logs = g_ptr_array_new_with_free_func (g_free);
+  gchar *run = NULL;
+  const gchar *name;
+  guint i;
+
+  if (!dir) {
+    g_printerr ("replay: %s\n", error->message);
+    g_error_free (error);
+    return FALSE;
+  }
+
+  while ((name = g_dir_read_name (dir))) {
+    guint file_instance, source_id;
+    gulong frame_num;
+
+    if (g_str_has_suffix (name, ".detlog")) {
+      gint run_offset = 0;
+
+      if (sscanf (name, "%u_%u_%n", &file_instance, &source_id,
+              &run_offset) != 2 || !run_offset || file_instance != instance)
+        continue;
+      /* The directory may hold several runs; only the newest is played,
+       * as frame numbers start again in each. */
+      if (!run || strcmp (name + run_offset, run) > 0) {
+        g_free (run);
+        run = g_strdup (name + run_offset);
+      }
+      g_ptr_array_add (logs, g_strdup (name));
+    } else if (g_str_has_suffix (name, ".txt")) {
+      ReplayKittiFile file;
+
+      if (sscanf (name, "%u_%u_%lu.txt", &file_instance, &source_id,
+              &frame_num) != 3 || file_instance != instance)
+        continue;
+      file.frame_num = frame_num;
+      file.path = g_build_filename (path, name, NULL);
+      g_array_append_val (replay_get_stream (replay, source_id)->files, file);
+    }
+  }
+  g_dir_close (dir);
+
+  for (i = 0; i < logs->len; i++) {
+    const gchar *log_name = g_ptr_array_index (logs, i);
+    gchar *file_path;
+
+    if (strcmp (strrchr (log_name, '_') + 1, run))
+      continue;
+    file_path = g_build_filename (path, log_name, NULL);
+    replay_add_log (replay, file_path);
+    g_free (file_path);
+  }
+  g_ptr_array_free (logs, TRUE);
+  g_free (run);
+
+  for (i = 0; i < replay->streams->len; i++) {
+    ReplayStream *stream = g_ptr_array_index (replay->streams, i);
+    g_array_sort (stream->files, replay_kitti_file_compare);
+  }
+  return TRUE;
+}
+
+/**
+ * Parse one line written by write_kitti_output or its tracker variant:
+ * the label, the tracker id for the latter, then the 14 numbers of a KITTI
+ * label with the bbox at positions 3-6.
+ */
+static gboolean
+replay_parse_kitti_line (NvDsReplay * replay, const gchar * line,
+    NvDsDetectionLogRecord * record)
+{
+  gchar label[128];
+  gdouble values[16];
+  gdouble *bbox;
+  guint64 object_id = REPLAY_UNTRACKED_OBJECT_ID;
+  const gchar *p = line;
+  gchar *end;
+  guint num_values = 0;
+  gsize len;
+
+  while (g_ascii_isspace (*p))
+    p++;
+  len = strcspn (p, " \t\r\n");
+  if (len == 0 || len >= sizeof (label))
+    return FALSE;
+  memcpy (label, p, len);
+  label[len] = '\0';
+  p += len;
+
+  while (num_values < G_N_ELEMENTS (values)) {
+    values[num_values] = g_ascii_strtod (p, &end);
+    if (end == p)
+      break;
+    num_values++;
+    p = end;
+  }
+
+  if (num_values == 15) {
+    object_id = (guint64) values[0];
+    bbox = &values[4];
+  } else if (num_values == 14) {
+    bbox = &values[3];
+  } else {
+    return FALSE;
+  }
+
+  memset (record, 0, sizeof (NvDsDetectionLogRecord));
+  record->type = NV_DS_DETECTION_LOG_OBJECT;
+  record->class_id = replay->labels ?
+      GPOINTER_TO_INT (g_hash_table_lookup (replay->labels, label)) - 1 : -1;
+  record->object_id = object_id;
+  record->left = bbox[0];
+  record->top = bbox[1];
+  record->width = bbox[2] - bbox[0];
+  record->height = bbox[3] - bbox[1];
+  /* KITTI output drops the score. */
+  record->confidence = 1.0;
+  record->component_id = replay->component_id;
+  g_strlcpy (record->label, label, sizeof (record->label));
+  return TRUE;
+}
+
+static gboolean
+replay_read_kitti_frame (NvDsReplay * replay, ReplayStream * stream)
+{
+  while (stream->next_file < stream->files->len) {
+    ReplayKittiFile *file =
+        &g_array_index (stream->files, ReplayKittiFile, stream->next_file++);
+    FILE *f = fopen (file->path, "r");
+    gchar line[512];
+
+    if (!f) {
+      g_printerr ("replay: cannot open %s\n", file->path);
+      continue;
+    }
+
+    g_array_set_size (stream->objects, 0);
+    while (fgets (line, sizeof (line), f)) {
+      NvDsDetectionLogRecord record;
+      if (replay_parse_kitti_line (replay, line, &record))
+        g_array_append_val (stream->objects, record);
+    }
+    fclose (f);
+
+    stream->frame.frame_num = file->frame_num;
+    stream->frame.pts = (guint64) (file->frame_num * 1e9 / replay->kitti_fps);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static gboolean
+replay_read_log_frame (ReplayStream * stream)
+{
+  NvDsDetectionLogRecord record;
+
+  if (stream->has_pending) {
+    record = stream->pending;
+    stream->has_pending = FALSE;
+  } else {
+    /* Skip objects whose frame record was lost. */
+    do {
+      if (!nvds_detection_log_reader_next (stream->reader, &record))
+        return FALSE;
+    } while (record.type != NV_DS_DETECTION_LOG_FRAME);
+  }
+
+  stream->frame.frame_num = record.frame_num;
+  stream->frame.pts = record.pts;
+
+  /* The frame record announces its object count, but a writer that was
+   * dropping batches may have left fewer behind. */
+  g_array_set_size (stream->objects, 0);
+  while (stream->objects->len < record.object_id) {
+    NvDsDetectionLogRecord object;
+
+    if (!nvds_detection_log_reader_next (stream->reader, &object))
+      break;
+    if (object.type == NV_DS_DETECTION_LOG_FRAME) {
+      stream->pending = object;
+      stream->has_pending = TRUE;
+      break;
+    }
+    g_array_append_val (stream->objects, object);
+  }
+  return TRUE;
+}
+
+static void
+replay_stream_advance (NvDsReplay * replay, ReplayStream * stream)
+{
+  if (stream->reader)
+    stream->has_frame = replay_read_log_frame (stream);
+  else
+    stream->has_frame = replay_read_kitti_frame (replay, stream);
+
+  stream->consumed = FALSE;
+  stream->frame.source_id = stream->source_id;
+  stream->frame.num_objects = stream->objects->len;
+  stream->frame.objects =
+      (const NvDsDetectionLogRecord *) stream->objects->data;
+}
+
+NvDsReplay *
+nvds_replay_open (NvDsReplayConfig * config)
+{
+  NvDsReplay *replay;
+  gboolean ok;
+  guint i;
+
+  if (!config->path)
+    return NULL;
+
+  replay = g_malloc0 (sizeof (NvDsReplay));
+  replay->speed = config->speed;
+  replay->kitti_fps = config->kitti_fps > 0 ? config->kitti_fps : 30;
+  replay->component_id = config->component_id;
+  replay->streams = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      replay_stream_free);
+  replay->batch = g_array_new (FALSE, FALSE, sizeof (NvDsReplayFrame));
+  if (config->labelfile_path)
+    replay->labels = replay_load_labels (config->labelfile_path);
+
+  if (g_file_test (config->path, G_FILE_TEST_IS_DIR))
+    ok = replay_add_dir (replay, config->path, config->instance);
+  else
+    ok = replay_add_log (replay, config->path);
+
+  if (!ok || replay->streams->len == 0) {
+    g_printerr ("replay: nothing to replay in %s\n", config->path);
+    nvds_replay_close (replay);
+    return NULL;
+  }
+
+  g_ptr_array_sort (replay->streams, replay_stream_compare);
+  for (i = 0; i < replay->streams->len; i++)
+    replay_stream_advance (replay, g_ptr_array_index (replay->streams, i));
+  replay->stats.num_streams = replay->streams->len;
+
+  g_print ("replay: %u streams from %s\n", replay->streams->len,
+      config->path);
+  return replay;
+}
+
+void
+nvds_replay_close (NvDsReplay * replay)
+{
+  if (!replay)
+    return;
+
+  g_ptr_array_free (replay->streams, TRUE);
+  g_array_free (replay->batch, TRUE);
+  if (replay->labels)
+    g_hash_table_destroy (replay->labels);
+  g_free (replay);
+}
+
+/**
+ * Sleep until a batch stamped @pts is due. The clock restarts on
+ * discontinuities so that a restarted recording neither stalls nor
+ * bursts.
+ */
+static void
+replay_pace (NvDsReplay * replay, guint64 pts)
+{
+  gint64 now = g_get_monotonic_time ();
+  gint64 due;
+
+  if (!replay->started) {
+    replay->started = TRUE;
+    replay->start_wall = now;
+    replay->base_wall = now;
+    replay->base_pts = pts;
+    replay->last_pts = pts;
+    return;
+  }
+
+  if (pts < replay->last_pts || pts - replay->last_pts > REPLAY_MAX_GAP_NS) {
+    replay->stats.num_discontinuities++;
+    replay->base_wall = now;
+    replay->base_pts = pts;
+  } else {
+    replay->stats.media_us += (pts - replay->last_pts) / 1000;
+  }
+  replay->last_pts = pts;
+
+  if (replay->speed <= 0)
+    return;
+
+  due = replay->base_wall +
+      (gint64) ((pts - replay->base_pts) / 1000 / replay->speed);
+  if (due > now) {
+    g_usleep (due - now);
+  } else if (now > due) {
+    replay->stats.num_late++;
+    replay->stats.max_lag_us = MAX (replay->stats.max_lag_us,
+        (guint64) (now - due));
+  }
+}
+
+guint
+nvds_replay_next_batch (NvDsReplay * replay, const NvDsReplayFrame ** frames)
+{
+  guint64 frame_num = G_MAXUINT64;
+  guint64 pts = G_MAXUINT64;
+  guint i;
+
+  for (i = 0; i < replay->streams->len; i++) {
+    ReplayStream *stream = g_ptr_array_index (replay->streams, i);
+
+    if (stream->consumed)
+      replay_stream_advance (replay, stream);
+    if (stream->has_frame)
+      frame_num = MIN (frame_num, stream->frame.frame_num);
+  }
+
+  g_array_set_size (replay->batch, 0);
+  if (frame_num == G_MAXUINT64) {
+    if (replay->started && !replay->end_wall)
+      replay->end_wall = g_get_monotonic_time ();
+    *frames = NULL;
+    return 0;
+  }
+
+  for (i = 0; i < replay->streams->len; i++) {
+    ReplayStream *stream = g_ptr_array_index (replay->streams, i);
+
+    if (!stream->has_frame || stream->frame.frame_num != frame_num)
+      continue;
+    g_array_append_val (replay->batch, stream->frame);
+    stream->consumed = TRUE;
+    pts = MIN (pts, stream->frame.pts);
+    replay->stats.num_frames++;
+    replay->stats.num_objects += stream->frame.num_objects;
+  }
+
+  replay_pace (replay, pts);
+  replay->stats.num_batches++;
+  *frames = (const NvDsReplayFrame *) replay->batch->data;
+  return replay->batch->len;
+}
+
+void
+nvds_replay_get_stats (NvDsReplay * replay, NvDsReplayStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsReplayStats));
+  if (!replay)
+    return;
+
+  *stats = replay->stats;
+  if (replay->started)
+    stats->wall_us = (replay->end_wall ? replay->end_wall :
+        g_get_monotonic_time ()) - replay->start_wall;
+}
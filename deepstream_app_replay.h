@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_REPLAY_H__
+#define __NVGSTDS_APP_REPLAY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_detlog.h"
+
+typedef struct
+{
+  /** A detection log, a directory of them, or a directory of KITTI files
+   * (either as written by [application] gie-kitti-output-dir or by the
+   * tracker variant). */
+  gchar *path;
+  /** Processing instance whose files to pick from a directory. */
+  guint instance;
+  /** Playback rate relative to the recorded PTS; 0 runs flat out. */
+  gdouble speed;
+  /** KITTI files carry no timestamps; frames are spaced at this rate. */
+  gdouble kitti_fps;
+  /** Maps KITTI labels back to class ids, one label per line or ';'
+   * separated. Unknown labels get class id -1. */
+  gchar *labelfile_path;
+  /** unique_component_id given to objects read from KITTI files. */
+  guint component_id;
+} NvDsReplayConfig;
+
+/** One recorded frame. Objects reuse the detection log record layout;
+ * only the object fields are meaningful. */
+typedef struct
+{
+  guint source_id;
+  guint64 frame_num;
+  guint64 pts;
+  guint num_objects;
+  const NvDsDetectionLogRecord *objects;
+} NvDsReplayFrame;
+
+typedef struct
+{
+  guint num_streams;
+  guint64 num_batches;
+  guint64 num_frames;
+  guint64 num_objects;
+  /** Timestamp jumps (backwards, or gaps over two seconds) that restarted
+   * the pacing clock. */
+  guint64 num_discontinuities;
+  /** Batches handed out after their due time, and by how much at most. */
+  guint64 num_late;
+  guint64 max_lag_us;
+  /** Wall time since the first batch and recorded time covered. */
+  guint64 wall_us;
+  guint64 media_us;
+} NvDsReplayStats;
+
+typedef struct _NvDsReplay NvDsReplay;
+
+NvDsReplay *nvds_replay_open (NvDsReplayConfig * config);
+
+void nvds_replay_close (NvDsReplay * replay);
+
+/**
+ * Wait until the next batch is due and return it in @frames. A batch holds
+ * the next frame of every stream at the lowest pending frame number, the
+ * way nvstreammux batches sources that run in step. The frames stay valid
+ * until the next call.
+ *
+ * @return number of frames in the batch, 0 at the end of the recording.
+ */
+guint nvds_replay_next_batch (NvDsReplay * replay,
+    const NvDsReplayFrame ** frames);
+
+void nvds_replay_get_stats (NvDsReplay * replay, NvDsReplayStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
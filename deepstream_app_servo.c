@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "deepstream_app_servo.h"
+
+#define DEFAULT_SERVO_DEVICE "/dev/ttyTHS1"
+#define DEFAULT_SERVO_BAUD_RATE 115200
+#define DEFAULT_SERVO_MOVE_TIME 0x000A
+
+#define SERVO_HEADER 0xFF
+#define SERVO_BROADCAST_ID 0xFE
+#define SERVO_CMD_WRITE 0x03
+#define SERVO_CMD_SYNC_WRITE 0x83
+#define SERVO_REG_GOAL_POSITION 0x2A
+/* Goal position (2 bytes) + move time (2 bytes). */
+#define SERVO_GOAL_DATA_LEN 4
+
+struct _NvDsServo
+{
+  gint fd;
+  guint move_time;
+  GMutex lock;
+  NvDsServoStats stats;
+};
+
+guint
+nvds_servo_clamp (guint id, gint position)
+{
+  switch (id) {
+    case NVDS_SERVO_PAN_ID:
+      return CLAMP (position, NVDS_SERVO_PAN_MIN, NVDS_SERVO_PAN_MAX);
+    case NVDS_SERVO_TILT_ID:
+      return CLAMP (position, NVDS_SERVO_TILT_MIN, NVDS_SERVO_TILT_MAX);
+    default:
+      return CLAMP (position, 0, 4095);
+  }
+}
+
+/**
+ * Checksum covers every byte after the two 0xFF headers: the bitwise
+ * inverse of their sum, truncated to 8 bits.
+ */
+static guint8
+servo_checksum (const guint8 * packet, gsize len)
+{
+  guint sum = 0;
+  gsize i;
+
+  for (i = 2; i < len; i++)
+    sum += packet[i];
+  return (~sum) & 0xFF;
+}
+
+static guint8 *
+servo_put_goal (guint8 * p, guint position, guint move_time)
+{
+  *p++ = (position >> 8) & 0xFF;
+  *p++ = position & 0xFF;
+  *p++ = (move_time >> 8) & 0xFF;
+  *p++ = move_time & 0xFF;
+  return p;
+}
+
+gsize
+nvds_servo_build_write_packet (guint8 * packet, gsize size,
+    const NvDsServoTarget * target, guint move_time)
+{
+  guint8 *p = packet;
+
+  if (size < 11)
+    return 0;
+
+  *p++ = SERVO_HEADER;
+  *p++ = SERVO_HEADER;
+  *p++ = target->id;
+  /* cmd + addr + goal data + checksum */
+  *p++ = 3 + SERVO_GOAL_DATA_LEN;
+  *p++ = SERVO_CMD_WRITE;
+  *p++ = SERVO_REG_GOAL_POSITION;
+  p = servo_put_goal (p, nvds_servo_clamp (target->id, target->position),
+      move_time);
+  *p = servo_checksum (packet, p - packet);
+  return p - packet + 1;
+}
+
+gsize
+nvds_servo_build_sync_write_packet (guint8 * packet, gsize size,
+    const NvDsServoTarget * targets, guint num_targets, guint move_time)
+{
+  guint8 *p = packet;
+  guint i;
+
+  if (num_targets == 0 || num_targets > NVDS_SERVO_MAX_SYNC_TARGETS ||
+      size < 8 + (SERVO_GOAL_DATA_LEN + 1) * num_targets)
+    return 0;
+
+  *p++ = SERVO_HEADER;
+  *p++ = SERVO_HEADER;
+  *p++ = SERVO_BROADCAST_ID;
+  *p++ = (SERVO_GOAL_DATA_LEN + 1) * num_targets + 4;
+  *p++ = SERVO_CMD_SYNC_WRITE;
+  *p++ = SERVO_REG_GOAL_POSITION;
+  *p++ = SERVO_GOAL_DATA_LEN;
+  for (i = 0; i < num_targets; i++) {
+    *p++ = targets[i].id;
+    p = servo_put_goal (p, nvds_servo_clamp (targets[i].id,
+            targets[i].position), move_time);
+  }
+  *p = servo_checksum (packet, p - packet);
+  return p - packet + 1;
+}
+
+static speed_t
+servo_baud_to_speed (guint baud_rate)
+{
+  switch (baud_rate) {
+    case 9600:
+      return B9600;
+    case 19200:
+      return B19200;
+    case 38400:
+      return B38400;
+    case 57600:
+      return B57600;
+    case 230400:
+      return B230400;
+    case 460800:
+      return B460800;
+    case 921600:
+      return B921600;
+    case 1000000:
+      return B1000000;
+    case 115200:
+    default:
+      return B115200;
+  }
+}
+
+static gboolean
+servo_configure_port (gint fd, guint baud_rate)
+{
+  struct termios tio;
+
+  if (tcgetattr (fd, &tio) < 0)
+    return FALSE;
+
+  cfmakeraw (&tio);
+  cfsetispeed (&tio, servo_baud_to_speed (baud_rate));
+  cfsetospeed (&tio, servo_baud_to_speed (baud_rate));
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+
+  if (tcsetattr (fd, TCSANOW, &tio) < 0)
+    return FALSE;
+  tcflush (fd, TCIOFLUSH);
+  return TRUE;
+}
+
+NvDsServo *
+nvds_servo_open (NvDsServoConfig * config)
+{
+  NvDsServo *servo;
+  const gchar *device;
+
+  if (!config->enable)
+    return NULL;
+
+  device = config->device ? config->device : DEFAULT_SERVO_DEVICE;
+
+  servo = g_malloc0 (sizeof (NvDsServo));
+  servo->move_time =
+      config->move_time ? config->move_time : DEFAULT_SERVO_MOVE_TIME;
+  g_mutex_init (&servo->lock);
+
+  servo->fd = open (device, O_RDWR | O_NOCTTY);
+  if (servo->fd < 0) {
+    g_printerr ("servo: cannot open %s: %s\n", device, strerror (errno));
+    goto error;
+  }
+  if (!servo_configure_port (servo->fd,
+          config->baud_rate ? config->baud_rate : DEFAULT_SERVO_BAUD_RATE)) {
+    g_printerr ("servo: cannot configure %s: %s\n", device, strerror (errno));
+    goto error;
+  }
+
+  g_print ("servo: %s ready\n", device);
+  return servo;
+
+error:
+  nvds_servo_close (servo);
+  return NULL;
+}
+
+void
+nvds_servo_close (NvDsServo * servo)
+{
+  if (!servo)
+    return;
+
+  if (servo->fd >= 0)
+    close (servo->fd);
+  g_mutex_clear (&servo->lock);
+  g_free (servo);
+}
+
+static gboolean
+servo_send (NvDsServo * servo, const guint8 * packet, gsize len)
+{
+  gboolean ret;
+  gint64 start, latency;
+
+  g_mutex_lock (&servo->lock);
+  start = g_get_monotonic_time ();
+  ret = write (servo->fd, packet, len) == (gssize) len;
+  latency = g_get_monotonic_time () - start;
+
+  servo->stats.num_packets++;
+  if (ret)
+    servo->stats.num_bytes += len;
+  else
+    servo->stats.num_failed++;
+  servo->stats.total_latency_us += latency;
+  if ((guint64) latency > servo->stats.max_latency_us)
+    servo->stats.max_latency_us = latency;
+  g_mutex_unlock (&servo->lock);
+
+  return ret;
+}
+
+gboolean
+nvds_servo_move (NvDsServo * servo, guint id, gint position)
+{
+  guint8 packet[NVDS_SERVO_MAX_PACKET_SIZE];
+  NvDsServoTarget target = { id, position };
+  gsize len;
+
+  if (!servo)
+    return FALSE;
+
+  len = nvds_servo_build_write_packet (packet, sizeof (packet), &target,
+      servo->move_time);
+  return servo_send (servo, packet, len);
+}
+
+gboolean
+nvds_servo_move_many (NvDsServo * servo, const NvDsServoTarget * targets,
+    guint num_targets)
+{
+  guint8 packet[NVDS_SERVO_MAX_PACKET_SIZE];
+  gsize len;
+
+  if (!servo)
+    return FALSE;
+
+  if (num_targets == 1)
+    return nvds_servo_move (servo, targets[0].id, targets[0].position);
+
+  len = nvds_servo_build_sync_write_packet (packet, sizeof (packet), targets,
+      num_targets, servo->move_time);
+  if (!len)
+    return FALSE;
+  return servo_send (servo, packet, len);
+}
+
+gboolean
+nvds_servo_pan_tilt (NvDsServo * servo, gint pan, gint tilt)
+{
+  NvDsServoTarget targets[2] = {
+    {NVDS_SERVO_PAN_ID, pan},
+    {NVDS_SERVO_TILT_ID, tilt},
+  };
+
+  return nvds_servo_move_many (servo, targets, 2);
+}
+
+void
+nvds_servo_get_stats (NvDsServo * servo, NvDsServoStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsServoStats));
+  if (!servo)
+    return;
+
+  g_mutex_lock (&servo->lock);
+  *stats = servo->stats;
+  g_mutex_unlock (&servo->lock);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_SERVO_H__
+#define __NVGSTDS_APP_SERVO_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+/** Servo ids used by the camera gimbal (see servoserial.py). */
+#define NVDS_SERVO_PAN_ID 1
+#define NVDS_SERVO_TILT_ID 2
+
+/** Safe pulse ranges enforced by Servo_serial_control(). */
+#define NVDS_SERVO_PAN_MIN 600
+#define NVDS_SERVO_PAN_MAX 3600
+#define NVDS_SERVO_TILT_MIN 1300
+#define NVDS_SERVO_TILT_MAX 4095
+
+/** Largest sync-write batch a single packet may carry. */
+#define NVDS_SERVO_MAX_SYNC_TARGETS 16
+#define NVDS_SERVO_MAX_PACKET_SIZE (8 + 5 * NVDS_SERVO_MAX_SYNC_TARGETS)
+
+typedef struct
+{
+  gboolean enable;
+  gchar *device;
+  guint baud_rate;
+  /** Move time written into every packet, in servo units. */
+  guint move_time;
+} NvDsServoConfig;
+
+typedef struct
+{
+  guint id;
+  gint position;
+} NvDsServoTarget;
+
+typedef struct
+{
+  guint64 num_packets;
+  guint64 num_failed;
+  guint64 num_bytes;
+  guint64 total_latency_us;
+  guint64 max_latency_us;
+} NvDsServoStats;
+
+typedef struct _NvDsServo NvDsServo;
+
+/**
+ * Clamp @position into the safe range of servo @id. Ids without a known
+ * range are limited to the 12-bit pulse range.
+ */
+guint nvds_servo_clamp (guint id, gint position);
+
+/**
+ * Build a single-servo write packet (cmd 0x03, register 0x2A) into @packet.
+ *
+ * @return number of bytes written, 0 if @size is too small.
+ */
+gsize nvds_servo_build_write_packet (guint8 * packet, gsize size,
+    const NvDsServoTarget * target, guint move_time);
+
+/**
+ * Build a sync-write packet (cmd 0x83, broadcast id 0xFE) that moves all
+ * @num_targets servos at once.
+ *
+ * @return number of bytes written, 0 if @size is too small or
+ *         @num_targets is out of range.
+ */
+gsize nvds_servo_build_sync_write_packet (guint8 * packet, gsize size,
+    const NvDsServoTarget * targets, guint num_targets, guint move_time);
+
+/**
+ * Open and configure the serial port. The fd stays open until
+ * nvds_servo_close(); the handle may be shared between threads.
+ */
+NvDsServo *nvds_servo_open (NvDsServoConfig * config);
+
+void nvds_servo_close (NvDsServo * servo);
+
+gboolean nvds_servo_move (NvDsServo * servo, guint id, gint position);
+
+/**
+ * Move several servos with one sync-write packet.
+ */
+gboolean nvds_servo_move_many (NvDsServo * servo,
+    const NvDsServoTarget * targets, guint num_targets);
+
+gboolean nvds_servo_pan_tilt (NvDsServo * servo, gint pan, gint tilt);
+
+void nvds_servo_get_stats (NvDsServo * servo, NvDsServoStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
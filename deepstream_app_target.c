@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+
+#include "deepstream_app_target.h"
+
+/* Object id the tracker leaves on objects it does not track. */
+#define TARGET_UNTRACKED_ID G_MAXUINT64
+
+#define TARGET_WEIGHT_SIZE 0.5
+#define TARGET_WEIGHT_CONFIDENCE 0.2
+#define TARGET_WEIGHT_CENTRALITY 0.3
+
+void
+nvds_target_selector_init (NvDsTargetSelector * sel, NvDsTargetConfig * config)
+{
+  memset (sel, 0, sizeof (NvDsTargetSelector));
+  sel->config = *config;
+  sel->config.switch_frames = MAX (config->switch_frames, 1);
+}
+
+gdouble
+nvds_target_score (const NvDsDetectionSample * sample, guint frame_width,
+    guint frame_height)
+{
+  gdouble area, dx, dy, centrality;
+
+  if (frame_width == 0 || frame_height == 0)
+    return 0;
+
+  /* sqrt keeps a person twice as close from scoring four times higher. */
+  area = sqrt ((sample->width * sample->height) /
+      ((gdouble) frame_width * frame_height));
+  dx = (sample->left + sample->width / 2) / frame_width - 0.5;
+  dy = (sample->top + sample->height / 2) / frame_height - 0.5;
+  centrality = 1 - MIN (sqrt (dx * dx + dy * dy) / sqrt (0.5), 1);
+
+  return TARGET_WEIGHT_SIZE * MIN (area, 1) +
+      TARGET_WEIGHT_CONFIDENCE * CLAMP (sample->confidence, 0, 1) +
+      TARGET_WEIGHT_CENTRALITY * centrality;
+}
+
+/**
+ * Find the slot of @object_id, or claim one: a free slot first, otherwise
+ * the one seen longest ago. The current target's slot is never recycled.
+ */
+static NvDsTargetTrack *
+target_track_get (NvDsTargetSelector * sel, guint source_id,
+    guint64 object_id)
+{
+  NvDsTargetTrack *oldest = NULL;
+  guint i;
+
+  for (i = 0; i < NVDS_TARGET_MAX_TRACKS; i++) {
+    NvDsTargetTrack *track = &sel->tracks[i];
+    if (track->in_use && track->source_id == source_id &&
+        track->object_id == object_id)
+      return track;
+  }
+
+  for (i = 0; i < NVDS_TARGET_MAX_TRACKS; i++) {
+    NvDsTargetTrack *track = &sel->tracks[i];
+    if (!track->in_use) {
+      oldest = track;
+      break;
+    }
+    if (sel->has_target && track->object_id == sel->target_id)
+      continue;
+    if (!oldest || track->last_update < oldest->last_update)
+      oldest = track;
+  }
+
+  if (oldest) {
+    oldest->object_id = object_id;
+    oldest->source_id = source_id;
+    oldest->lead_frames = 0;
+    oldest->in_use = TRUE;
+  }
+  return oldest;
+}
+
+/**
+ * The selection of nvds_target_selector_update(); @leader is set to the
+ * track of a challenger that led the target in this update.
+ */
+static gboolean
+target_select (NvDsTargetSelector * sel,
+    const NvDsDetectionSample * samples, guint num_samples,
+    guint frame_width, guint frame_height, NvDsDetectionSample * target,
+    NvDsTargetTrack ** leader)
+{
+  const NvDsDetectionSample *current = NULL;
+  const NvDsDetectionSample *best = NULL;
+  const NvDsDetectionSample *best_tracked = NULL;
+  gdouble current_score = 0, best_score = 0, best_tracked_score = 0;
+  gint frame;
+  guint i;
+
+  frame = samples[0].frame_num;
+  sel->last_frame = frame;
+  sel->stats.num_frames++;
+
+  for (i = 0; i < num_samples; i++) {
+    const NvDsDetectionSample *s = &samples[i];
+    gdouble score;
+
+    if (sel->config.class_id >= 0 && s->class_id != sel->config.class_id)
+      continue;
+
+    score = nvds_target_score (s, frame_width, frame_height);
+    if (s->object_id == TARGET_UNTRACKED_ID) {
+      if (!best || score > best_score) {
+        best = s;
+        best_score = score;
+      }
+      continue;
+    }
+
+    if (sel->has_target && s->object_id == sel->target_id) {
+      current = s;
+      current_score = score;
+    } else if (!best_tracked || score > best_tracked_score) {
+      best_tracked = s;
+      best_tracked_score = score;
+    }
+  }
+
+  /* Without tracker ids there is no identity to hold on to. */
+  if (!current && !best_tracked) {
+    if (!best)
+      goto missing;
+    *target = *best;
+    return TRUE;
+  }
+
+  if (current) {
+    sel->target_last_frame = frame;
+
+    if (best_tracked &&
+        best_tracked_score > current_score + sel->config.switch_margin) {
+      NvDsTargetTrack *track = target_track_get (sel,
+          best_tracked->source_id, best_tracked->object_id);
+
+      if (track) {
+        track->last_update = sel->num_updates;
+        track->lead_frames++;
+        *leader = track;
+      }
+      if (!track || track->lead_frames < sel->config.switch_frames) {
+        sel->stats.num_held++;
+        *target = *current;
+        return TRUE;
+      }
+      goto take_challenger;
+    }
+
+    *target = *current;
+    return TRUE;
+  }
+
+missing:
+  if (sel->has_target &&
+      (guint) (frame - sel->target_last_frame) <= sel->config.lost_frames)
+    return FALSE;
+  if (sel->has_target) {
+    sel->has_target = FALSE;
+    sel->stats.num_lost++;
+  }
+  if (!best_tracked)
+    return FALSE;
+
+take_challenger:
+  if (sel->has_target)
+    sel->stats.num_switches++;
+  sel->has_target = TRUE;
+  sel->target_id = best_tracked->object_id;
+  sel->target_last_frame = frame;
+  for (i = 0; i < NVDS_TARGET_MAX_TRACKS; i++)
+    sel->tracks[i].lead_frames = 0;
+  *target = *best_tracked;
+  return TRUE;
+}
+
+gboolean
+nvds_target_selector_update (NvDsTargetSelector * sel,
+    const NvDsDetectionSample * samples, guint num_samples,
+    guint frame_width, guint frame_height, NvDsDetectionSample * target)
+{
+  NvDsTargetTrack *leader = NULL;
+  gboolean ret;
+  guint i;
+
+  if (num_samples == 0)
+    return FALSE;
+
+  sel->num_updates++;
+  ret = target_select (sel, samples, num_samples, frame_width, frame_height,
+      target, &leader);
+
+  /* A lead is broken by an update of the same source in which the
+   * challenger did not lead, not by frame numbers the caller skipped. */
+  for (i = 0; i < NVDS_TARGET_MAX_TRACKS; i++) {
+    NvDsTargetTrack *track = &sel->tracks[i];
+
+    if (track != leader && track->in_use &&
+        track->source_id == samples[0].source_id)
+      track->lead_frames = 0;
+  }
+  return ret;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_TARGET_H__
+#define __NVGSTDS_APP_TARGET_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_detection.h"
+
+/** Tracks remembered at once; older ones are recycled. */
+#define NVDS_TARGET_MAX_TRACKS 32
+
+typedef struct
+{
+  /** Only objects of this class can be followed; -1 accepts any class. */
+  gint class_id;
+  /** Score lead a challenger needs over the current target. */
+  gdouble switch_margin;
+  /** Consecutive frames the challenger must hold that lead. */
+  guint switch_frames;
+  /** Frames the current target may be missing before it is given up. */
+  guint lost_frames;
+} NvDsTargetConfig;
+
+typedef struct
+{
+  guint64 num_frames;
+  guint64 num_switches;
+  guint64 num_lost;
+  /** Frames where a challenger led but had not yet held it long enough. */
+  guint64 num_held;
+} NvDsTargetStats;
+
+typedef struct
+{
+  guint64 object_id;
+  guint source_id;
+  /** Selector update the track last led in, for recycling slots. */
+  guint64 last_update;
+  /** Updates of its source in a row in which it led the target. */
+  guint lead_frames;
+  gboolean in_use;
+} NvDsTargetTrack;
+
+typedef struct
+{
+  NvDsTargetConfig config;
+  NvDsTargetTrack tracks[NVDS_TARGET_MAX_TRACKS];
+  gboolean has_target;
+  guint64 target_id;
+  gint target_last_frame;
+  gint last_frame;
+  guint64 num_updates;
+  NvDsTargetStats stats;
+} NvDsTargetSelector;
+
+void nvds_target_selector_init (NvDsTargetSelector * sel,
+    NvDsTargetConfig * config);
+
+/**
+ * Score one detection by size, confidence and distance from the image
+ * centre; higher is better, roughly in [0, 1].
+ */
+gdouble nvds_target_score (const NvDsDetectionSample * sample,
+    guint frame_width, guint frame_height);
+
+/**
+ * Feed all @num_samples detections of one frame and pick the object to
+ * follow. The current target is kept while it is visible; a challenger
+ * takes over only after out-scoring it by the configured margin in that
+ * many updates of its source in a row, or once the target has been
+ * missing for lost_frames. Frames the caller skips do not break a lead.
+ * Objects without a tracker id are scored per frame.
+ *
+ * @return TRUE and the chosen sample in @target, FALSE if nothing should be
+ *         followed in this frame.
+ */
+gboolean nvds_target_selector_update (NvDsTargetSelector * sel,
+    const NvDsDetectionSample * samples, guint num_samples,
+    guint frame_width, guint frame_height, NvDsDetectionSample * target);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
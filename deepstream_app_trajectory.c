@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "deepstream_app_trajectory.h"
+
+#define TRAJECTORY_UNTRACKED_ID G_MAXUINT64
+#define TRAJECTORY_EMPTY -1
+
+/**
+ * Index slot. Linear probing over a power-of-two table at most half full;
+ * deletion shifts later entries back instead of leaving tombstones, so
+ * probe lengths do not grow as tracks come and go.
+ */
+typedef struct
+{
+  guint64 object_id;
+  guint source_id;
+  guint32 hash;
+  gint track;
+} TrajectorySlot;
+
+struct _NvDsTrajectoryStore
+{
+  guint max_tracks;
+  guint history_len;
+  guint expire_frames;
+  guint64 tick;
+
+  TrajectorySlot *index;
+  guint index_mask;
+
+  /* Arena: track headers followed by every track's point ring. */
+  gpointer arena;
+  NvDsTrajectory *tracks;
+  gint free_list;
+  /* Most / least recently updated tracks. */
+  gint newest;
+  gint oldest;
+
+  NvDsTrajectoryStats stats;
+};
+
+static inline guint32
+trajectory_hash (guint source_id, guint64 object_id)
+{
+  guint64 h = (object_id ^ ((guint64) source_id << 48)) *
+      G_GUINT64_CONSTANT (0x9E3779B97F4A7C15);
+  return (guint32) (h >> 32);
+}
+
+NvDsTrajectoryStore *
+nvds_trajectory_store_new (guint max_tracks, guint history_len,
+    guint expire_frames)
+{
+  NvDsTrajectoryStore *store;
+  NvDsTrajectoryPoint *points;
+  guint index_size = 1;
+  guint i;
+
+  if (max_tracks == 0 || history_len == 0)
+    return NULL;
+
+  while (index_size < 2 * max_tracks)
+    index_size <<= 1;
+
+  store = g_malloc0 (sizeof (NvDsTrajectoryStore));
+  store->max_tracks = max_tracks;
+  store->history_len = history_len;
+  store->expire_frames = expire_frames;
+  store->index = g_malloc (index_size * sizeof (TrajectorySlot));
+  store->index_mask = index_size - 1;
+  for (i = 0; i < index_size; i++)
+    store->index[i].track = TRAJECTORY_EMPTY;
+
+  store->arena = g_malloc0 (max_tracks * (sizeof (NvDsTrajectory) +
+          history_len * sizeof (NvDsTrajectoryPoint)));
+  store->tracks = store->arena;
+  points = (NvDsTrajectoryPoint *) (store->tracks + max_tracks);
+  for (i = 0; i < max_tracks; i++) {
+    store->tracks[i].points = points + i * history_len;
+    store->tracks[i].history_len = history_len;
+    store->tracks[i].next = i + 1 < max_tracks ? (gint) i + 1 : -1;
+  }
+  store->free_list = 0;
+  store->newest = store->oldest = -1;
+  return store;
+}
+
+void
+nvds_trajectory_store_free (NvDsTrajectoryStore * store)
+{
+  if (!store)
+    return;
+
+  g_free (store->index);
+  g_free (store->arena);
+  g_free (store);
+}
+
+static TrajectorySlot *
+trajectory_find_slot (NvDsTrajectoryStore * store, guint source_id,
+    guint64 object_id, guint32 hash)
+{
+  guint i = hash & store->index_mask;
+  guint probe = 0;
+
+  while (store->index[i].track != TRAJECTORY_EMPTY) {
+    TrajectorySlot *slot = &store->index[i];
+    if (slot->hash == hash && slot->object_id == object_id &&
+        slot->source_id == source_id)
+      break;
+    i = (i + 1) & store->index_mask;
+    probe++;
+  }
+  if (probe > store->stats.max_probe)
+    store->stats.max_probe = probe;
+  return &store->index[i];
+}
+
+static void
+trajectory_unlink (NvDsTrajectoryStore * store, gint t)
+{
+  NvDsTrajectory *track = &store->tracks[t];
+
+  if (track->prev >= 0)
+    store->tracks[track->prev].next = track->next;
+  else
+    store->newest = track->next;
+  if (track->next >= 0)
+    store->tracks[track->next].prev = track->prev;
+  else
+    store->oldest = track->prev;
+}
+
+static void
+trajectory_push_newest (NvDsTrajectoryStore * store, gint t)
+{
+  NvDsTrajectory *track = &store->tracks[t];
+
+  track->prev = -1;
+  track->next = store->newest;
+  if (store->newest >= 0)
+    store->tracks[store->newest].prev = t;
+  else
+    store->oldest = t;
+  store->newest = t;
+}
+
+const NvDsTrajectory *
+nvds_trajectory_store_add (NvDsTrajectoryStore * store,
+    const NvDsDetectionSample * sample)
+{
+  NvDsTrajectory *track;
+  NvDsTrajectoryPoint *point;
+  TrajectorySlot *slot;
+  guint32 hash;
+  gint t;
+
+  if (!store || sample->object_id == TRAJECTORY_UNTRACKED_ID)
+    return NULL;
+
+  hash = trajectory_hash (sample->source_id, sample->object_id);
+  slot = trajectory_find_slot (store, sample->source_id, sample->object_id,
+      hash);
+
+  if (slot->track == TRAJECTORY_EMPTY) {
+    if (store->free_list < 0) {
+      store->stats.num_rejected++;
+      return NULL;
+    }
+    t = store->free_list;
+    track = &store->tracks[t];
+    store->free_list = track->next;
+
+    track->source_id = sample->source_id;
+    track->object_id = sample->object_id;
+    track->head = 0;
+    track->count = 0;
+    trajectory_push_newest (store, t);
+
+    slot->object_id = sample->object_id;
+    slot->source_id = sample->source_id;
+    slot->hash = hash;
+    slot->track = t;
+    store->stats.num_tracks++;
+    store->stats.num_created++;
+  } else {
+    t = slot->track;
+    track = &store->tracks[t];
+    if (store->newest != t) {
+      trajectory_unlink (store, t);
+      trajectory_push_newest (store, t);
+    }
+  }
+
+  point = &track->points[track->head];
+  point->frame_num = sample->frame_num;
+  point->pts = sample->pts;
+  point->left = sample->left;
+  point->top = sample->top;
+  point->width = sample->width;
+  point->height = sample->height;
+  track->head = (track->head + 1) % store->history_len;
+  track->count = MIN (track->count + 1, store->history_len);
+  track->last_tick = store->tick;
+  store->stats.num_points++;
+  return track;
+}
+
+const NvDsTrajectory *
+nvds_trajectory_store_lookup (NvDsTrajectoryStore * store, guint source_id,
+    guint64 object_id)
+{
+  TrajectorySlot *slot;
+
+  if (!store)
+    return NULL;
+
+  slot = trajectory_find_slot (store, source_id, object_id,
+      trajectory_hash (source_id, object_id));
+  if (slot->track == TRAJECTORY_EMPTY)
+    return NULL;
+  return &store->tracks[slot->track];
+}
+
+/** Remove the entry at @i and shift back the entries probing past it. */
+static void
+trajectory_index_remove (NvDsTrajectoryStore * store, guint i)
+{
+  guint j = i;
+
+  store->index[i].track = TRAJECTORY_EMPTY;
+  for (;;) {
+    guint home;
+
+    j = (j + 1) & store->index_mask;
+    if (store->index[j].track == TRAJECTORY_EMPTY)
+      break;
+    home = store->index[j].hash & store->index_mask;
+    /* Entry j may stay only if its home lies cyclically in (i, j]. */
+    if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+      continue;
+    store->index[i] = store->index[j];
+    store->index[j].track = TRAJECTORY_EMPTY;
+    i = j;
+  }
+}
+
+void
+nvds_trajectory_store_end_frame (NvDsTrajectoryStore * store)
+{
+  if (!store)
+    return;
+
+  store->tick++;
+  while (store->oldest >= 0 &&
+      store->tick - store->tracks[store->oldest].last_tick >
+      store->expire_frames) {
+    gint t = store->oldest;
+    NvDsTrajectory *track = &store->tracks[t];
+    TrajectorySlot *slot = trajectory_find_slot (store, track->source_id,
+        track->object_id, trajectory_hash (track->source_id,
+            track->object_id));
+
+    trajectory_index_remove (store, slot - store->index);
+    trajectory_unlink (store, t);
+    track->next = store->free_list;
+    store->free_list = t;
+    store->stats.num_tracks--;
+    store->stats.num_expired++;
+  }
+}
+
+void
+nvds_trajectory_store_get_stats (NvDsTrajectoryStore * store,
+    NvDsTrajectoryStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsTrajectoryStats));
+  if (store)
+    *stats = store->stats;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_TRAJECTORY_H__
+#define __NVGSTDS_APP_TRAJECTORY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_detection.h"
+
+typedef struct
+{
+  gint frame_num;
+  guint64 pts;
+  gfloat left;
+  gfloat top;
+  gfloat width;
+  gfloat height;
+} NvDsTrajectoryPoint;
+
+/**
+ * History of one tracked object. Owned by the store; valid until the next
+ * nvds_trajectory_store_end_frame() call that expires it.
+ */
+typedef struct
+{
+  guint source_id;
+  guint64 object_id;
+  /** Ring of the last history_len points; see nvds_trajectory_point(). */
+  NvDsTrajectoryPoint *points;
+  guint history_len;
+  guint head;
+  guint count;
+  guint64 last_tick;
+  /* Recency list links, slot numbers or -1. */
+  gint prev;
+  gint next;
+} NvDsTrajectory;
+
+typedef struct
+{
+  guint num_tracks;
+  guint64 num_points;
+  guint64 num_created;
+  guint64 num_expired;
+  /** Points dropped because every track slot was taken. */
+  guint64 num_rejected;
+  /** Longest probe sequence seen in the index. */
+  guint max_probe;
+} NvDsTrajectoryStats;
+
+typedef struct _NvDsTrajectoryStore NvDsTrajectoryStore;
+
+/**
+ * Allocate a store for up to @max_tracks objects of @history_len points
+ * each, in one arena. Tracks not updated for @expire_frames frames are
+ * dropped. Nothing is allocated after this call.
+ *
+ * The store is not locked; use it from a single thread (the analytics
+ * probe).
+ */
+NvDsTrajectoryStore *nvds_trajectory_store_new (guint max_tracks,
+    guint history_len, guint expire_frames);
+
+void nvds_trajectory_store_free (NvDsTrajectoryStore * store);
+
+/**
+ * Append @sample to its object's trajectory, creating the track if needed.
+ * Samples without a tracker id are ignored.
+ *
+ * @return the updated trajectory, NULL if ignored or the store is full.
+ */
+const NvDsTrajectory *nvds_trajectory_store_add (NvDsTrajectoryStore * store,
+    const NvDsDetectionSample * sample);
+
+const NvDsTrajectory *nvds_trajectory_store_lookup (NvDsTrajectoryStore *
+    store, guint source_id, guint64 object_id);
+
+/**
+ * Close the current frame, i.e. the current batch when several sources
+ * share the store, and expire tracks that have not been updated for
+ * expire_frames frames.
+ */
+void nvds_trajectory_store_end_frame (NvDsTrajectoryStore * store);
+
+void nvds_trajectory_store_get_stats (NvDsTrajectoryStore * store,
+    NvDsTrajectoryStats * stats);
+
+/**
+ * @return the point @age frames back (0 = newest), NULL past the history.
+ */
+static inline const NvDsTrajectoryPoint *
+nvds_trajectory_point (const NvDsTrajectory * traj, guint age)
+{
+  if (age >= traj->count)
+    return NULL;
+  return &traj->points[(traj->head + traj->history_len - 1 - age) %
+      traj->history_len];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
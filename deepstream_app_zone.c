@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "deepstream_app_zone.h"
+
+#define ZONE_UNTRACKED_ID G_MAXUINT64
+/* 16x16 pixel cells: 8160 cells for a 1920x1080 stream. */
+#define ZONE_CELL_SHIFT 4
+#define ZONE_CELL_SIZE (1 << ZONE_CELL_SHIFT)
+/* A track not seen for this long is free for reuse. */
+#define ZONE_TRACK_TIMEOUT_SEC 5.0
+
+/**
+ * Per-stream lookup grid. For every cell, @inside holds the zones that
+ * contain the whole cell and @edge the zones whose border crosses it; only
+ * the latter need an exact point-in-polygon test.
+ */
+typedef struct
+{
+  guint32 *inside;
+  guint32 *edge;
+  guint32 zones;
+} ZoneGrid;
+
+typedef struct
+{
+  guint source_id;
+  guint64 object_id;
+  gboolean in_use;
+  gdouble last_time;
+  guint32 inside;
+  guint32 lingered;
+  gdouble enter_time[NVDS_MAX_ZONES];
+} ZoneTrack;
+
+struct _NvDsZoneEngine
+{
+  NvDsZoneConfig zones[NVDS_MAX_ZONES];
+  guint num_zones;
+  guint width;
+  guint height;
+  guint cols;
+  guint rows;
+  /** Indexed by source id; NULL for streams without zones. */
+  ZoneGrid **grids;
+  guint num_grids;
+  ZoneTrack tracks[NVDS_ZONE_MAX_TRACKS];
+  NvDsZoneStats stats;
+};
+
+static gboolean
+zone_contains (const NvDsZoneConfig * zone, gfloat x, gfloat y)
+{
+  gboolean in = FALSE;
+  guint i, j;
+
+  for (i = 0, j = zone->num_points - 1; i < zone->num_points; j = i++) {
+    gfloat xi = zone->points_x[i], yi = zone->points_y[i];
+    gfloat xj = zone->points_x[j], yj = zone->points_y[j];
+
+    if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi)
+      in = !in;
+  }
+  return in;
+}
+
+/** Liang-Barsky clip of segment (x0, y0)-(x1, y1) against a rectangle. */
+static gboolean
+zone_segment_hits_rect (gfloat x0, gfloat y0, gfloat x1, gfloat y1,
+    gfloat rx0, gfloat ry0, gfloat rx1, gfloat ry1)
+{
+  gfloat p[4] = { x0 - x1, x1 - x0, y0 - y1, y1 - y0 };
+  gfloat q[4] = { x0 - rx0, rx1 - x0, y0 - ry0, ry1 - y0 };
+  gfloat t0 = 0, t1 = 1;
+  guint i;
+
+  for (i = 0; i < 4; i++) {
+    gfloat r;
+
+    if (p[i] == 0) {
+      if (q[i] < 0)
+        return FALSE;
+      continue;
+    }
+    r = q[i] / p[i];
+    if (p[i] < 0) {
+      if (r > t1)
+        return FALSE;
+      t0 = MAX (t0, r);
+    } else {
+      if (r < t0)
+        return FALSE;
+      t1 = MIN (t1, r);
+    }
+  }
+  return TRUE;
+}
+
+static void
+zone_grid_add (NvDsZoneEngine * engine, ZoneGrid * grid, guint z)
+{
+  const NvDsZoneConfig *zone = &engine->zones[z];
+  guint32 bit = 1u << z;
+  guint row, col, i, j;
+
+  grid->zones |= bit;
+  for (row = 0; row < engine->rows; row++) {
+    for (col = 0; col < engine->cols; col++) {
+      gfloat x0 = col * ZONE_CELL_SIZE, y0 = row * ZONE_CELL_SIZE;
+      gfloat x1 = x0 + ZONE_CELL_SIZE, y1 = y0 + ZONE_CELL_SIZE;
+      guint cell = row * engine->cols + col;
+      gboolean crossed = FALSE;
+
+      for (i = 0, j = zone->num_points - 1; i < zone->num_points && !crossed;
+          j = i++) {
+        crossed = zone_segment_hits_rect (zone->points_x[j], zone->points_y[j],
+            zone->points_x[i], zone->points_y[i], x0, y0, x1, y1);
+      }
+
+      if (crossed)
+        grid->edge[cell] |= bit;
+      else if (zone_contains (zone, x0 + ZONE_CELL_SIZE / 2.0,
+              y0 + ZONE_CELL_SIZE / 2.0))
+        grid->inside[cell] |= bit;
+    }
+  }
+}
+
+NvDsZoneEngine *
+nvds_zone_engine_new (NvDsZoneConfig * zones, guint num_zones,
+    guint frame_width, guint frame_height)
+{
+  NvDsZoneEngine *engine;
+  guint i;
+
+  if (frame_width == 0 || frame_height == 0)
+    return NULL;
+
+  engine = g_malloc0 (sizeof (NvDsZoneEngine));
+  engine->width = frame_width;
+  engine->height = frame_height;
+  engine->cols = (frame_width + ZONE_CELL_SIZE - 1) >> ZONE_CELL_SHIFT;
+  engine->rows = (frame_height + ZONE_CELL_SIZE - 1) >> ZONE_CELL_SHIFT;
+
+  for (i = 0; i < num_zones && engine->num_zones < NVDS_MAX_ZONES; i++) {
+    if (zones[i].enable && zones[i].num_points >= 3)
+      engine->zones[engine->num_zones++] = zones[i];
+  }
+  if (engine->num_zones == 0) {
+    g_free (engine);
+    return NULL;
+  }
+
+  for (i = 0; i < engine->num_zones; i++)
+    engine->num_grids = MAX (engine->num_grids, engine->zones[i].source_id + 1);
+  engine->grids = g_malloc0 (engine->num_grids * sizeof (ZoneGrid *));
+
+  for (i = 0; i < engine->num_zones; i++) {
+    guint source_id = engine->zones[i].source_id;
+    ZoneGrid *grid = engine->grids[source_id];
+
+    if (!grid) {
+      grid = g_malloc0 (sizeof (ZoneGrid));
+      grid->inside = g_malloc0 (engine->cols * engine->rows * sizeof (guint32));
+      grid->edge = g_malloc0 (engine->cols * engine->rows * sizeof (guint32));
+      engine->grids[source_id] = grid;
+    }
+    zone_grid_add (engine, grid, i);
+  }
+  return engine;
+}
+
+void
+nvds_zone_engine_free (NvDsZoneEngine * engine)
+{
+  guint i;
+
+  if (!engine)
+    return;
+
+  for (i = 0; i < engine->num_grids; i++) {
+    if (engine->grids[i]) {
+      g_free (engine->grids[i]->inside);
+      g_free (engine->grids[i]->edge);
+      g_free (engine->grids[i]);
+    }
+  }
+  g_free (engine->grids);
+  g_free (engine);
+}
+
+guint32
+nvds_zone_engine_lookup (NvDsZoneEngine * engine, guint source_id, gfloat x,
+    gfloat y)
+{
+  ZoneGrid *grid;
+  guint cell;
+  guint32 mask, edge;
+
+  if (!engine || source_id >= engine->num_grids || !engine->grids[source_id])
+    return 0;
+
+  grid = engine->grids[source_id];
+  x = CLAMP (x, 0, engine->width - 1);
+  y = CLAMP (y, 0, engine->height - 1);
+  cell = ((guint) y >> ZONE_CELL_SHIFT) * engine->cols +
+      ((guint) x >> ZONE_CELL_SHIFT);
+
+  engine->stats.num_lookups++;
+  mask = grid->inside[cell];
+  edge = grid->edge[cell];
+  while (edge) {
+    gint z = g_bit_nth_lsf (edge, -1);
+
+    engine->stats.num_exact_tests++;
+    if (zone_contains (&engine->zones[z], x, y))
+      mask |= 1u << z;
+    edge &= ~(1u << z);
+  }
+  return mask;
+}
+
+static ZoneTrack *
+zone_track_get (NvDsZoneEngine * engine, guint source_id, guint64 object_id,
+    gdouble now)
+{
+  ZoneTrack *free_slot = NULL;
+  ZoneTrack *stalest = NULL;
+  ZoneTrack *track;
+  guint i;
+
+  for (i = 0; i < NVDS_ZONE_MAX_TRACKS; i++) {
+    track = &engine->tracks[i];
+    if (!track->in_use) {
+      if (!free_slot)
+        free_slot = track;
+      continue;
+    }
+    if (track->object_id == object_id && track->source_id == source_id)
+      return track;
+    if (!free_slot && now - track->last_time > ZONE_TRACK_TIMEOUT_SEC)
+      free_slot = track;
+    if (!stalest || track->last_time < stalest->last_time)
+      stalest = track;
+  }
+
+  track = free_slot;
+  if (!track) {
+    track = stalest;
+    engine->stats.num_evictions++;
+  }
+
+  memset (track, 0, sizeof (ZoneTrack));
+  track->source_id = source_id;
+  track->object_id = object_id;
+  track->in_use = TRUE;
+  return track;
+}
+
+static gboolean
+zone_is_active (const NvDsZoneConfig * zone, gint hour)
+{
+  if (zone->start_hour == zone->end_hour)
+    return TRUE;
+  if (zone->start_hour < zone->end_hour)
+    return hour >= zone->start_hour && hour < zone->end_hour;
+  return hour >= zone->start_hour || hour < zone->end_hour;
+}
+
+static guint
+zone_emit (NvDsZoneEngine * engine, NvDsZoneEvent * events, guint n,
+    guint max_events, NvDsZoneEventType type, guint z,
+    const NvDsDetectionSample * sample, gdouble dwell)
+{
+  if (n >= max_events)
+    return n;
+
+  events[n].type = type;
+  events[n].zone = z;
+  events[n].zone_name = engine->zones[z].name;
+  events[n].source_id = sample->source_id;
+  events[n].object_id = sample->object_id;
+  events[n].frame_num = sample->frame_num;
+  events[n].dwell_sec = dwell;
+  engine->stats.num_events++;
+  return n + 1;
+}
+
+guint
+nvds_zone_engine_update (NvDsZoneEngine * engine,
+    const NvDsDetectionSample * sample, gint local_hour,
+    NvDsZoneEvent * events, guint max_events)
+{
+  ZoneTrack *track;
+  guint32 mask, bits;
+  gdouble now;
+  guint n = 0;
+
+  if (!engine || sample->object_id == ZONE_UNTRACKED_ID ||
+      sample->source_id >= engine->num_grids ||
+      !engine->grids[sample->source_id])
+    return 0;
+
+  now = (gdouble) sample->pts / 1e9;
+  mask = nvds_zone_engine_lookup (engine, sample->source_id,
+      sample->left + sample->width / 2, sample->top + sample->height);
+  track = zone_track_get (engine, sample->source_id, sample->object_id, now);
+  track->last_time = now;
+
+  /* Entered */
+  for (bits = mask & ~track->inside; bits; bits &= bits - 1)
+    track->enter_time[g_bit_nth_lsf (bits, -1)] = now;
+
+  /* Left */
+  for (bits = track->inside & ~mask; bits; bits &= bits - 1) {
+    gint z = g_bit_nth_lsf (bits, -1);
+    NvDsZoneConfig *zone = &engine->zones[z];
+    gdouble dwell = now - track->enter_time[z];
+
+    if (zone->leave_after_sec > 0 && dwell >= zone->leave_after_sec &&
+        zone_is_active (zone, local_hour))
+      n = zone_emit (engine, events, n, max_events, NV_DS_ZONE_EVENT_LEAVE, z,
+          sample, dwell);
+  }
+  track->lingered &= mask;
+
+  /* Stayed */
+  for (bits = mask & track->inside & ~track->lingered; bits; bits &= bits - 1) {
+    gint z = g_bit_nth_lsf (bits, -1);
+    NvDsZoneConfig *zone = &engine->zones[z];
+    gdouble dwell = now - track->enter_time[z];
+
+    if (zone->linger_sec > 0 && dwell >= zone->linger_sec &&
+        zone_is_active (zone, local_hour)) {
+      track->lingered |= 1u << z;
+      n = zone_emit (engine, events, n, max_events, NV_DS_ZONE_EVENT_LINGER, z,
+          sample, dwell);
+    }
+  }
+
+  track->inside = mask;
+  return n;
+}
+
+void
+nvds_zone_engine_get_stats (NvDsZoneEngine * engine, NvDsZoneStats * stats)
+{
+  memset (stats, 0, sizeof (NvDsZoneStats));
+  if (engine)
+    *stats = engine->stats;
+}
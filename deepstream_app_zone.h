@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_ZONE_H__
+#define __NVGSTDS_APP_ZONE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+#include "deepstream_app_detection.h"
+
+/** Zones are kept as bits of a guint32 mask. */
+#define NVDS_MAX_ZONES 32
+#define NVDS_ZONE_MAX_POINTS 16
+/** Tracks whose dwell time is accumulated at once. */
+#define NVDS_ZONE_MAX_TRACKS 64
+
+typedef struct
+{
+  gboolean enable;
+  gchar *name;
+  guint source_id;
+  /** Polygon in streammux pixel coordinates. */
+  guint num_points;
+  gfloat points_x[NVDS_ZONE_MAX_POINTS];
+  gfloat points_y[NVDS_ZONE_MAX_POINTS];
+  /** Raise "lingering" after this long inside; 0 disables. */
+  gdouble linger_sec;
+  /** Raise "left" when a track that stayed at least this long walks out;
+   * 0 disables. */
+  gdouble leave_after_sec;
+  /** Local hours during which the zone raises events; start == end means
+   * always. The range may wrap midnight, e.g. 22 to 6. */
+  gint start_hour;
+  gint end_hour;
+} NvDsZoneConfig;
+
+typedef enum
+{
+  NV_DS_ZONE_EVENT_LINGER,
+  NV_DS_ZONE_EVENT_LEAVE,
+} NvDsZoneEventType;
+
+typedef struct
+{
+  NvDsZoneEventType type;
+  guint zone;
+  const gchar *zone_name;
+  guint source_id;
+  guint64 object_id;
+  gint frame_num;
+  gdouble dwell_sec;
+} NvDsZoneEvent;
+
+typedef struct
+{
+  guint64 num_lookups;
+  /** Lookups that hit a cell crossed by a zone edge and needed an exact
+   * polygon test. */
+  guint64 num_exact_tests;
+  guint64 num_events;
+  guint64 num_evictions;
+} NvDsZoneStats;
+
+typedef struct _NvDsZoneEngine NvDsZoneEngine;
+
+/**
+ * Build the lookup grids of every stream that has an enabled zone.
+ *
+ * @return NULL if no zone is enabled.
+ */
+NvDsZoneEngine *nvds_zone_engine_new (NvDsZoneConfig * zones,
+    guint num_zones, guint frame_width, guint frame_height);
+
+void nvds_zone_engine_free (NvDsZoneEngine * engine);
+
+/**
+ * @return the mask of zones of @source_id containing (@x, @y).
+ */
+guint32 nvds_zone_engine_lookup (NvDsZoneEngine * engine, guint source_id,
+    gfloat x, gfloat y);
+
+/**
+ * Update the dwell accumulators of @sample's track, using the bottom
+ * centre of its bbox as the position. @local_hour gates time-of-day
+ * zones.
+ *
+ * @return number of events written to @events, at most @max_events.
+ */
+guint nvds_zone_engine_update (NvDsZoneEngine * engine,
+    const NvDsDetectionSample * sample, gint local_hour,
+    NvDsZoneEvent * events, guint max_events);
+
+void nvds_zone_engine_get_stats (NvDsZoneEngine * engine,
+    NvDsZoneStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
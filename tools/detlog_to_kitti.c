@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Convert a binary detection log back into per-frame KITTI label files,
+ * named and formatted exactly like the gie-kitti-output-dir and
+ * kitti-track-output-dir outputs of deepstream-app.
+ *
+ *   ./tools/detlog-to-kitti [-t] <log> <output-dir> [first-frame [last-frame]]
+ *
+ * -t writes the tracker id after the label, as kitti-track-output-dir does.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deepstream_app_detlog.h"
+
+static void
+usage (void)
+{
+  g_printerr ("usage: detlog-to-kitti [-t] <log> <output-dir> "
+      "[first-frame [last-frame]]\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+  const NvDsDetectionLogHeader *header;
+  NvDsDetectionLogReader *reader;
+  NvDsDetectionLogRecord record;
+  gboolean track = FALSE;
+  guint64 first = 0, last = G_MAXUINT64;
+  guint64 num_frames = 0, num_objects = 0;
+  FILE *out = NULL;
+  gchar path[1024];
+
+  if (argc > 1 && !strcmp (argv[1], "-t")) {
+    track = TRUE;
+    argc--;
+    argv++;
+  }
+  if (argc < 3) {
+    usage ();
+    return 1;
+  }
+  if (argc > 3)
+    first = g_ascii_strtoull (argv[3], NULL, 10);
+  if (argc > 4)
+    last = g_ascii_strtoull (argv[4], NULL, 10);
+
+  reader = nvds_detection_log_reader_open (argv[1]);
+  if (!reader)
+    return 1;
+  header = nvds_detection_log_reader_get_header (reader);
+
+  if (first && !nvds_detection_log_reader_seek (reader, first)) {
+    g_printerr ("no frame at or after %" G_GUINT64_FORMAT "\n", first);
+    nvds_detection_log_reader_close (reader);
+    return 1;
+  }
+
+  while (nvds_detection_log_reader_next (reader, &record)) {
+    if (record.type == NV_DS_DETECTION_LOG_FRAME) {
+      if (out)
+        fclose (out);
+      out = NULL;
+      if (record.frame_num > last)
+        break;
+      if (record.frame_num < first)
+        continue;
+
+      g_snprintf (path, sizeof (path), "%s/%02u_%03u_%06lu.txt", argv[2],
+          header->instance, header->source_id, (gulong) record.frame_num);
+      out = fopen (path, "w");
+      if (!out) {
+        g_printerr ("cannot write %s\n", path);
+        nvds_detection_log_reader_close (reader);
+        return 1;
+      }
+      num_frames++;
+    } else if (out) {
+      int left = record.left;
+      int top = record.top;
+      int right = left + record.width;
+      int bottom = top + record.height;
+
+      if (track) {
+        fprintf (out, "%s %lu 0.0 0 0.0 %d.00 %d.00 %d.00 %d.00 0.0 0.0 0.0 "
+            "0.0 0.0 0.0 0.0\n", record.label, (gulong) record.object_id,
+            left, top, right, bottom);
+      } else {
+        fprintf (out, "%s 0.0 0 0.0 %d.00 %d.00 %d.00 %d.00 0.0 0.0 0.0 0.0 "
+            "0.0 0.0 0.0\n", record.label, left, top, right, bottom);
+      }
+      num_objects++;
+    }
+  }
+  if (out)
+    fclose (out);
+
+  g_print ("%" G_GUINT64_FORMAT " frames, %" G_GUINT64_FORMAT " objects "
+      "written to %s\n", num_frames, num_objects, argv[2]);
+  nvds_detection_log_reader_close (reader);
+  return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * CPU benchmark of the motion gate on a videotestsrc pipeline; no camera,
+ * GPU or DeepStream install needed. Every GRAY8 frame reaching the sink
+ * goes through two gates, one with the SIMD kernels and one with the
+ * scalar ones, which must take the same decisions. Prints the time per
+ * frame of each and how many frames the primary GIE would have run on.
+ *
+ *   ./tools/motion-bench [frames] [width] [height] [pattern...]
+ *
+ * smpte is a still scene, ball a small moving object and snow changes
+ * everywhere.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <gst/gst.h>
+
+#include "deepstream_app_log.h"
+#include "deepstream_app_motion.h"
+
+typedef struct
+{
+  NvDsMotionGate *gate[2];
+  guint64 ns[2];
+  guint width;
+  guint height;
+  guint frames;
+  guint runs;
+  guint mismatches;
+} BenchCtx;
+
+static guint64
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (guint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static GstPadProbeReturn
+frame_probe (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  BenchCtx *ctx = (BenchCtx *) data;
+  GstBuffer *buf = (GstBuffer *) info->data;
+  /* GRAY8 rows are padded to four bytes. */
+  guint pitch = (ctx->width + 3) & ~3;
+  gboolean run[2];
+  gdouble change[2];
+  GstMapInfo map;
+  guint i;
+
+  if (!gst_buffer_map (buf, &map, GST_MAP_READ))
+    return GST_PAD_PROBE_OK;
+
+  for (i = 0; i < 2; i++) {
+    guint64 start = now_ns ();
+
+    nvds_motion_gate_frame (ctx->gate[i], 0, ctx->frames, map.data,
+        ctx->width, ctx->height, pitch, &change[i]);
+    run[i] = nvds_motion_gate_end_batch (ctx->gate[i]);
+    ctx->ns[i] += now_ns () - start;
+  }
+  gst_buffer_unmap (buf, &map);
+
+  if (run[0] != run[1] || change[0] != change[1])
+    ctx->mismatches++;
+  ctx->runs += run[0];
+  ctx->frames++;
+  return GST_PAD_PROBE_OK;
+}
+
+static gboolean
+run (const gchar * pattern, guint frames, guint width, guint height)
+{
+  NvDsMotionGateConfig config = { TRUE, 16, 12, 0.5, 30, TRUE };
+  NvDsMotionGateStats stats;
+  BenchCtx ctx = { {NULL} };
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GError *error = NULL;
+  GstBus *bus;
+  GstPad *pad;
+  gchar *desc;
+  gboolean ok;
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=%u pattern=%s ! "
+      "video/x-raw,format=GRAY8,width=%u,height=%u ! fakesink name=sink",
+      frames, pattern, width, height);
+  pipeline = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (!pipeline) {
+    g_printerr ("cannot build pipeline: %s\n", error->message);
+    g_error_free (error);
+    return FALSE;
+  }
+
+  ctx.width = width;
+  ctx.height = height;
+  ctx.gate[0] = nvds_motion_gate_new (&config, 1);
+  config.simd = FALSE;
+  ctx.gate[1] = nvds_motion_gate_new (&config, 1);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, frame_probe, &ctx,
+      NULL);
+  gst_object_unref (pad);
+  gst_object_unref (sink);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  ok = GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+  if (!ok) {
+    gst_message_parse_error (msg, &error, NULL);
+    g_printerr ("ERROR: %s\n", error->message);
+    g_error_free (error);
+  }
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  nvds_motion_gate_get_stats (ctx.gate[0], &stats);
+  ok = ok && ctx.frames > 0 && !ctx.mismatches;
+  g_print ("%-6s %ux%u: %u frames, simd %6.1f us, scalar %6.1f us, run on %u "
+      "(%.0f%%), %" G_GUINT64_FORMAT " moving, %" G_GUINT64_FORMAT " forced, "
+      "max change %.1f%%%s\n", pattern, width, height, ctx.frames,
+      ctx.frames ? ctx.ns[0] / 1000.0 / ctx.frames : 0,
+      ctx.frames ? ctx.ns[1] / 1000.0 / ctx.frames : 0, ctx.runs,
+      ctx.frames ? 100.0 * ctx.runs / ctx.frames : 0, stats.num_moving,
+      stats.num_forced, stats.max_change, ok ? "" : "  FAILED");
+
+  nvds_motion_gate_free (ctx.gate[0]);
+  nvds_motion_gate_free (ctx.gate[1]);
+  return ok;
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const gchar *patterns[] = { "smpte", "ball", "snow" };
+  guint frames = argc > 1 ? atoi (argv[1]) : 1000;
+  guint width = argc > 2 ? atoi (argv[2]) : 1280;
+  guint height = argc > 3 ? atoi (argv[3]) : 720;
+  gboolean ok = TRUE;
+  gint i;
+
+  gst_init (&argc, &argv);
+  nvds_log_init (NV_DS_LOG_WARN, 0);
+
+  if (argc > 4) {
+    for (i = 4; i < argc; i++)
+      ok &= run (argv[i], frames, width, height);
+  } else {
+    for (i = 0; i < (gint) G_N_ELEMENTS (patterns); i++)
+      ok &= run (patterns[i], frames, width, height);
+  }
+
+  nvds_log_shutdown ();
+  return ok ? 0 : 1;
+}
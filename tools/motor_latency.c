@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures motor command latency on a plain Linux box: the file backend is
+ * pointed at the slave side of a pty and every command is timed from the
+ * API call until its line can be read back on the master side.
+ *
+ *   ./tools/motor-latency [iterations]
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "deepstream_app_motor.h"
+
+static gint
+open_pty (gchar ** slave_name)
+{
+  struct termios tio;
+  gint master = posix_openpt (O_RDWR | O_NOCTTY);
+
+  if (master < 0 || grantpt (master) < 0 || unlockpt (master) < 0)
+    return -1;
+
+  *slave_name = g_strdup (ptsname (master));
+  tcgetattr (master, &tio);
+  cfmakeraw (&tio);
+  tcsetattr (master, TCSANOW, &tio);
+  return master;
+}
+
+static gboolean
+read_line (gint fd, gchar * line, gsize size)
+{
+  gsize len = 0;
+  struct pollfd pfd = { fd, POLLIN, 0 };
+
+  while (len + 1 < size) {
+    if (poll (&pfd, 1, 1000) <= 0)
+      return FALSE;
+    if (read (fd, &line[len], 1) != 1)
+      return FALSE;
+    if (line[len++] == '\n')
+      break;
+  }
+  line[len] = '\0';
+  return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  NvDsMotorConfig config = { 0 };
+  NvDsMotorStats stats;
+  NvDsMotor *motor;
+  gchar *slave_name = NULL;
+  gchar line[128];
+  guint iterations = argc > 1 ? atoi (argv[1]) : 1000;
+  guint i;
+  gint master;
+  gint64 total = 0, max = 0, min = G_MAXINT;
+
+  master = open_pty (&slave_name);
+  if (master < 0) {
+    g_printerr ("cannot open pty\n");
+    return 1;
+  }
+
+  config.enable = TRUE;
+  config.backend = NV_DS_MOTOR_BACKEND_FILE;
+  config.device = slave_name;
+  motor = nvds_motor_open (&config);
+  if (!motor)
+    return 1;
+
+  for (i = 0; i < iterations; i++) {
+    gint64 start = g_get_monotonic_time ();
+    gint64 latency;
+    gboolean ok;
+
+    switch (i % 3) {
+      case 0:
+        ok = nvds_motor_drive (motor, 0.8, 0.8);
+        break;
+      case 1:
+        ok = nvds_motor_turn (motor, (i & 1) ? 0.5 : -0.7);
+        break;
+      default:
+        ok = nvds_motor_stop (motor);
+        break;
+    }
+    if (!ok || !read_line (master, line, sizeof (line))) {
+      g_printerr ("command %u lost\n", i);
+      return 1;
+    }
+    latency = g_get_monotonic_time () - start;
+    total += latency;
+    min = MIN (min, latency);
+    max = MAX (max, latency);
+  }
+
+  nvds_motor_get_stats (motor, &stats);
+  g_print ("%u commands through %s\n", iterations, slave_name);
+  g_print ("  call -> readable: min %" G_GINT64_FORMAT " us, avg %.1f us, "
+      "max %" G_GINT64_FORMAT " us\n", min, (gdouble) total / iterations, max);
+  g_print ("  driver issue:     avg %.1f us, max %" G_GUINT64_FORMAT " us\n",
+      (gdouble) stats.total_latency_us / MAX (stats.num_commands, 1),
+      stats.max_latency_us);
+
+  nvds_motor_close (motor);
+  close (master);
+  g_free (slave_name);
+  return 0;
+}
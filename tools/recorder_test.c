@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Exercise the event recorder without a camera or inference: a live
+ * videotestsrc (or a decoded file) feeds a tee with a fakesink on one side
+ * and the recorder on the other. The recorder is triggered once after
+ * trigger-sec and again five seconds later, which must extend the same
+ * clip. Prints the ring size at trigger time, flush latency and the clip.
+ *
+ *   ./tools/recorder-test [output-dir] [trigger-sec] [video-file]
+ *
+ * Uses x264enc so it also runs on machines without the NVIDIA encoder.
+ */
+
+#include <stdlib.h>
+
+#include "deepstream_app_recorder.h"
+
+#define TEST_EXTEND_SEC 5
+
+typedef struct
+{
+  GMainLoop *loop;
+  NvDsRecorder *rec;
+  guint trigger_sec;
+  guint post_event_sec;
+  guint elapsed_ms;
+  gboolean ok;
+} TestCtx;
+
+static void
+print_ring (NvDsRecorder * rec, const gchar * when)
+{
+  NvDsRecorderStats stats;
+
+  nvds_recorder_get_stats (rec, &stats);
+  g_print ("%s: ring %u frames, %.1f s, %" G_GUINT64_FORMAT " KB (max %"
+      G_GUINT64_FORMAT " KB)\n", when, stats.ring_frames,
+      (gdouble) stats.ring_duration / GST_SECOND, stats.ring_bytes / 1024,
+      stats.max_ring_bytes / 1024);
+}
+
+static gboolean
+tick (gpointer data)
+{
+  TestCtx *ctx = (TestCtx *) data;
+  NvDsRecorderStats stats;
+  guint deadline_ms;
+
+  ctx->elapsed_ms += 100;
+  if (ctx->elapsed_ms == ctx->trigger_sec * 1000) {
+    print_ring (ctx->rec, "trigger");
+    nvds_recorder_trigger (ctx->rec, "test");
+  } else if (ctx->elapsed_ms == (ctx->trigger_sec + TEST_EXTEND_SEC) * 1000) {
+    nvds_recorder_trigger (ctx->rec, "test");
+  }
+
+  nvds_recorder_get_stats (ctx->rec, &stats);
+  if (stats.num_clips || stats.num_failed) {
+    ctx->ok = stats.num_clips == 1 && !stats.num_failed &&
+        stats.num_extended == 1;
+    g_main_loop_quit (ctx->loop);
+    return FALSE;
+  }
+
+  deadline_ms = (ctx->trigger_sec + TEST_EXTEND_SEC + ctx->post_event_sec +
+      10) * 1000;
+  if (ctx->elapsed_ms >= deadline_ms) {
+    g_printerr ("no clip written after %u s\n", deadline_ms / 1000);
+    g_main_loop_quit (ctx->loop);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static gboolean
+bus_call (GstBus * bus, GstMessage * msg, gpointer data)
+{
+  TestCtx *ctx = (TestCtx *) data;
+  GError *error = NULL;
+
+  switch (GST_MESSAGE_TYPE (msg)) {
+    case GST_MESSAGE_ERROR:
+      gst_message_parse_error (msg, &error, NULL);
+      g_printerr ("ERROR: %s\n", error->message);
+      g_error_free (error);
+      g_main_loop_quit (ctx->loop);
+      break;
+    case GST_MESSAGE_EOS:
+      g_printerr ("source ended before the clip was done\n");
+      g_main_loop_quit (ctx->loop);
+      break;
+    default:
+      break;
+  }
+  return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  NvDsRecorderConfig config = { 0 };
+  NvDsRecorderStats stats;
+  TestCtx ctx = { 0 };
+  GstElement *pipeline, *tee;
+  GstPad *tee_pad, *sink_pad;
+  GError *error = NULL;
+  GstBus *bus;
+  gchar *desc;
+
+  gst_init (&argc, &argv);
+
+  config.enable = TRUE;
+  config.pre_event_sec = 10;
+  config.post_event_sec = 20;
+  config.container = NV_DS_RECORDER_CONTAINER_MP4;
+  config.output_dir = argc > 1 ? argv[1] : (gchar *) ".";
+  config.encoder = (gchar *) "x264enc";
+  config.bitrate = 2000000;
+  ctx.trigger_sec = argc > 2 ? atoi (argv[2]) : 12;
+  ctx.post_event_sec = config.post_event_sec;
+
+  if (argc > 3) {
+    desc = g_strdup_printf ("filesrc location=%s ! decodebin ! videoconvert "
+        "! identity sync=true ! tee name=t ! queue ! fakesink", argv[3]);
+  } else {
+    desc = g_strdup ("videotestsrc is-live=true pattern=ball ! "
+        "video/x-raw,width=640,height=480,framerate=30/1 ! timeoverlay ! "
+        "tee name=t ! queue ! fakesink");
+  }
+  pipeline = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (!pipeline) {
+    g_printerr ("cannot build source pipeline: %s\n", error->message);
+    g_error_free (error);
+    return 1;
+  }
+
+  ctx.rec = nvds_recorder_new (&config, 0);
+  if (!ctx.rec)
+    return 1;
+
+  tee = gst_bin_get_by_name (GST_BIN (pipeline), "t");
+  gst_bin_add (GST_BIN (pipeline), nvds_recorder_get_bin (ctx.rec));
+  tee_pad = gst_element_get_request_pad (tee, "src_%u");
+  sink_pad = gst_element_get_static_pad (nvds_recorder_get_bin (ctx.rec),
+      "sink");
+  if (gst_pad_link (tee_pad, sink_pad) != GST_PAD_LINK_OK) {
+    g_printerr ("cannot link the recorder to the tee\n");
+    return 1;
+  }
+  gst_object_unref (sink_pad);
+  gst_object_unref (tee_pad);
+  gst_object_unref (tee);
+
+  ctx.loop = g_main_loop_new (NULL, FALSE);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  gst_bus_add_watch (bus, bus_call, &ctx);
+  gst_object_unref (bus);
+  g_timeout_add (100, tick, &ctx);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  g_main_loop_run (ctx.loop);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  print_ring (ctx.rec, "end");
+  nvds_recorder_get_stats (ctx.rec, &stats);
+  g_print ("%" G_GUINT64_FORMAT " frames encoded, %" G_GUINT64_FORMAT
+      " triggers (%" G_GUINT64_FORMAT " extended), %" G_GUINT64_FORMAT
+      " clips, %" G_GUINT64_FORMAT " failed\n", stats.num_frames,
+      stats.num_triggers, stats.num_extended, stats.num_clips,
+      stats.num_failed);
+  g_print ("flush latency %.1f ms, finalize %.1f ms%s\n",
+      stats.last_flush_latency_us / 1000.0, stats.last_finalize_us / 1000.0,
+      ctx.ok ? "" : "  FAILED");
+
+  nvds_recorder_free (ctx.rec);
+  gst_object_unref (pipeline);
+  g_main_loop_unref (ctx.loop);
+  return ctx.ok ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * pty loopback harness for the servo driver. The driver is opened on the
+ * slave side of a pty; every packet it writes is read back on the master
+ * side and compared with the bytes servoserial.py produces for the same
+ * call. Then packet write latency is measured for single and sync writes.
+ *
+ *   ./tools/servo-loopback [iterations]
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "deepstream_app_servo.h"
+
+/* Reference bytes captured from servoserial.py. */
+static const guint8 ref_single_center[] = {
+  0xFF, 0xFF, 0x01, 0x07, 0x03, 0x2A, 0x08, 0x00, 0x00, 0x0A, 0xB8
+};
+
+/* Servo_serial_control(2, 1200): clamped up to 1300. */
+static const guint8 ref_single_tilt_clamped[] = {
+  0xFF, 0xFF, 0x02, 0x07, 0x03, 0x2A, 0x05, 0x14, 0x00, 0x0A, 0xA6
+};
+
+/* adjust_camera_to_front.py */
+static const guint8 ref_sync_front[] = {
+  0xFF, 0xFF, 0xFE, 0x0E, 0x83, 0x2A, 0x04, 0x01, 0x08, 0x34, 0x00, 0x0A,
+  0x02, 0x05, 0xDC, 0x00, 0x0A, 0x0E
+};
+
+/* adjust_camera_to_center.py */
+static const guint8 ref_sync_center[] = {
+  0xFF, 0xFF, 0xFE, 0x0E, 0x83, 0x2A, 0x04, 0x01, 0x08, 0x34, 0x00, 0x0A,
+  0x02, 0x08, 0x00, 0x00, 0x0A, 0xE7
+};
+
+static gint
+open_pty (gchar ** slave_name)
+{
+  struct termios tio;
+  gint master = posix_openpt (O_RDWR | O_NOCTTY);
+
+  if (master < 0 || grantpt (master) < 0 || unlockpt (master) < 0)
+    return -1;
+
+  *slave_name = g_strdup (ptsname (master));
+  tcgetattr (master, &tio);
+  cfmakeraw (&tio);
+  tcsetattr (master, TCSANOW, &tio);
+  return master;
+}
+
+static gboolean
+read_exact (gint fd, guint8 * data, gsize len)
+{
+  struct pollfd pfd = { fd, POLLIN, 0 };
+  gsize got = 0;
+
+  while (got < len) {
+    gssize n;
+    if (poll (&pfd, 1, 1000) <= 0)
+      return FALSE;
+    n = read (fd, data + got, len - got);
+    if (n <= 0)
+      return FALSE;
+    got += n;
+  }
+  return TRUE;
+}
+
+static gboolean
+expect_packet (gint master, const gchar * name, const guint8 * ref, gsize len)
+{
+  guint8 got[NVDS_SERVO_MAX_PACKET_SIZE];
+  gsize i;
+
+  if (!read_exact (master, got, len)) {
+    g_print ("FAIL %-22s: short read\n", name);
+    return FALSE;
+  }
+  if (memcmp (got, ref, len)) {
+    g_print ("FAIL %-22s:", name);
+    for (i = 0; i < len; i++)
+      g_print (" %02X", got[i]);
+    g_print ("\n");
+    return FALSE;
+  }
+  g_print ("ok   %-22s (%lu bytes)\n", name, (gulong) len);
+  return TRUE;
+}
+
+static void
+measure (NvDsServo * servo, gint master, guint num_targets, guint iterations)
+{
+  NvDsServoTarget targets[NVDS_SERVO_MAX_SYNC_TARGETS];
+  guint8 drain[NVDS_SERVO_MAX_PACKET_SIZE];
+  gsize len = num_targets == 1 ? 11 : 8 + 5 * num_targets;
+  gint64 total = 0, max = 0;
+  guint i, j;
+
+  for (i = 0; i < iterations; i++) {
+    gint64 start, latency;
+
+    for (j = 0; j < num_targets; j++) {
+      targets[j].id = j + 1;
+      targets[j].position = 1500 + (i % 1000);
+    }
+    start = g_get_monotonic_time ();
+    nvds_servo_move_many (servo, targets, num_targets);
+    latency = g_get_monotonic_time () - start;
+    read_exact (master, drain, len);
+
+    total += latency;
+    max = MAX (max, latency);
+  }
+  g_print ("%2u servo(s)/packet: %3lu bytes, write avg %.1f us, max %"
+      G_GINT64_FORMAT " us, %.1f us per servo\n", num_targets, (gulong) len,
+      (gdouble) total / iterations, max,
+      (gdouble) total / iterations / num_targets);
+}
+
+int
+main (int argc, char *argv[])
+{
+  NvDsServoConfig config = { 0 };
+  NvDsServoTarget target;
+  NvDsServo *servo;
+  gchar *slave_name = NULL;
+  guint iterations = argc > 1 ? atoi (argv[1]) : 2000;
+  gboolean ok = TRUE;
+  gint master;
+
+  master = open_pty (&slave_name);
+  if (master < 0) {
+    g_printerr ("cannot open pty\n");
+    return 1;
+  }
+
+  config.enable = TRUE;
+  config.device = slave_name;
+  servo = nvds_servo_open (&config);
+  if (!servo)
+    return 1;
+
+  target.id = NVDS_SERVO_PAN_ID;
+  target.position = 2048;
+  nvds_servo_move (servo, target.id, target.position);
+  ok &= expect_packet (master, "single pan 2048", ref_single_center,
+      sizeof (ref_single_center));
+
+  nvds_servo_move (servo, NVDS_SERVO_TILT_ID, 1200);
+  ok &= expect_packet (master, "single tilt clamp", ref_single_tilt_clamped,
+      sizeof (ref_single_tilt_clamped));
+
+  nvds_servo_pan_tilt (servo, 2100, 1500);
+  ok &= expect_packet (master, "sync camera front", ref_sync_front,
+      sizeof (ref_sync_front));
+
+  nvds_servo_pan_tilt (servo, 2100, 2048);
+  ok &= expect_packet (master, "sync camera center", ref_sync_center,
+      sizeof (ref_sync_center));
+
+  if (!ok) {
+    nvds_servo_close (servo);
+    return 1;
+  }
+
+  g_print ("\n%u iterations through %s\n", iterations, slave_name);
+  measure (servo, master, 1, iterations);
+  measure (servo, master, 2, iterations);
+  measure (servo, master, 8, iterations);
+
+  nvds_servo_close (servo);
+  close (master);
+  g_free (slave_name);
+  return 0;
+}
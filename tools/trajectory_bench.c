@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Microbenchmark of the trajectory store with 1, 10 and 100 concurrent
+ * tracks. Every frame adds one point per track and looks each track up
+ * again; a tenth of the tracks is replaced every 50 frames so tracks keep
+ * being created and expired. Results are checked while measuring.
+ *
+ *   ./tools/trajectory-bench [frames]
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "deepstream_app_trajectory.h"
+
+#define BENCH_MAX_TRACKS 256
+#define BENCH_HISTORY 64
+#define BENCH_EXPIRE_FRAMES 30
+
+static guint64
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (guint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static gboolean
+run (guint num_tracks, guint frames)
+{
+  NvDsTrajectoryStore *store;
+  NvDsTrajectoryStats stats;
+  guint64 *ids = g_new (guint64, num_tracks);
+  guint64 next_id = 0, add_ns = 0, lookup_ns = 0, start;
+  gboolean ok = TRUE;
+  guint f, i;
+
+  store = nvds_trajectory_store_new (BENCH_MAX_TRACKS, BENCH_HISTORY,
+      BENCH_EXPIRE_FRAMES);
+  for (i = 0; i < num_tracks; i++)
+    ids[i] = next_id++;
+
+  for (f = 0; f < frames; f++) {
+    NvDsDetectionSample sample = { 0 };
+
+    if (f % 50 == 49) {
+      for (i = 0; i < MAX (num_tracks / 10, 1); i++)
+        ids[rand () % num_tracks] = next_id++;
+    }
+
+    sample.frame_num = f;
+    sample.pts = (guint64) f * 33333333;
+    start = now_ns ();
+    for (i = 0; i < num_tracks; i++) {
+      sample.object_id = ids[i];
+      sample.left = i;
+      nvds_trajectory_store_add (store, &sample);
+    }
+    add_ns += now_ns () - start;
+
+    start = now_ns ();
+    for (i = 0; i < num_tracks; i++) {
+      const NvDsTrajectory *traj =
+          nvds_trajectory_store_lookup (store, 0, ids[i]);
+      if (!traj || nvds_trajectory_point (traj, 0)->frame_num != (gint) f)
+        ok = FALSE;
+    }
+    lookup_ns += now_ns () - start;
+
+    nvds_trajectory_store_end_frame (store);
+  }
+
+  nvds_trajectory_store_get_stats (store, &stats);
+  g_print ("%3u tracks: add %6.1f ns, lookup %6.1f ns, %u live, %"
+      G_GUINT64_FORMAT " created, %" G_GUINT64_FORMAT " expired, max probe "
+      "%u%s\n", num_tracks, (gdouble) add_ns / frames / num_tracks,
+      (gdouble) lookup_ns / frames / num_tracks, stats.num_tracks,
+      stats.num_created, stats.num_expired, stats.max_probe,
+      ok && !stats.num_rejected ? "" : "  FAILED");
+
+  nvds_trajectory_store_free (store);
+  g_free (ids);
+  return ok && !stats.num_rejected;
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint frames = argc > 1 ? atoi (argv[1]) : 100000;
+  gboolean ok = TRUE;
+
+  srand (1);
+  ok &= run (1, frames);
+  ok &= run (10, frames);
+  ok &= run (100, frames);
+  return ok ? 0 : 1;
+}